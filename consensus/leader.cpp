@@ -2,6 +2,7 @@
 #include "core/merkle.h"
 #include "wallet/signer.h"
 #include <ctime>
+#include <unordered_set>
 
 namespace aegen {
 
@@ -19,20 +20,33 @@ Block Leader::proposeBlock(uint64_t height, uint64_t previousTimestamp, const Ha
     if (now <= previousTimestamp) now = previousTimestamp + 1;
     block.header.timestamp = now;
 
-    // Fill block with transactions from mempool
-    // Cap at say 100 for now
-    int count = 0;
-    while(mempool.size() > 0 && count < 100) {
-        Transaction tx = mempool.pop();
-        if (executionEngine.validateTransaction(tx)) {
-             // Execute to update state
-             executionEngine.applyTransaction(tx, nodeAddress);
+    // Fill block with the best executable transactions from the mempool
+    auto candidates = mempool.selectExecutable(MAX_BLOCK_TXS, [this](const Address& sender) {
+        return stateManager.getAccountState(sender).nonce;
+    });
+
+    // Executed together, with the same outcome as one by one in order
+    BlockContext context(block.header);
+    std::vector<bool> applied = executionEngine.applyTransactions(candidates, context);
+
+    // Once a sender's tx fails, its later nonces cannot apply either; leave them pooled
+    std::unordered_set<Address> stalled;
+    std::unordered_set<Address> included;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        const auto& tx = candidates[i];
+        if (stalled.count(tx.sender)) continue;
+        if (applied[i]) {
              block.addTransaction(tx);
-             count++;
+             included.insert(tx.sender);
         } else {
             // Drop invalid tx
+            mempool.remove(tx.hash);
+            stalled.insert(tx.sender);
         }
     }
+    for (const auto& sender : included) {
+        mempool.pruneSender(sender, stateManager.getAccountState(sender).nonce);
+    }
 
     // Compute Roots
     block.header.stateRoot = stateManager.getRootHash();
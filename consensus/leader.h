@@ -15,6 +15,8 @@ class Leader {
     Address nodeAddress;
 
 public:
+    static constexpr size_t MAX_BLOCK_TXS = 100;
+
     Leader(Mempool& mp, ExecutionEngine& exec, StateManager& state, const KeyPair& keys, const Address& addr);
 
     Block proposeBlock(uint64_t height, uint64_t previousTimestamp, const Hash& previousHash);
@@ -34,13 +34,7 @@ bool Validator::validateBlock(const Block& block) {
     // Capture state root before execution (if we needed to rollback)
     // Hash rootBefore = stateManager.getRootHash();
 
-    for (const auto& tx : block.transactions) {
-        if (!executionEngine.validateTransaction(tx)) {
-            std::cerr << "Block contains invalid tx: " << crypto::to_hex(tx.hash) << std::endl;
-            return false;
-        }
-        executionEngine.applyTransaction(tx, block.header.producer);
-    }
+    if (!executionEngine.applyBlock(block)) return false;
 
     // 4. Verify Roots
     Hash calculatedStateRoot = stateManager.getRootHash();
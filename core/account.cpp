@@ -1,5 +1,30 @@
 #include "account.h"
 
 namespace aegen {
-    // Methods for account manipulation
+
+static void putU64(std::string& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out.push_back((char)(v >> (i * 8)));
+}
+
+static uint64_t getU64(const std::string& in, size_t offset) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= (uint64_t)(uint8_t)in[offset + i] << (i * 8);
+    return v;
+}
+
+std::string AccountState::encode() const {
+    std::string out;
+    out.reserve(ENCODED_SIZE);
+    putU64(out, nonce);
+    putU64(out, balance);
+    return out;
+}
+
+bool AccountState::decode(const std::string& data, AccountState& out) {
+    if (data.size() != ENCODED_SIZE) return false;
+    out.nonce = getU64(data, 0);
+    out.balance = getU64(data, 8);
+    return true;
+}
+
 }
@@ -7,6 +7,11 @@ struct AccountState {
     uint64_t nonce;
     uint64_t balance;
     // can add storage root for contracts later
+
+    // Fixed 16-byte little-endian encoding used for persistence and hashing
+    static constexpr size_t ENCODED_SIZE = 16;
+    std::string encode() const;
+    static bool decode(const std::string& data, AccountState& out);
 };
 
 // Simple in-memory representation for now
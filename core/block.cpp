@@ -2,10 +2,16 @@
 #include "util/crypto.h"
 #include <sstream>
 #include <cstring>
+#include <stdexcept>
+#include <algorithm>
 
 namespace aegen {
 
 Hash Block::calculateHash() const {
+    return calculateHash(header);
+}
+
+Hash Block::calculateHash(const BlockHeader& header) {
     // Hash relevant header fields
     std::stringstream ss;
     ss << header.height 
@@ -41,60 +47,77 @@ std::vector<uint8_t> Block::serialize() const {
     append(&prodLen, sizeof(prodLen));
     append(header.producer.data(), prodLen);
     
-    append(header.signature.data(), header.signature.size());
+    uint32_t sigLen = (uint32_t)header.signature.size();
+    append(&sigLen, sizeof(sigLen));
+    append(header.signature.data(), sigLen);
     
     uint32_t txCount = (uint32_t)transactions.size();
     append(&txCount, sizeof(txCount));
     
     for(const auto& tx : transactions) {
-        auto txBytes = tx.serialize();
-        uint32_t len = (uint32_t)txBytes.size();
+        uint32_t len = (uint32_t)tx.serializedSize();
         append(&len, sizeof(len));
-        buffer.insert(buffer.end(), txBytes.begin(), txBytes.end());
+        tx.serializeTo(buffer);
     }
     return buffer;
 }
 
 Block Block::deserialize(const std::vector<uint8_t>& data) {
     Block block;
-    size_t offset = 0;
-    
-    auto read = [&](void* dest, size_t size) {
-        if (offset + size > data.size()) return false;
-        std::memcpy(dest, &data[offset], size);
-        offset += size;
+    if (!decode(data.data(), data.size(), block)) throw std::runtime_error("Block deserialization OOB");
+    for (auto& tx : block.transactions) tx.calculateHash();
+    return block;
+}
+
+// Reads the header and leaves offset at the first transaction
+static bool readHeader(const uint8_t* data, size_t size, size_t& offset, BlockHeader& header, uint32_t& txCount) {
+    auto read = [&](void* dest, size_t n) {
+        if (n > size - offset) return false;
+        std::memcpy(dest, data + offset, n);
+        offset += n;
         return true;
     };
-    
-    read(&block.header.height, sizeof(uint64_t));
-    read(&block.header.timestamp, sizeof(uint64_t));
-    read(block.header.previousHash.data(), 32);
-    read(block.header.stateRoot.data(), 32);
-    read(block.header.txRoot.data(), 32);
-    
-    uint32_t prodLen;
-    read(&prodLen, sizeof(uint32_t));
-    if (offset + prodLen <= data.size()) {
-        block.header.producer.assign((char*)&data[offset], prodLen);
-        offset += prodLen;
-    }
-    
-    read(block.header.signature.data(), 64);
-    
+    auto readStr = [&](auto& out) {
+        uint32_t len;
+        if (!read(&len, sizeof(len)) || len > size - offset) return false;
+        out.assign(data + offset, data + offset + len);
+        offset += len;
+        return true;
+    };
+
+    return read(&header.height, sizeof(header.height)) &&
+           read(&header.timestamp, sizeof(header.timestamp)) &&
+           read(header.previousHash.data(), header.previousHash.size()) &&
+           read(header.stateRoot.data(), header.stateRoot.size()) &&
+           read(header.txRoot.data(), header.txRoot.size()) &&
+           readStr(header.producer) && readStr(header.signature) &&
+           read(&txCount, sizeof(txCount));
+}
+
+bool Block::decodeHeader(const uint8_t* data, size_t size, BlockHeader& header, uint32_t& txCount) {
+    size_t offset = 0;
+    return readHeader(data, size, offset, header, txCount);
+}
+
+bool Block::decode(const uint8_t* data, size_t size, Block& block) {
+    size_t offset = 0;
     uint32_t txCount;
-    read(&txCount, sizeof(uint32_t));
-    
-    for(uint32_t i=0; i<txCount; i++) {
+    if (!readHeader(data, size, offset, block.header, txCount)) return false;
+
+    block.transactions.clear();
+    block.transactions.reserve(std::min<size_t>(txCount, (size - offset) / sizeof(uint32_t)));
+    for (uint32_t i = 0; i < txCount; i++) {
         uint32_t len;
-        read(&len, sizeof(uint32_t));
-        if (offset + len <= data.size()) {
-            std::vector<uint8_t> txData(data.begin() + offset, data.begin() + offset + len);
-            block.transactions.push_back(Transaction::deserialize(txData));
-            offset += len;
-        }
+        if (sizeof(len) > size - offset) return false;
+        std::memcpy(&len, data + offset, sizeof(len));
+        offset += sizeof(len);
+        if (len > size - offset) return false;
+        Transaction tx;
+        if (!Transaction::decode(data + offset, len, tx)) return false;
+        block.transactions.push_back(std::move(tx));
+        offset += len;
     }
-    
-    return block;
+    return offset == size;
 }
 
 }
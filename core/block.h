@@ -21,11 +21,19 @@ public:
     std::vector<Transaction> transactions;
 
     Hash calculateHash() const;
+    static Hash calculateHash(const BlockHeader& header);
     void addTransaction(const Transaction& tx);
     
     // Serialization
     std::vector<uint8_t> serialize() const;
+    // Throws std::runtime_error on malformed input
     static Block deserialize(const std::vector<uint8_t>& data);
+
+    // Non-throwing decode straight from a buffer. Transaction hashes are left
+    // for the caller to fill in (deserialize() recomputes them).
+    static bool decode(const uint8_t* data, size_t size, Block& block);
+    // Reads only the header and the transaction count, skipping the bodies
+    static bool decodeHeader(const uint8_t* data, size_t size, BlockHeader& header, uint32_t& txCount);
 };
 
 }
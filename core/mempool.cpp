@@ -1,33 +1,291 @@
 #include "mempool.h"
 #include <algorithm>
+#include <queue>
+#include <unordered_set>
 
 namespace aegen {
 
+Mempool::Mempool(size_t capacity) : capacity(capacity) {}
+
 bool Mempool::validate(const Transaction& tx) {
     // Basic structural validation
     if (tx.amount == 0 && tx.data.empty()) return false;
     return true;
 }
 
-void Mempool::add(const Transaction& tx) {
-    if (validate(tx)) {
-        queue.push_back(tx);
-        // Sort by gasPrice desc (simple priority)
-        std::sort(queue.begin(), queue.end(), [](const Transaction& a, const Transaction& b) {
-            return a.gasPrice > b.gasPrice;
-        });
+bool Mempool::add(const Transaction& tx) {
+    if (!validate(tx)) return false;
+
+    Shard& shard = shardFor(tx.sender);
+    {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        bool replaces = false;
+        if (!shard.admits(tx, replaces)) return false;
+        if (replaces) {
+            shard.erase(tx.sender, tx.nonce); // One out, one in: the count is unchanged
+            shard.insert(tx);
+            return true;
+        }
+        if (reserveSlot()) {
+            shard.insert(tx);
+            return true;
+        }
+    }
+    return addEvicting(tx);
+}
+
+bool Mempool::addEvicting(const Transaction& tx) {
+    // Slots are only reserved under a shard lock, so with every shard held the
+    // pool cannot fill up again behind our back
+    auto locks = lockAll();
+    Shard& shard = shardFor(tx.sender);
+    bool replaces = false;
+    if (!shard.admits(tx, replaces)) return false;
+    if (replaces) {
+        shard.erase(tx.sender, tx.nonce);
+        shard.insert(tx);
+        return true;
+    }
+    if (!reserveSlot()) {
+        Shard* cheapest = nullptr;
+        for (auto& s : shards) {
+            if (s.priced.empty()) continue;
+            if (!cheapest || s.priced.begin()->first < cheapest->priced.begin()->first) cheapest = &s;
+        }
+        if (!cheapest || tx.gasPrice <= cheapest->priced.begin()->first) return false;
+        adjustCount(cheapest->evictCheapest());
+        if (!reserveSlot()) return false;
     }
+    shard.insert(tx);
+    return true;
 }
 
 Transaction Mempool::pop() {
-    if (queue.empty()) return Transaction{};
-    Transaction tx = queue.front();
-    queue.pop_front();
+    auto locks = lockAll();
+    Shard* best = nullptr;
+    for (auto& shard : shards) {
+        if (shard.heads.empty()) continue;
+        if (!best || shard.heads.begin()->first > best->heads.begin()->first) best = &shard;
+    }
+    if (!best) return Transaction{};
+
+    Address sender = best->heads.begin()->second;
+    Transaction tx = best->lanes[sender].begin()->second;
+    adjustCount(best->erase(sender, tx.nonce));
     return tx;
 }
 
+std::vector<Transaction> Mempool::selectExecutable(size_t maxCount, const NonceLookup& accountNonce) const {
+    // accountNonce reads state, possibly from disk, so it runs with no shard
+    // locked. Every other step locks just the shard it reads, and lanes change
+    // in between, so each tx is looked up again before it is taken.
+    struct Candidate {
+        uint64_t gasPrice;
+        Address sender;
+        size_t shard;
+        bool resolved;  // A lane whose tx at `nonce` runs next; otherwise a lane head
+        uint64_t nonce;
+    };
+    auto lowerPriority = [](const Candidate& a, const Candidate& b) {
+        if (a.gasPrice != b.gasPrice) return a.gasPrice < b.gasPrice;
+        return a.sender < b.sender; // Same order as HeadSet
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(lowerPriority)> queue(lowerPriority);
+
+    // Each shard has at most one head queued; the rest of its copied batch waits here
+    struct HeadBatch {
+        std::vector<HeadKey> heads;
+        size_t next = 0;
+        bool exhausted = false; // The shard had no more heads at the last copy
+    };
+    std::array<HeadBatch, SHARD_COUNT> batches;
+    auto queueNextHead = [&](size_t index) {
+        HeadBatch& batch = batches[index];
+        if (batch.next == batch.heads.size()) {
+            if (batch.exhausted) return;
+            const Shard& shard = shards[index];
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            // Resume after the last head copied, wherever the shard has changed since
+            auto it = batch.heads.empty() ? shard.heads.begin() : shard.heads.upper_bound(batch.heads.back());
+            batch.heads.clear();
+            batch.next = 0;
+            for (; it != shard.heads.end() && batch.heads.size() < HEAD_BATCH; ++it) batch.heads.push_back(*it);
+            batch.exhausted = batch.heads.size() < HEAD_BATCH;
+            if (batch.heads.empty()) return;
+        }
+        const HeadKey& head = batch.heads[batch.next++];
+        queue.push({head.first, head.second, index, false, 0});
+    };
+    for (size_t i = 0; i < SHARD_COUNT; ++i) queueNextHead(i);
+
+    std::unordered_set<Address> resolved;
+    std::vector<Transaction> selected;
+    while (selected.size() < maxCount && !queue.empty()) {
+        Candidate cur = queue.top();
+        queue.pop();
+        const Shard& shard = shards[cur.shard];
+
+        if (!cur.resolved) {
+            queueNextHead(cur.shard);
+            // A lane shows up again when its head changed between copies
+            if (!resolved.insert(cur.sender).second) continue;
+            uint64_t expected = accountNonce(cur.sender);
+            // Skips txs already covered by state; a nonce gap keeps waiting
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            const Transaction* tx = shard.find(cur.sender, expected);
+            if (!tx) continue;
+            queue.push({tx->gasPrice, std::move(cur.sender), cur.shard, true, expected});
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        const Transaction* tx = shard.find(cur.sender, cur.nonce);
+        if (!tx) continue; // Removed meanwhile; the lane cannot go on
+        selected.push_back(*tx);
+        if (const Transaction* next = shard.find(cur.sender, cur.nonce + 1)) {
+            queue.push({next->gasPrice, std::move(cur.sender), cur.shard, true, cur.nonce + 1});
+        }
+    }
+    return selected;
+}
+
+bool Mempool::remove(const Hash& txHash) {
+    // The sender is unknown here, so probe every shard
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.byHash.find(txHash);
+        if (it == shard.byHash.end()) continue;
+        auto [sender, nonce] = it->second;
+        adjustCount(shard.erase(sender, nonce));
+        return true;
+    }
+    return false;
+}
+
+void Mempool::pruneSender(const Address& sender, uint64_t accountNonce) {
+    Shard& shard = shardFor(sender);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    auto laneIt = shard.lanes.find(sender);
+    while (laneIt != shard.lanes.end() && laneIt->second.begin()->first < accountNonce) {
+        adjustCount(shard.erase(sender, laneIt->second.begin()->first));
+        laneIt = shard.lanes.find(sender);
+    }
+}
+
+bool Mempool::contains(const Hash& txHash) const {
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        if (shard.byHash.count(txHash)) return true;
+    }
+    return false;
+}
+
 size_t Mempool::size() const {
-    return queue.size();
+    return count.load(std::memory_order_relaxed);
+}
+
+Mempool::Shard& Mempool::shardFor(const Address& sender) {
+    return shards[std::hash<Address>{}(sender) % SHARD_COUNT];
+}
+
+std::vector<std::unique_lock<std::mutex>> Mempool::lockAll() const {
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(SHARD_COUNT);
+    for (const auto& shard : shards) {
+        locks.emplace_back(shard.mtx);
+    }
+    return locks;
+}
+
+bool Mempool::reserveSlot() {
+    size_t current = count.load(std::memory_order_relaxed);
+    while (current < capacity) {
+        if (count.compare_exchange_weak(current, current + 1, std::memory_order_relaxed)) return true;
+    }
+    return false;
+}
+
+void Mempool::adjustCount(int delta) {
+    if (delta > 0) count.fetch_add(delta, std::memory_order_relaxed);
+    else if (delta < 0) count.fetch_sub(-delta, std::memory_order_relaxed);
+}
+
+bool Mempool::Shard::admits(const Transaction& tx, bool& replaces) const {
+    if (byHash.count(tx.hash)) return false;
+
+    // Same sender and nonce: only replace if the new tx outbids the pending one
+    auto laneIt = lanes.find(tx.sender);
+    if (laneIt != lanes.end()) {
+        auto existing = laneIt->second.find(tx.nonce);
+        if (existing != laneIt->second.end()) {
+            uint64_t oldPrice = existing->second.gasPrice;
+            uint64_t minPrice = oldPrice + oldPrice * REPLACE_PRICE_BUMP_PERCENT / 100;
+            if (tx.gasPrice <= oldPrice || tx.gasPrice < minPrice) return false;
+            replaces = true;
+        }
+    }
+    return true;
+}
+
+void Mempool::Shard::insert(const Transaction& tx) {
+    Lane& lane = lanes[tx.sender];
+    bool newHead = lane.empty() || tx.nonce < lane.begin()->first;
+    if (newHead && !lane.empty()) {
+        heads.erase({lane.begin()->second.gasPrice, tx.sender});
+    }
+
+    lane.emplace(tx.nonce, tx);
+    byHash[tx.hash] = {tx.sender, tx.nonce};
+    priced.insert({tx.gasPrice, tx.hash});
+    if (newHead) {
+        heads.insert({tx.gasPrice, tx.sender});
+    }
+}
+
+int Mempool::Shard::erase(const Address& sender, uint64_t nonce) {
+    auto laneIt = lanes.find(sender);
+    if (laneIt == lanes.end()) return 0;
+    Lane& lane = laneIt->second;
+    auto it = lane.find(nonce);
+    if (it == lane.end()) return 0;
+
+    bool wasHead = (it == lane.begin());
+    if (wasHead) {
+        heads.erase({it->second.gasPrice, sender});
+    }
+    byHash.erase(it->second.hash);
+    priced.erase({it->second.gasPrice, it->second.hash});
+    lane.erase(it);
+
+    if (lane.empty()) {
+        lanes.erase(laneIt);
+    } else if (wasHead) {
+        heads.insert({lane.begin()->second.gasPrice, sender});
+    }
+    return -1;
+}
+
+const Transaction* Mempool::Shard::find(const Address& sender, uint64_t nonce) const {
+    auto laneIt = lanes.find(sender);
+    if (laneIt == lanes.end()) return nullptr;
+    auto it = laneIt->second.find(nonce);
+    return it == laneIt->second.end() ? nullptr : &it->second;
+}
+
+int Mempool::Shard::evictCheapest() {
+    auto [sender, nonce] = byHash.at(priced.begin()->second);
+
+    // Later nonces of the same sender can never execute once this one is gone
+    const Lane& lane = lanes.at(sender);
+    std::vector<uint64_t> doomed;
+    for (auto it = lane.find(nonce); it != lane.end(); ++it) {
+        doomed.push_back(it->first);
+    }
+    int delta = 0;
+    for (uint64_t n : doomed) {
+        delta += erase(sender, n);
+    }
+    return delta;
 }
 
 }
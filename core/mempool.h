@@ -1,17 +1,98 @@
 #pragma once
 #include "transaction.h"
-#include <deque>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <functional>
+#include <vector>
+#include <array>
+#include <mutex>
+#include <atomic>
 
 namespace aegen {
 
+/**
+ * Mempool - Pending transaction pool
+ *
+ * Transactions are kept in per-sender lanes ordered by nonce. Only the head of
+ * each lane (its lowest nonce) is ranked by gas price, so the block producer can
+ * pull the best executable transactions without ever sorting the whole pool.
+ * A priced index over every pending tx drives eviction once capacity is reached.
+ *
+ * Thread-safety: senders are striped across SHARD_COUNT shards, each with its own
+ * lock, so RPC workers submitting for different senders rarely contend. Whole-pool
+ * operations (pop, and add once the pool is full) lock every shard in index
+ * order. selectExecutable holds one shard lock at a time, never while it looks
+ * up a nonce.
+ */
 class Mempool {
-    std::deque<Transaction> queue;
 public:
+    static constexpr size_t DEFAULT_CAPACITY = 50000;
+    static constexpr size_t SHARD_COUNT = 16;
+    static constexpr uint64_t REPLACE_PRICE_BUMP_PERCENT = 10;
+    // Lane heads selectExecutable copies out of a shard per lock
+    static constexpr size_t HEAD_BATCH = 8;
+
+    // Returns the next nonce the state expects from an account
+    using NonceLookup = std::function<uint64_t(const Address&)>;
+
+    // Capacity bounds the whole pool, whichever shards the txs land in
+    explicit Mempool(size_t capacity = DEFAULT_CAPACITY);
+
     bool validate(const Transaction& tx);
-    void add(const Transaction& tx);
+
+    // Returns false if the tx was rejected (invalid, duplicate, underpriced replacement or pool full)
+    bool add(const Transaction& tx);
     Transaction pop();
+
+    // Best-paying transactions that can run in order against the current nonces.
+    // Lanes with a nonce gap are skipped, not dropped. Lane heads are pulled
+    // from the shards HEAD_BATCH at a time, best first, so the cost is
+    // O((k + g) log n) for k selected past g lanes that cannot run, however many
+    // senders are pooled. Txs added meanwhile may or may not be seen.
+    std::vector<Transaction> selectExecutable(size_t maxCount, const NonceLookup& accountNonce) const;
+
+    bool remove(const Hash& txHash);
+    // Drop a sender's txs that are already covered by its account nonce
+    void pruneSender(const Address& sender, uint64_t accountNonce);
+
+    bool contains(const Hash& txHash) const;
     size_t size() const;
-    // Add peek or other utility
+
+private:
+    using Lane = std::map<uint64_t, Transaction>;  // nonce -> tx
+    using HeadKey = std::pair<uint64_t, Address>;  // (gasPrice, sender)
+    using PricedKey = std::pair<uint64_t, Hash>;   // (gasPrice, tx hash)
+    using HeadSet = std::set<HeadKey, std::greater<HeadKey>>;
+
+    struct Shard {
+        mutable std::mutex mtx;
+        std::unordered_map<Address, Lane> lanes;
+        std::unordered_map<Hash, std::pair<Address, uint64_t>, HashHasher> byHash;
+        HeadSet heads;             // Lane heads, highest price first
+        std::set<PricedKey> priced; // All txs, cheapest first
+
+        // Callers hold mtx. Counts are reported as the change in pooled txs.
+        // False for a duplicate or an underpriced replacement; `replaces` is set
+        // when tx outbids the pending tx with its nonce.
+        bool admits(const Transaction& tx, bool& replaces) const;
+        int erase(const Address& sender, uint64_t nonce);
+        const Transaction* find(const Address& sender, uint64_t nonce) const;
+        int evictCheapest();
+        void insert(const Transaction& tx);
+    };
+
+    const size_t capacity;
+    std::array<Shard, SHARD_COUNT> shards;
+    std::atomic<size_t> count{0};
+
+    Shard& shardFor(const Address& sender);
+    std::vector<std::unique_lock<std::mutex>> lockAll() const;
+    void adjustCount(int delta);
+    // Takes a slot for one more tx; false when the pool is full
+    bool reserveSlot();
+    // Slow path of add() for a full pool: outbid the cheapest tx of any shard
+    bool addEvicting(const Transaction& tx);
 };
 
 }
@@ -13,16 +13,17 @@ struct Log {
 };
 
 struct TransactionReceipt {
-    Hash transactionHash;
-    uint64_t transactionIndex;
-    Hash blockHash;
-    uint64_t blockNumber;
+    Hash transactionHash{};
+    uint64_t transactionIndex = 0;
+    Hash blockHash{};
+    uint64_t blockNumber = 0;
     Address from;
     Address to;
-    uint64_t gasUsed;
+    uint64_t gasUsed = 0;
+    uint64_t cumulativeGasUsed = 0; // Gas used in the block up to and including this tx
     Address contractAddress; // If deployment
     std::vector<Log> logs;
-    bool status; // 1 success, 0 failure
+    bool status = false; // 1 success, 0 failure
 };
 
 }
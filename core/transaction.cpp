@@ -7,85 +7,133 @@
 
 namespace aegen {
 
-Bytes Transaction::serialize() const {
-    Bytes buffer;
-    auto append = [&](const void* input, size_t size) {
-        const uint8_t* p = static_cast<const uint8_t*>(input);
-        buffer.insert(buffer.end(), p, p + size);
-    };
-    auto appendStr = [&](const std::string& s) {
-        uint32_t len = (uint32_t)s.length();
-        append(&len, sizeof(len));
-        append(s.data(), len);
+// Feeds the serialize() encoding of every field before the signature to
+// `out`, which takes update(const uint8_t*, size_t): a hasher or a buffer
+template <typename Sink>
+static void encodeUnsigned(const Transaction& tx, Sink& out) {
+    auto appendLength = [&](size_t size) {
+        uint32_t len = (uint32_t)size;
+        out.update(reinterpret_cast<const uint8_t*>(&len), sizeof(len));
     };
-    auto appendBytes = [&](const Bytes& b) {
-        uint32_t len = (uint32_t)b.size();
-        append(&len, sizeof(len));
-        buffer.insert(buffer.end(), b.begin(), b.end());
+    auto appendValue = [&](const uint64_t& value) {
+        out.update(reinterpret_cast<const uint8_t*>(&value), sizeof(value));
     };
 
-    appendStr(sender);
-    appendStr(receiver);
-    append(&amount, sizeof(amount));
-    append(&nonce, sizeof(nonce));
-    append(&gasLimit, sizeof(gasLimit));
-    append(&gasPrice, sizeof(gasPrice));
-    appendBytes(data);
-    appendBytes(signature);
-    
+    appendLength(tx.sender.size());
+    out.update(reinterpret_cast<const uint8_t*>(tx.sender.data()), tx.sender.size());
+    appendLength(tx.receiver.size());
+    out.update(reinterpret_cast<const uint8_t*>(tx.receiver.data()), tx.receiver.size());
+    appendValue(tx.amount);
+    appendValue(tx.nonce);
+    appendValue(tx.gasLimit);
+    appendValue(tx.gasPrice);
+    appendLength(tx.data.size());
+    out.update(tx.data.data(), tx.data.size());
+}
+
+template <typename Sink>
+static void encodeSignature(const Signature& signature, Sink& out) {
+    uint32_t len = (uint32_t)signature.size();
+    out.update(reinterpret_cast<const uint8_t*>(&len), sizeof(len));
+    out.update(signature.data(), signature.size());
+}
+
+namespace {
+
+struct BufferSink {
+    Bytes& buffer;
+    void update(const uint8_t* p, size_t size) { buffer.insert(buffer.end(), p, p + size); }
+};
+
+}
+
+size_t Transaction::serializedSize() const {
+    return 4 + sender.size() + 4 + receiver.size() + 4 * sizeof(uint64_t) + 4 + data.size() + 4 + signature.size();
+}
+
+void Transaction::serializeTo(Bytes& out) const {
+    out.reserve(out.size() + serializedSize());
+    BufferSink sink{out};
+    encodeUnsigned(*this, sink);
+    encodeSignature(signature, sink);
+}
+
+Bytes Transaction::serialize() const {
+    Bytes buffer;
+    serializeTo(buffer);
     return buffer;
 }
 
 Transaction Transaction::deserialize(const Bytes& data) {
     Transaction tx;
+    if (!decode(data.data(), data.size(), tx)) throw std::runtime_error("Tx deserialization OOB");
+
+    // Recalculate hash for object consistency
+    tx.calculateHash();
+    
+    return tx;
+}
+
+bool Transaction::decode(const uint8_t* data, size_t size, Transaction& tx) {
     size_t offset = 0;
     
-    auto read = [&](void* dest, size_t size) {
-        if (offset + size > data.size()) throw std::runtime_error("Tx deserialization OOB");
-        std::memcpy(dest, &data[offset], size);
-        offset += size;
+    auto read = [&](void* dest, size_t n) {
+        if (n > size - offset) return false;
+        std::memcpy(dest, data + offset, n);
+        offset += n;
+        return true;
     };
     auto readStr = [&](std::string& s) {
         uint32_t len;
-        read(&len, sizeof(len));
-        if (offset + len > data.size()) throw std::runtime_error("Tx deserialization OOB string");
-        s.assign((char*)&data[offset], len);
+        if (!read(&len, sizeof(len)) || len > size - offset) return false;
+        s.assign((const char*)data + offset, len);
         offset += len;
+        return true;
     };
     auto readBytes = [&](Bytes& b) {
         uint32_t len;
-        read(&len, sizeof(len));
-        if (offset + len > data.size()) throw std::runtime_error("Tx deserialization OOB bytes");
-        b.assign(data.begin() + offset, data.begin() + offset + len);
+        if (!read(&len, sizeof(len)) || len > size - offset) return false;
+        b.assign(data + offset, data + offset + len);
         offset += len;
+        return true;
     };
 
-    readStr(tx.sender);
-    readStr(tx.receiver);
-    read(&tx.amount, sizeof(tx.amount));
-    read(&tx.nonce, sizeof(tx.nonce));
-    read(&tx.gasLimit, sizeof(tx.gasLimit));
-    read(&tx.gasPrice, sizeof(tx.gasPrice));
-    readBytes(tx.data);
-    readBytes(tx.signature);
-    
-    // Recalculate hash for object consistency
-    tx.calculateHash();
-    
-    return tx;
+    return readStr(tx.sender) && readStr(tx.receiver) &&
+           read(&tx.amount, sizeof(tx.amount)) && read(&tx.nonce, sizeof(tx.nonce)) &&
+           read(&tx.gasLimit, sizeof(tx.gasLimit)) && read(&tx.gasPrice, sizeof(tx.gasPrice)) &&
+           readBytes(tx.data) && readBytes(tx.signature) && offset == size;
 }
 
 void Transaction::calculateHash() {
-    Bytes serialized = serialize();
-    auto h = crypto::sha256_bytes(serialized);
-    std::copy(h.begin(), h.end(), hash.begin());
+    crypto::SHA256 hasher;
+    encodeUnsigned(*this, hasher);
+    encodeSignature(signature, hasher);
+    hash = hasher.finalize();
+}
+
+Bytes Transaction::signingMessage() const {
+    Bytes message;
+    message.reserve(serializedSize() - signature.size());
+    BufferSink sink{message};
+    encodeUnsigned(*this, sink);
+    encodeSignature(Signature{}, sink);
+    return message;
+}
+
+// Streams signingMessage() into a signature's hasher, calldata included, without a copy
+static void writeSigningMessage(const Transaction& tx, crypto::SHA256& hasher) {
+    encodeUnsigned(tx, hasher);
+    encodeSignature(Signature{}, hasher);
+}
+
+void Transaction::sign(const PrivateKey& key) {
+    signature = Signer::sign([this](crypto::SHA256& hasher) { writeSigningMessage(*this, hasher); }, key);
+    calculateHash();
 }
 
 bool Transaction::isSignedBy(const PublicKey& pk) const {
-    Transaction txCopy = *this;
-    txCopy.signature.clear();
-    Bytes txData = txCopy.serialize();
-    return Signer::verify(txData, signature, pk);
+    // Always from the current fields; a cached digest could outlive a change to them
+    return Signer::verify([this](crypto::SHA256& hasher) { writeSigningMessage(*this, hasher); }, signature, pk);
 }
 
 }
@@ -12,11 +12,22 @@ struct Transaction {
     uint64_t gasPrice = 1;
     Bytes data;
     Signature signature;
-    Hash hash;
+    Hash hash{}; // Over serialize(), signature included
 
     static Transaction deserialize(const Bytes& data);
+    // Non-throwing decode of serialize() output; leaves hash unset
+    static bool decode(const uint8_t* data, size_t size, Transaction& tx);
     Bytes serialize() const;
+    // Appends serialize() output to `out` without a temporary buffer
+    void serializeTo(Bytes& out) const;
+    size_t serializedSize() const;
+
+    // Sets hash in one streamed pass over the fields
     void calculateHash();
+    // What the signature covers: serialize() with an empty signature
+    Bytes signingMessage() const;
+    // Signs the signing message and recalculates the hash
+    void sign(const PrivateKey& key);
     bool isSignedBy(const PublicKey& pk) const;
 };
 
@@ -3,6 +3,7 @@
 #include <vector>
 #include <array>
 #include <cstdint>
+#include <cstring>
 
 namespace aegen {
 
@@ -14,6 +15,15 @@ using PrivateKey = std::vector<Byte>; // 32 bytes for Ed25519 seed
 using Signature = std::vector<Byte>;  // 64 bytes for Ed25519
 using TokenId = std::string;
 
+// Hashes are already uniformly distributed, so the first word is a good bucket key
+struct HashHasher {
+    size_t operator()(const Hash& h) const {
+        size_t v;
+        std::memcpy(&v, h.data(), sizeof(v));
+        return v;
+    }
+};
+
 // Kadena-style address format:
 // - Simple: "alice", "bob" (user-defined)
 // - Single-key: "k:abc123..." (k: prefix + public key hex)
@@ -2,12 +2,18 @@
 #include "core/block.h"
 #include "util/crypto.h"
 #include "rocksdb_wrapper.h"
+#include "coding.h"
+#include "util/lru_cache.h"
+#include <iostream>
 #include <vector>
-#include <map>
 #include <mutex>
 #include <string>
 #include <sstream>
 #include <memory>
+#include <cstring>
+#include <string_view>
+#include <optional>
+#include <atomic>
 
 namespace aegen {
 
@@ -15,50 +21,122 @@ namespace aegen {
  * BlockStore - Persistent block storage using RocksDB
  * 
  * Stores finalized blocks with disk persistence.
- * Keys: "block:{height}" -> serialized block
+ * Keys: "block:{height as 8-byte big-endian}" -> versioned Block::serialize()
+ *       record, so key order is height order and ranges of blocks are one
+ *       ordered scan
+ *       "tx:{32-byte hash}" -> height and index of the transaction in its block
+ *       "addr:{address}\0{height}{index}" -> "" for each transaction an address took part in
+ *       "total:{height}" -> cumulative transaction count and gas used through that block
  * Meta: "meta:height" -> current blockchain height
+ *       "meta:totals" -> cumulative totals through the newest block
+ *
+ * Nothing but the height is read at startup. Blocks are read on demand and the
+ * most recent ones are kept in a bounded LRU, so startup time and memory do
+ * not grow with the chain.
  */
 class BlockStore {
+public:
+    struct TxLocation {
+        uint64_t height = 0;
+        uint32_t index = 0;
+    };
+
+    struct Totals {
+        uint64_t transactions = 0;
+        uint64_t gasUsed = 0;
+    };
+
+private:
     std::unique_ptr<RocksDBWrapper> db;
-    std::vector<Block> cache;  // In-memory cache for fast access
-    std::map<uint64_t, size_t> heightIndex;
-    std::mutex mtx;
+    LRUCache<uint64_t, Block> recent; // Recently added or read blocks
+    std::mutex mtx;                   // Guards recent, currentHeight and hasGenesis
     uint64_t currentHeight = 0;
+    bool hasGenesis = false;
+
+    // Totals through the newest added block; tipTotalsHeight is guarded by mtx
+    std::atomic<uint64_t> totalTransactions{0};
+    std::atomic<uint64_t> totalGasUsed{0};
+    std::optional<uint64_t> tipTotalsHeight;
+
+    // Record: version byte | Block::serialize() | one 32-byte hash per transaction.
+    // Storing the hashes saves rehashing every transaction on each read.
+    static constexpr uint8_t RECORD_VERSION = 1;
+
+    static std::string serializeBlock(const Block& block) {
+        std::vector<uint8_t> body = block.serialize();
+        std::string record;
+        record.reserve(1 + body.size() + block.transactions.size() * 32);
+        record.push_back((char)RECORD_VERSION);
+        record.append((const char*)body.data(), body.size());
+        for (const auto& tx : block.transactions) record.append((const char*)tx.hash.data(), tx.hash.size());
+        return record;
+    }
 
-    // Serialize block to string
-    std::string serializeBlock(const Block& block) {
-        std::stringstream ss;
-        ss << block.header.height << "|";
-        ss << crypto::to_hex(block.header.previousHash) << "|";
-        ss << crypto::to_hex(block.header.stateRoot) << "|";
-        ss << block.header.timestamp << "|";
-        ss << block.transactions.size() << "|";
-        
-        for (const auto& tx : block.transactions) {
-            ss << tx.sender << "," << tx.receiver << "," << tx.amount << "," 
-               << tx.nonce << "," << crypto::to_hex(tx.hash) << ";";
+    // Length of the Block::serialize() part of a versioned record, or false
+    static bool recordBody(std::string_view data, BlockHeader& header, uint32_t& txCount, size_t& bodySize) {
+        if (data.empty() || (uint8_t)data[0] != RECORD_VERSION) return false;
+        const uint8_t* body = (const uint8_t*)data.data() + 1;
+        if (!Block::decodeHeader(body, data.size() - 1, header, txCount)) return false;
+        size_t hashBytes = (size_t)txCount * 32;
+        if (hashBytes > data.size() - 1) return false;
+        bodySize = data.size() - 1 - hashBytes;
+        return true;
+    }
+
+    // False on malformed input instead of throwing, so one bad record cannot stop startup
+    static bool deserializeBlock(std::string_view data, Block& block) {
+        if (data.empty()) return false;
+        if ((uint8_t)data[0] != RECORD_VERSION) return deserializeTextBlock(std::string(data), block);
+
+        BlockHeader header;
+        uint32_t txCount;
+        size_t bodySize;
+        if (!recordBody(data, header, txCount, bodySize)) return false;
+        const uint8_t* body = (const uint8_t*)data.data() + 1;
+        if (!Block::decode(body, bodySize, block)) return false;
+        const uint8_t* hashes = body + bodySize;
+        for (auto& tx : block.transactions) {
+            std::memcpy(tx.hash.data(), hashes, tx.hash.size());
+            hashes += tx.hash.size();
         }
-        return ss.str();
+        return true;
+    }
+
+    static bool deserializeHeader(std::string_view data, BlockHeader& header, uint64_t& txCount) {
+        if (!data.empty() && (uint8_t)data[0] == RECORD_VERSION) {
+            uint32_t count;
+            size_t bodySize;
+            if (!recordBody(data, header, count, bodySize)) return false;
+            txCount = count;
+            return true;
+        }
+        Block block;
+        if (!deserializeBlock(data, block)) return false;
+        header = block.header;
+        txCount = block.transactions.size();
+        return true;
     }
 
-    // Deserialize block from string
     // Convert vector to Hash array
-    Hash vectorToHash(const std::vector<uint8_t>& vec) {
+    static Hash vectorToHash(const std::vector<uint8_t>& vec) {
         Hash h{};
         size_t copyLen = std::min(vec.size(), h.size());
         std::copy(vec.begin(), vec.begin() + copyLen, h.begin());
         return h;
     }
 
-    Block deserializeBlock(const std::string& data) {
-        Block block;
-        if (data.empty()) return block;
+    // Records written before the binary format: "height|prev|stateRoot|timestamp|txCount|txs"
+    // with txs as "sender,receiver,amount,nonce,hash;". Still readable; they lack
+    // txRoot, producer, signatures, tx data and gas fields.
+    static bool deserializeTextBlock(const std::string& data, Block& block) {
+        if (data.empty()) return false;
 
         std::stringstream ss(data);
         std::string token;
+        uint64_t txCount = 0;
 
         std::getline(ss, token, '|');
-        block.header.height = std::stoull(token);
+        if (!coding::parseUint64(token, block.header.height)) return false;
 
         std::getline(ss, token, '|');
         block.header.previousHash = vectorToHash(crypto::from_hex(token));
@@ -67,10 +145,10 @@ class BlockStore {
         block.header.stateRoot = vectorToHash(crypto::from_hex(token));
 
         std::getline(ss, token, '|');
-        block.header.timestamp = std::stoull(token);
+        if (!coding::parseUint64(token, block.header.timestamp)) return false;
 
         std::getline(ss, token, '|');
-        size_t txCount = std::stoull(token);
+        if (!coding::parseUint64(token, txCount)) return false;
 
         // Parse transactions
         std::string txData;
@@ -86,40 +164,252 @@ class BlockStore {
                 
                 std::getline(txParts, part, ','); tx.sender = part;
                 std::getline(txParts, part, ','); tx.receiver = part;
-                std::getline(txParts, part, ','); tx.amount = std::stoull(part);
-                std::getline(txParts, part, ','); tx.nonce = std::stoull(part);
+                std::getline(txParts, part, ','); if (!coding::parseUint64(part, tx.amount)) return false;
+                std::getline(txParts, part, ','); if (!coding::parseUint64(part, tx.nonce)) return false;
                 std::getline(txParts, part, ','); tx.hash = vectorToHash(crypto::from_hex(part));
                 
                 block.transactions.push_back(tx);
             }
         }
+        return block.transactions.size() == txCount;
+    }
 
-        return block;
+    static constexpr const char* BLOCK_PREFIX = "block:";
+    static constexpr const char* TX_PREFIX = "tx:";
+    static constexpr const char* TX_INDEX_MARKER = "meta:txIndex";
+    static constexpr const char* ADDR_PREFIX = "addr:";
+    static constexpr const char* ADDR_INDEX_MARKER = "meta:addrIndex";
+    static constexpr const char* TOTALS_PREFIX = "total:";
+    static constexpr const char* TOTALS_KEY = "meta:totals";
+
+    static std::string blockKey(uint64_t height) {
+        std::string key = BLOCK_PREFIX;
+        for (int shift = 56; shift >= 0; shift -= 8) key.push_back((char)(height >> shift));
+        return key;
+    }
+
+    static bool parseBlockKey(std::string_view key, uint64_t& height) {
+        if (key.size() != 6 + 8) return false;
+        height = 0;
+        for (size_t i = 6; i < key.size(); ++i) height = (height << 8) | (uint8_t)key[i];
+        return true;
+    }
+
+    // Stores written before big-endian keys used "block:{decimal}". Those keys
+    // sort in ["block:0", "block::"), where no big-endian key can fall, so a
+    // store that is already migrated costs one seek.
+    void migrateDecimalKeys() {
+        ReadOptions range;
+        range.lowerBound = std::string(BLOCK_PREFIX) + "0";
+        range.upperBound = std::string(BLOCK_PREFIX) + ":";
+        auto it = db->newIterator(range);
+
+        std::vector<std::pair<std::string, std::string>> puts;
+        std::vector<std::string> dels;
+        size_t migrated = 0;
+        for (it->seekToFirst(); it->valid(); it->next()) {
+            uint64_t h;
+            std::string key(it->key());
+            if (!coding::parseUint64(key.substr(6), h)) continue;
+            puts.push_back({blockKey(h), std::string(it->value())});
+            dels.push_back(std::move(key));
+            // Bounded batches so a long legacy chain is not held in memory at once
+            if (puts.size() >= 1024) {
+                db->writeBatch(puts, dels);
+                migrated += puts.size();
+                puts.clear();
+                dels.clear();
+            }
+        }
+        if (!puts.empty()) {
+            db->writeBatch(puts, dels);
+            migrated += puts.size();
+        }
+        if (migrated > 0) {
+            std::cout << "[BlockStore] Migrated " << migrated << " blocks to ordered keys" << std::endl;
+        }
     }
 
+    ReadOptions blockRange() const {
+        ReadOptions range;
+        range.lowerBound = BLOCK_PREFIX;
+        range.upperBound = RocksDBWrapper::prefixUpperBound(BLOCK_PREFIX);
+        return range;
+    }
+
+    // Only the height is read at startup; blocks are loaded on demand
     void loadFromDisk() {
-        // Load height
+        migrateDecimalKeys();
+
+        // If the marker is missing or unreadable, fall back to the highest stored block
         std::string heightStr = db->get("meta:height");
-        if (!heightStr.empty()) {
-            currentHeight = std::stoull(heightStr);
-        }
-
-        // Load all blocks into cache
-        for (uint64_t h = 0; h <= currentHeight; h++) {
-            std::string key = "block:" + std::to_string(h);
-            std::string data = db->get(key);
-            if (!data.empty()) {
-                Block block = deserializeBlock(data);
-                cache.push_back(block);
-                heightIndex[h] = cache.size() - 1;
+        if (heightStr.empty() || !coding::parseUint64(heightStr, currentHeight)) {
+            if (!heightStr.empty()) {
+                std::cerr << "[BlockStore] Corrupt meta:height, rebuilding from stored blocks" << std::endl;
             }
+            currentHeight = 0;
+            auto it = db->newIterator(blockRange());
+            it->seekToLast();
+            if (it->valid()) parseBlockKey(it->key(), currentHeight);
         }
+        hasGenesis = db->exists(blockKey(0));
+        buildIndexes();
+        loadTotals();
+    }
+
+    static std::string txKey(const Hash& hash) {
+        return std::string(TX_PREFIX) + std::string((const char*)hash.data(), hash.size());
+    }
+
+    // "addr:{address}\0{height BE}{index BE}": one empty entry per transaction
+    // an address sent or received, so a reverse scan lists its history newest first
+    static std::string addressPrefix(const Address& addr) {
+        return std::string(ADDR_PREFIX) + addr + '\0';
+    }
+
+    static std::string addressKey(const Address& addr, const TxLocation& location) {
+        std::string key = addressPrefix(addr);
+        for (int shift = 56; shift >= 0; shift -= 8) key.push_back((char)(location.height >> shift));
+        for (int shift = 24; shift >= 0; shift -= 8) key.push_back((char)(location.index >> shift));
+        return key;
+    }
+
+    static bool parseAddressKey(std::string_view key, size_t prefixSize, TxLocation& location) {
+        if (key.size() != prefixSize + 12) return false;
+        location = TxLocation{};
+        for (size_t i = prefixSize; i < prefixSize + 8; ++i) location.height = (location.height << 8) | (uint8_t)key[i];
+        for (size_t i = prefixSize + 8; i < key.size(); ++i) location.index = (location.index << 8) | (uint8_t)key[i];
+        return true;
+    }
+
+    // Secondary index entries for one block
+    static void addIndexEntries(const Block& block, std::vector<std::pair<std::string, std::string>>& puts,
+                                bool txIndex = true, bool addressIndex = true) {
+        for (size_t i = 0; i < block.transactions.size(); ++i) {
+            const Transaction& tx = block.transactions[i];
+            TxLocation location{block.header.height, (uint32_t)i};
+            if (txIndex) {
+                // height (8) | index in block (4)
+                std::string value;
+                coding::putFixed64(value, location.height);
+                coding::putFixed32(value, location.index);
+                puts.push_back({txKey(tx.hash), std::move(value)});
+            }
+            if (addressIndex) {
+                puts.push_back({addressKey(tx.sender, location), ""});
+                if (!tx.receiver.empty() && tx.receiver != tx.sender) {
+                    puts.push_back({addressKey(tx.receiver, location), ""});
+                }
+            }
+        }
+    }
+
+    // Stores written before an index existed are indexed once, in bounded batches
+    void buildIndexes() {
+        bool txIndex = !db->exists(TX_INDEX_MARKER);
+        bool addressIndex = !db->exists(ADDR_INDEX_MARKER);
+        if (!txIndex && !addressIndex) return;
+
+        std::vector<std::pair<std::string, std::string>> puts;
+        size_t indexed = 0;
+        auto it = db->newIterator(blockRange());
+        for (it->seekToFirst(); it->valid(); it->next()) {
+            Block block;
+            if (!deserializeBlock(it->value(), block)) continue;
+            addIndexEntries(block, puts, txIndex, addressIndex);
+            indexed += block.transactions.size();
+            if (puts.size() >= 1024) {
+                db->writeBatch(puts, {});
+                puts.clear();
+            }
+        }
+        if (txIndex) puts.push_back({TX_INDEX_MARKER, "1"});
+        if (addressIndex) puts.push_back({ADDR_INDEX_MARKER, "1"});
+        db->writeBatch(puts, {});
+        if (indexed > 0) {
+            std::cout << "[BlockStore] Indexed " << indexed << " transactions" << std::endl;
+        }
+    }
+
+    static std::string totalsKey(uint64_t height) {
+        std::string key = TOTALS_PREFIX;
+        for (int shift = 56; shift >= 0; shift -= 8) key.push_back((char)(height >> shift));
+        return key;
+    }
+
+    static std::string encodeTotals(const Totals& totals) {
+        std::string value;
+        coding::putFixed64(value, totals.transactions);
+        coding::putFixed64(value, totals.gasUsed);
+        return value;
+    }
+
+    static bool decodeTotals(std::string_view value, Totals& totals) {
+        if (value.size() != 16) return false;
+        totals.transactions = coding::decodeFixed64(value.data());
+        totals.gasUsed = coding::decodeFixed64(value.data() + 8);
+        return true;
+    }
+
+    bool readTotals(uint64_t height, Totals& totals) {
+        return decodeTotals(db->get(totalsKey(height)), totals);
+    }
+
+    // Stores written before the counters existed get them in one pass. Gas used
+    // was never stored for those blocks, so it starts from zero.
+    void loadTotals() {
+        Totals totals;
+        if (!decodeTotals(db->get(TOTALS_KEY), totals)) {
+            std::vector<std::pair<std::string, std::string>> puts;
+            auto it = db->newIterator(blockRange());
+            for (it->seekToFirst(); it->valid(); it->next()) {
+                uint64_t h;
+                BlockHeader header;
+                uint64_t txCount;
+                if (!parseBlockKey(it->key(), h) || !deserializeHeader(it->value(), header, txCount)) continue;
+                totals.transactions += txCount;
+                puts.push_back({totalsKey(h), encodeTotals(totals)});
+                if (puts.size() >= 1024) {
+                    db->writeBatch(puts, {});
+                    puts.clear();
+                }
+            }
+            puts.push_back({TOTALS_KEY, encodeTotals(totals)});
+            db->writeBatch(puts, {});
+        }
+        tipTotalsHeight = currentHeight;
+        totalTransactions.store(totals.transactions);
+        totalGasUsed.store(totals.gasUsed);
+    }
+
+    // Callers do not hold mtx; the database read happens outside it
+    bool readBlock(uint64_t height, Block& block) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (Block* hit = recent.get(height)) {
+                block = *hit;
+                return true;
+            }
+        }
+        if (!db) return false;
+        std::string data = db->get(blockKey(height));
+        if (data.empty()) return false;
+        if (!deserializeBlock(data, block)) {
+            std::cerr << "[BlockStore] Skipping corrupt block " << height << std::endl;
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        recent.put(height, block);
+        return true;
     }
 
 public:
-    BlockStore() : db(nullptr) {}
+    static constexpr size_t DEFAULT_CACHE_CAPACITY = 1024;
+
+    // Without a database only the cached recent blocks are kept
+    BlockStore(size_t cacheCapacity = DEFAULT_CACHE_CAPACITY) : db(nullptr), recent(cacheCapacity) {}
     
-    BlockStore(const std::string& dbPath) {
+    BlockStore(const std::string& dbPath, size_t cacheCapacity = DEFAULT_CACHE_CAPACITY) : recent(cacheCapacity) {
         db = std::make_unique<RocksDBWrapper>(dbPath + "/blocks");
         loadFromDisk();
     }
@@ -131,55 +421,184 @@ public:
         }
     }
 
-    void addBlock(const Block& block) {
+    // gasUsed is the block's total from its receipts, which the block itself does not carry.
+    // The write is synced; false if it failed, in which case nothing changed.
+    bool addBlock(const Block& block, uint64_t gasUsed = 0) {
         std::lock_guard<std::mutex> lock(mtx);
-        
-        cache.push_back(block);
-        heightIndex[block.header.height] = cache.size() - 1;
-        currentHeight = block.header.height;
 
-        // Persist to disk
+        // Totals build on the previous block's, so re-adding a height does not double count
+        Totals totals;
+        if (block.header.height > 0) {
+            if (tipTotalsHeight && *tipTotalsHeight == block.header.height - 1) {
+                totals = {totalTransactions.load(), totalGasUsed.load()};
+            } else if (db) {
+                readTotals(block.header.height - 1, totals);
+            }
+        }
+        totals.transactions += block.transactions.size();
+        totals.gasUsed += gasUsed;
+
+        // Persist to disk; the block, its index entries, totals and the height land together
         if (db) {
-            std::string key = "block:" + std::to_string(block.header.height);
-            db->put(key, serializeBlock(block));
-            db->put("meta:height", std::to_string(currentHeight));
+            std::vector<std::pair<std::string, std::string>> puts = {
+                {blockKey(block.header.height), serializeBlock(block)},
+                {"meta:height", std::to_string(block.header.height)},
+                {totalsKey(block.header.height), encodeTotals(totals)},
+                {TOTALS_KEY, encodeTotals(totals)}};
+            addIndexEntries(block, puts);
+            if (!db->writeBatch(puts, {}, WriteOptions{true})) {
+                std::cerr << "[BlockStore] Failed to persist block " << block.header.height << std::endl;
+                return false;
+            }
+        }
+        recent.put(block.header.height, block);
+        currentHeight = block.header.height;
+        if (block.header.height == 0) hasGenesis = true;
+        tipTotalsHeight = block.header.height;
+        totalTransactions.store(totals.transactions);
+        totalGasUsed.store(totals.gasUsed);
+        return true;
+    }
+
+    // Cumulative totals up to and including a block
+    bool getTotals(uint64_t height, Totals& totals) {
+        if (!db) return false;
+        return readTotals(height, totals);
+    }
+
+    // One point read in the index
+    bool findTransaction(const Hash& hash, TxLocation& location) {
+        if (!db) return false;
+        std::string value = db->get(txKey(hash));
+        if (value.size() != 12) return false;
+        location.height = coding::decodeFixed64(value.data());
+        location.index = coding::decodeFixed32(value.data() + 8);
+        return true;
+    }
+
+    // An address's transactions, newest first, from `cursor` (inclusive) or the
+    // newest. `next` is set when more remain and is the cursor for the next page.
+    std::vector<TxLocation> getAddressTransactions(const Address& addr, const std::optional<TxLocation>& cursor,
+                                                   size_t limit, std::optional<TxLocation>& next) {
+        std::vector<TxLocation> result;
+        std::string prefix = addressPrefix(addr);
+        ReadOptions range;
+        range.lowerBound = prefix;
+        range.upperBound = cursor ? addressKey(addr, *cursor) + '\0' : RocksDBWrapper::prefixUpperBound(prefix);
+        next.reset(); // May alias cursor
+        if (!db || limit == 0) return result;
+
+        auto it = db->newIterator(range);
+        for (it->seekToLast(); it->valid(); it->prev()) {
+            TxLocation location;
+            if (!parseAddressKey(it->key(), prefix.size(), location)) continue;
+            if (result.size() == limit) {
+                next = location;
+                break;
+            }
+            result.push_back(location);
         }
+        return result;
+    }
+
+    // The transaction at a location, from the block cache or one block read
+    bool getTransactionAt(const TxLocation& location, Transaction& tx) {
+        Block block;
+        if (!readBlock(location.height, block) || location.index >= block.transactions.size()) return false;
+        tx = std::move(block.transactions[location.index]);
+        return true;
+    }
+
+    bool getTransaction(const Hash& hash, Transaction& tx, TxLocation& location) {
+        if (!findTransaction(hash, location)) return false;
+        Block block;
+        if (!readBlock(location.height, block) || location.index >= block.transactions.size()) return false;
+        if (block.transactions[location.index].hash != hash) return false;
+        tx = std::move(block.transactions[location.index]);
+        return true;
     }
 
     Block getBlock(uint64_t height) {
-        std::lock_guard<std::mutex> lock(mtx);
-        auto it = heightIndex.find(height);
-        if (it != heightIndex.end() && it->second < cache.size()) {
-            return cache[it->second];
+        Block block;
+        if (!readBlock(height, block)) return Block{};
+        return block;
+    }
+
+    struct HeaderInfo {
+        BlockHeader header{};
+        uint64_t txCount = 0;
+    };
+
+    // Decodes only the header, without touching the transaction bodies
+    bool getHeader(uint64_t height, HeaderInfo& info) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (Block* hit = recent.get(height)) {
+                info.header = hit->header;
+                info.txCount = hit->transactions.size();
+                return true;
+            }
         }
-        return Block{};
+        if (!db) return false;
+        return deserializeHeader(db->get(blockKey(height)), info.header, info.txCount);
     }
 
+    // Headers of up to count blocks, newest first, skipping the newest `start`
+    std::vector<HeaderInfo> getHeaders(uint64_t start, uint64_t count) {
+        std::vector<HeaderInfo> result;
+        uint64_t top = getHeight();
+        if (!db || count == 0 || start > top) return result;
+
+        ReadOptions range = blockRange();
+        range.upperBound = blockKey(top - start + 1);
+        auto it = db->newIterator(range);
+        for (it->seekToLast(); it->valid() && result.size() < count; it->prev()) {
+            HeaderInfo info;
+            if (!deserializeHeader(it->value(), info.header, info.txCount)) continue;
+            result.push_back(std::move(info));
+        }
+        return result;
+    }
+
+    // Up to count blocks, newest first, skipping the newest `start`
     std::vector<Block> getBlocks(uint64_t start, uint64_t count) {
-        std::lock_guard<std::mutex> lock(mtx);
         std::vector<Block> result;
-        
-        // Return blocks in reverse order (newest first)
-        int64_t startIdx = (int64_t)cache.size() - (int64_t)start;
-        for (int64_t i = startIdx; i > startIdx - (int64_t)count && i > 0; --i) {
-            result.push_back(cache[i - 1]);
+        uint64_t top = getHeight();
+        if (!db || count == 0 || start > top) return result;
+
+        // One reverse range scan; recent blocks still come from the cache
+        ReadOptions range = blockRange();
+        range.upperBound = blockKey(top - start + 1);
+        auto it = db->newIterator(range);
+        for (it->seekToLast(); it->valid() && result.size() < count; it->prev()) {
+            uint64_t h;
+            if (!parseBlockKey(it->key(), h)) continue;
+            Block block;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (Block* hit = recent.get(h)) {
+                    result.push_back(*hit);
+                    continue;
+                }
+            }
+            if (!deserializeBlock(it->value(), block)) {
+                std::cerr << "[BlockStore] Skipping corrupt block " << h << std::endl;
+                continue;
+            }
+            result.push_back(std::move(block));
         }
         return result;
     }
 
+    // A store holding only the genesis block reports height 1
     uint64_t getHeight() {
         std::lock_guard<std::mutex> lock(mtx);
-        return currentHeight > 0 ? currentHeight : cache.size();
+        return currentHeight > 0 ? currentHeight : (hasGenesis ? 1 : 0);
     }
 
-    uint64_t getTotalTransactions() {
-        std::lock_guard<std::mutex> lock(mtx);
-        uint64_t total = 0;
-        for (const auto& block : cache) {
-            total += block.transactions.size();
-        }
-        return total;
-    }
+    // Lock-free; they may trail a concurrent addBlock by one block
+    uint64_t getTotalTransactions() const { return totalTransactions.load(std::memory_order_relaxed); }
+    uint64_t getTotalGasUsed() const { return totalGasUsed.load(std::memory_order_relaxed); }
 
     // Force save to disk
     void flush() {
@@ -0,0 +1,97 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+namespace aegen {
+namespace coding {
+
+// Little-endian fixed-width integers used by the WAL, SSTables and MANIFEST
+
+inline void putFixed32(std::string& dst, uint32_t v) {
+    for (int i = 0; i < 4; ++i) dst.push_back((char)(v >> (8 * i)));
+}
+
+inline void putFixed64(std::string& dst, uint64_t v) {
+    for (int i = 0; i < 8; ++i) dst.push_back((char)(v >> (8 * i)));
+}
+
+inline uint32_t decodeFixed32(const char* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= (uint32_t)(uint8_t)p[i] << (8 * i);
+    return v;
+}
+
+inline uint64_t decodeFixed64(const char* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= (uint64_t)(uint8_t)p[i] << (8 * i);
+    return v;
+}
+
+// Length-prefixed byte string
+inline void putBytes(std::string& dst, const std::string& s) {
+    putFixed32(dst, (uint32_t)s.size());
+    dst.append(s);
+}
+
+// Reads a length-prefixed string at pos; false if it would run past `end`
+inline bool getBytes(const std::string& src, size_t& pos, size_t end, std::string& out) {
+    if (pos + 4 > end) return false;
+    uint32_t len = decodeFixed32(src.data() + pos);
+    if (len > end - pos - 4) return false;
+    out.assign(src, pos + 4, len);
+    pos += 4 + len;
+    return true;
+}
+
+// Decimal text to uint64 without exceptions; false on empty, non-digit or overflowing input
+inline bool parseUint64(const std::string& s, uint64_t& out) {
+    if (s.empty()) return false;
+    uint64_t v = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') return false;
+        uint64_t digit = (uint64_t)(c - '0');
+        if (v > (UINT64_MAX - digit) / 10) return false;
+        v = v * 10 + digit;
+    }
+    out = v;
+    return true;
+}
+
+// CRC-32C (Castagnoli), table driven
+inline uint32_t crc32c(const char* data, size_t n, uint32_t crc = 0) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0x82F63B78u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) {
+        crc = table[(crc ^ (uint8_t)data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+inline uint32_t crc32c(const std::string& s) { return crc32c(s.data(), s.size()); }
+
+// Stable 64-bit hash for on-disk bloom filters (std::hash may differ between builds).
+// FNV-1a followed by a murmur3 finalizer so the low bits mix well.
+inline uint64_t hash64(const std::string& s) {
+    uint64_t h = 1469598103934665603ull;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+}
+}
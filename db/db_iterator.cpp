@@ -0,0 +1,217 @@
+#include "db_iterator.h"
+#include <algorithm>
+
+namespace aegen {
+
+namespace {
+
+class MemTableIterator : public InternalIterator {
+    std::shared_ptr<const MemTable> table;
+    MemTable::const_iterator it;
+
+public:
+    explicit MemTableIterator(std::shared_ptr<const MemTable> t) : table(std::move(t)), it(table->end()) {}
+
+    bool valid() const override { return it != table->end(); }
+    void seekToFirst() override { it = table->begin(); }
+    void seekToLast() override { it = table->empty() ? table->end() : std::prev(table->end()); }
+    void seek(std::string_view target) override { it = table->lower_bound(target); }
+    void next() override { ++it; }
+    void prev() override { it = it == table->begin() ? table->end() : std::prev(it); }
+    std::string_view key() const override { return it->first; }
+    bool deleted() const override { return !it->second.has_value(); }
+    std::string_view value() const override { return it->second ? std::string_view(*it->second) : std::string_view(); }
+};
+
+class TableIterator : public InternalIterator {
+    SSTable::Iterator it;
+
+public:
+    explicit TableIterator(std::shared_ptr<const SSTable> table) : it(std::move(table)) {}
+
+    bool valid() const override { return it.valid(); }
+    void seekToFirst() override { it.seekToFirst(); }
+    void seekToLast() override { it.seekToLast(); }
+    void seek(std::string_view target) override { it.seek(std::string(target)); }
+    void next() override { it.next(); }
+    void prev() override { it.prev(); }
+    std::string_view key() const override { return it.entry().key; }
+    bool deleted() const override { return !it.entry().value.has_value(); }
+    std::string_view value() const override {
+        return it.entry().value ? std::string_view(*it.entry().value) : std::string_view();
+    }
+    bool corrupted() const override { return it.corrupted(); }
+};
+
+class LevelIterator : public InternalIterator {
+    std::vector<std::shared_ptr<const SSTable>> tables;
+    size_t index = 0;
+    std::unique_ptr<SSTable::Iterator> it;
+    bool corrupt = false;
+
+    // A corrupt table ends the level instead of being stepped over
+    bool stopIfCorrupt() {
+        if (!it->corrupted()) return false;
+        corrupt = true;
+        it.reset();
+        return true;
+    }
+    void open(size_t i) {
+        index = i;
+        it = i < tables.size() ? std::make_unique<SSTable::Iterator>(tables[i]) : nullptr;
+    }
+    void skipEmptyForward() {
+        while (it && !it->valid()) {
+            if (stopIfCorrupt()) return;
+            open(index + 1);
+            if (it) it->seekToFirst();
+        }
+    }
+    void skipEmptyBackward() {
+        while (it && !it->valid()) {
+            if (stopIfCorrupt()) return;
+            if (index == 0) {
+                it.reset();
+                return;
+            }
+            open(index - 1);
+            it->seekToLast();
+        }
+    }
+
+public:
+    explicit LevelIterator(std::vector<std::shared_ptr<const SSTable>> t) : tables(std::move(t)) {}
+
+    bool valid() const override { return it && it->valid(); }
+    void seekToFirst() override {
+        open(0);
+        if (it) it->seekToFirst();
+        skipEmptyForward();
+    }
+    void seekToLast() override {
+        if (tables.empty()) {
+            it.reset();
+            return;
+        }
+        open(tables.size() - 1);
+        it->seekToLast();
+        skipEmptyBackward();
+    }
+    void seek(std::string_view target) override {
+        auto pos = std::lower_bound(tables.begin(), tables.end(), target,
+            [](const std::shared_ptr<const SSTable>& t, std::string_view k) { return t->largest() < k; });
+        open((size_t)(pos - tables.begin()));
+        if (it) it->seek(std::string(target));
+        skipEmptyForward();
+    }
+    void next() override {
+        it->next();
+        skipEmptyForward();
+    }
+    void prev() override {
+        it->prev();
+        skipEmptyBackward();
+    }
+    std::string_view key() const override { return it->entry().key; }
+    bool deleted() const override { return !it->entry().value.has_value(); }
+    std::string_view value() const override {
+        return it->entry().value ? std::string_view(*it->entry().value) : std::string_view();
+    }
+    bool corrupted() const override { return corrupt; }
+};
+
+// Moving forward, every child sits on its smallest key >= the current one; moving
+// backward, on its largest key <= it. Changing direction re-seeks the children.
+class MergingIterator : public InternalIterator {
+    std::vector<std::unique_ptr<InternalIterator>> children;
+    InternalIterator* current = nullptr;
+    bool forward = true;
+
+    void findSmallest() {
+        current = nullptr;
+        for (auto& child : children) {
+            if (child->valid() && (!current || child->key() < current->key())) current = child.get();
+        }
+    }
+    void findLargest() {
+        current = nullptr;
+        for (auto& child : children) {
+            if (child->valid() && (!current || child->key() > current->key())) current = child.get();
+        }
+    }
+
+public:
+    explicit MergingIterator(std::vector<std::unique_ptr<InternalIterator>> c) : children(std::move(c)) {}
+
+    bool valid() const override { return current != nullptr; }
+    void seekToFirst() override {
+        for (auto& child : children) child->seekToFirst();
+        forward = true;
+        findSmallest();
+    }
+    void seekToLast() override {
+        for (auto& child : children) child->seekToLast();
+        forward = false;
+        findLargest();
+    }
+    void seek(std::string_view target) override {
+        for (auto& child : children) child->seek(target);
+        forward = true;
+        findSmallest();
+    }
+    void next() override {
+        std::string k(current->key());
+        for (auto& child : children) {
+            if (!forward) child->seek(k);
+            if (child->valid() && child->key() == k) child->next();
+        }
+        forward = true;
+        findSmallest();
+    }
+    void prev() override {
+        std::string k(current->key());
+        for (auto& child : children) {
+            if (forward) {
+                child->seek(k);
+                if (child->valid()) {
+                    child->prev();
+                } else {
+                    child->seekToLast();
+                }
+            } else if (child->valid() && child->key() == k) {
+                child->prev();
+            }
+        }
+        forward = false;
+        findLargest();
+    }
+    std::string_view key() const override { return current->key(); }
+    bool deleted() const override { return current->deleted(); }
+    std::string_view value() const override { return current->value(); }
+    bool corrupted() const override {
+        for (const auto& child : children) {
+            if (child->corrupted()) return true;
+        }
+        return false;
+    }
+};
+
+}
+
+std::unique_ptr<InternalIterator> newMemTableIterator(std::shared_ptr<const MemTable> table) {
+    return std::make_unique<MemTableIterator>(std::move(table));
+}
+
+std::unique_ptr<InternalIterator> newTableIterator(std::shared_ptr<const SSTable> table) {
+    return std::make_unique<TableIterator>(std::move(table));
+}
+
+std::unique_ptr<InternalIterator> newLevelIterator(std::vector<std::shared_ptr<const SSTable>> tables) {
+    return std::make_unique<LevelIterator>(std::move(tables));
+}
+
+std::unique_ptr<InternalIterator> newMergingIterator(std::vector<std::unique_ptr<InternalIterator>> children) {
+    return std::make_unique<MergingIterator>(std::move(children));
+}
+
+}
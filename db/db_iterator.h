@@ -0,0 +1,46 @@
+#pragma once
+#include "sstable.h"
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace aegen {
+
+using MemTable = std::map<std::string, std::optional<std::string>, std::less<>>; // nullopt: tombstone
+
+/**
+ * InternalIterator - Ordered cursor over one source of entries
+ *
+ * Sources are a memtable, an SSTable, a level of SSTables, or a merge of
+ * those. Deletions are visible here (deleted() == true); RocksDBWrapper's
+ * public iterator hides them. key()/value() views stay valid until the
+ * cursor moves.
+ */
+class InternalIterator {
+public:
+    virtual ~InternalIterator() = default;
+    virtual bool valid() const = 0;
+    virtual void seekToFirst() = 0;
+    virtual void seekToLast() = 0;
+    virtual void seek(std::string_view target) = 0; // First key >= target
+    virtual void next() = 0;
+    virtual void prev() = 0;
+    virtual std::string_view key() const = 0;
+    virtual bool deleted() const = 0;
+    virtual std::string_view value() const = 0;
+    // A table block failed its checksum. The cursor skipped nothing: it stopped
+    // there, so whatever follows is missing from the view.
+    virtual bool corrupted() const { return false; }
+};
+
+std::unique_ptr<InternalIterator> newMemTableIterator(std::shared_ptr<const MemTable> table);
+std::unique_ptr<InternalIterator> newTableIterator(std::shared_ptr<const SSTable> table);
+// Non-overlapping tables sorted by key; only one is open at a time
+std::unique_ptr<InternalIterator> newLevelIterator(std::vector<std::shared_ptr<const SSTable>> tables);
+// On equal keys the earliest child wins, so pass children newest first
+std::unique_ptr<InternalIterator> newMergingIterator(std::vector<std::unique_ptr<InternalIterator>> children);
+
+}
@@ -0,0 +1,272 @@
+#include "receipt_store.h"
+#include "coding.h"
+#include "util/crypto.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace aegen {
+
+static constexpr const char* RECEIPTS_PREFIX = "receipts:";
+static constexpr const char* BLOOM_PREFIX = "bloom:";
+static constexpr const char* TX_PREFIX = "rtx:";
+// Version 1 records predate the cumulative gas field
+static constexpr uint8_t RECEIPTS_VERSION = 2;
+
+ReceiptStore::ReceiptStore(RocksDBWrapper& db) : db(db) {}
+
+std::string ReceiptStore::heightKey(const char* prefix, uint64_t height) {
+    std::string key = prefix;
+    for (int shift = 56; shift >= 0; shift -= 8) key.push_back((char)(height >> shift));
+    return key;
+}
+
+static std::string txKey(const Hash& hash) {
+    return std::string(TX_PREFIX) + std::string((const char*)hash.data(), hash.size());
+}
+
+// ---- Bloom ----
+
+// Three 11-bit positions from the hash of the item, as in Ethereum's logsBloom
+void ReceiptStore::addToBloom(LogsBloom& bloom, const uint8_t* data, size_t size) {
+    Hash h = crypto::sha256_bytes(data, size);
+    for (int i = 0; i < 3; ++i) {
+        uint32_t bit = ((h[2 * i] << 8) | h[2 * i + 1]) & 2047;
+        bloom[255 - bit / 8] |= (uint8_t)(1 << (bit % 8));
+    }
+}
+
+bool ReceiptStore::bloomMayContain(const LogsBloom& bloom, const uint8_t* data, size_t size) {
+    Hash h = crypto::sha256_bytes(data, size);
+    for (int i = 0; i < 3; ++i) {
+        uint32_t bit = ((h[2 * i] << 8) | h[2 * i + 1]) & 2047;
+        if (!(bloom[255 - bit / 8] & (1 << (bit % 8)))) return false;
+    }
+    return true;
+}
+
+LogsBloom ReceiptStore::bloomFor(const std::vector<TransactionReceipt>& receipts) {
+    LogsBloom bloom{};
+    for (const auto& receipt : receipts) {
+        for (const auto& log : receipt.logs) {
+            addToBloom(bloom, (const uint8_t*)log.address.data(), log.address.size());
+            for (const auto& topic : log.topics) addToBloom(bloom, topic.data(), topic.size());
+        }
+    }
+    return bloom;
+}
+
+// ---- Encoding ----
+
+static void putHash(std::string& dst, const Hash& h) {
+    dst.append((const char*)h.data(), h.size());
+}
+
+static bool getHash(const std::string& src, size_t& pos, Hash& h) {
+    if (src.size() - pos < h.size()) return false;
+    std::memcpy(h.data(), src.data() + pos, h.size());
+    pos += h.size();
+    return true;
+}
+
+static bool getFixed32(const std::string& src, size_t& pos, uint32_t& v) {
+    if (src.size() - pos < 4) return false;
+    v = coding::decodeFixed32(src.data() + pos);
+    pos += 4;
+    return true;
+}
+
+static bool getFixed64(const std::string& src, size_t& pos, uint64_t& v) {
+    if (src.size() - pos < 8) return false;
+    v = coding::decodeFixed64(src.data() + pos);
+    pos += 8;
+    return true;
+}
+
+std::string ReceiptStore::encodeReceipts(const std::vector<TransactionReceipt>& receipts) {
+    std::string out;
+    out.push_back((char)RECEIPTS_VERSION);
+    coding::putFixed32(out, (uint32_t)receipts.size());
+    for (const auto& r : receipts) {
+        putHash(out, r.transactionHash);
+        coding::putFixed64(out, r.transactionIndex);
+        putHash(out, r.blockHash);
+        coding::putFixed64(out, r.blockNumber);
+        coding::putBytes(out, r.from);
+        coding::putBytes(out, r.to);
+        coding::putFixed64(out, r.gasUsed);
+        coding::putFixed64(out, r.cumulativeGasUsed);
+        coding::putBytes(out, r.contractAddress);
+        out.push_back(r.status ? 1 : 0);
+        coding::putFixed32(out, (uint32_t)r.logs.size());
+        for (const auto& log : r.logs) {
+            coding::putBytes(out, log.address);
+            coding::putFixed32(out, (uint32_t)log.topics.size());
+            for (const auto& topic : log.topics) putHash(out, topic);
+            coding::putBytes(out, std::string(log.data.begin(), log.data.end()));
+        }
+    }
+    return out;
+}
+
+bool ReceiptStore::decodeReceipts(const std::string& data, std::vector<TransactionReceipt>& receipts) {
+    receipts.clear();
+    if (data.empty() || (uint8_t)data[0] == 0 || (uint8_t)data[0] > RECEIPTS_VERSION) return false;
+    const uint8_t version = (uint8_t)data[0];
+    size_t pos = 1;
+    uint32_t count;
+    uint64_t cumulative = 0;
+    if (!getFixed32(data, pos, count)) return false;
+    for (uint32_t i = 0; i < count; ++i) {
+        TransactionReceipt r;
+        uint32_t logCount;
+        if (!getHash(data, pos, r.transactionHash) || !getFixed64(data, pos, r.transactionIndex) ||
+            !getHash(data, pos, r.blockHash) || !getFixed64(data, pos, r.blockNumber) ||
+            !coding::getBytes(data, pos, data.size(), r.from) || !coding::getBytes(data, pos, data.size(), r.to) ||
+            !getFixed64(data, pos, r.gasUsed)) {
+            return false;
+        }
+        cumulative += r.gasUsed;
+        r.cumulativeGasUsed = cumulative;
+        if ((version >= 2 && !getFixed64(data, pos, r.cumulativeGasUsed)) ||
+            !coding::getBytes(data, pos, data.size(), r.contractAddress) || pos >= data.size()) {
+            return false;
+        }
+        r.status = data[pos++] != 0;
+        if (!getFixed32(data, pos, logCount)) return false;
+        for (uint32_t j = 0; j < logCount; ++j) {
+            Log log;
+            uint32_t topicCount;
+            std::string logData;
+            if (!coding::getBytes(data, pos, data.size(), log.address) || !getFixed32(data, pos, topicCount)) {
+                return false;
+            }
+            for (uint32_t t = 0; t < topicCount; ++t) {
+                Hash topic;
+                if (!getHash(data, pos, topic)) return false;
+                log.topics.push_back(topic);
+            }
+            if (!coding::getBytes(data, pos, data.size(), logData)) return false;
+            log.data.assign(logData.begin(), logData.end());
+            r.logs.push_back(std::move(log));
+        }
+        receipts.push_back(std::move(r));
+    }
+    return pos == data.size();
+}
+
+// ---- Store ----
+
+bool ReceiptStore::putBlockReceipts(uint64_t height, const std::vector<TransactionReceipt>& receipts) {
+    LogsBloom bloom = bloomFor(receipts);
+    std::vector<std::pair<std::string, std::string>> puts = {
+        {heightKey(RECEIPTS_PREFIX, height), encodeReceipts(receipts)},
+        {heightKey(BLOOM_PREFIX, height), std::string((const char*)bloom.data(), bloom.size())}};
+    for (size_t i = 0; i < receipts.size(); ++i) {
+        std::string location;
+        coding::putFixed64(location, height);
+        coding::putFixed32(location, (uint32_t)i);
+        puts.push_back({txKey(receipts[i].transactionHash), std::move(location)});
+    }
+    if (!db.writeBatch(puts, {}, WriteOptions{true})) {
+        std::cerr << "[ReceiptStore] Failed to persist receipts for block " << height << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ReceiptStore::getBlockReceipts(uint64_t height, std::vector<TransactionReceipt>& receipts) {
+    std::string data = db.get(heightKey(RECEIPTS_PREFIX, height));
+    if (data.empty()) return false;
+    if (!decodeReceipts(data, receipts)) {
+        std::cerr << "[ReceiptStore] Corrupt receipts for block " << height << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::optional<TransactionReceipt> ReceiptStore::getReceipt(const Hash& txHash) {
+    std::string location = db.get(txKey(txHash));
+    if (location.size() != 12) return std::nullopt;
+    uint64_t height = coding::decodeFixed64(location.data());
+    uint32_t index = coding::decodeFixed32(location.data() + 8);
+
+    std::vector<TransactionReceipt> receipts;
+    if (!getBlockReceipts(height, receipts) || index >= receipts.size()) return std::nullopt;
+    if (receipts[index].transactionHash != txHash) return std::nullopt;
+    return receipts[index];
+}
+
+bool ReceiptStore::getBloom(uint64_t height, LogsBloom& bloom) {
+    std::string data = db.get(heightKey(BLOOM_PREFIX, height));
+    if (data.size() != bloom.size()) return false;
+    std::memcpy(bloom.data(), data.data(), bloom.size());
+    return true;
+}
+
+bool ReceiptStore::matches(const Log& log, const LogFilter& filter) {
+    if (filter.address && log.address != *filter.address) return false;
+    if (filter.topics.size() > log.topics.size()) {
+        // Trailing wildcards do not require the topic to exist
+        for (size_t i = log.topics.size(); i < filter.topics.size(); ++i) {
+            if (filter.topics[i]) return false;
+        }
+    }
+    for (size_t i = 0; i < filter.topics.size() && i < log.topics.size(); ++i) {
+        if (filter.topics[i] && *filter.topics[i] != log.topics[i]) return false;
+    }
+    return true;
+}
+
+std::vector<ReceiptStore::LogEntry> ReceiptStore::getLogs(const LogFilter& filter) {
+    std::vector<LogEntry> result;
+    if (filter.fromBlock > filter.toBlock) return result;
+
+    ReadOptions range;
+    range.lowerBound = heightKey(BLOOM_PREFIX, filter.fromBlock);
+    range.upperBound = filter.toBlock == UINT64_MAX ? RocksDBWrapper::prefixUpperBound(BLOOM_PREFIX)
+                                                    : heightKey(BLOOM_PREFIX, filter.toBlock + 1);
+    const size_t prefixSize = std::strlen(BLOOM_PREFIX);
+
+    auto it = db.newIterator(range);
+    for (it->seekToFirst(); it->valid() && result.size() < MAX_LOGS; it->next()) {
+        std::string_view key = it->key();
+        std::string_view value = it->value();
+        if (key.size() != prefixSize + 8 || value.size() != sizeof(LogsBloom)) continue;
+        LogsBloom bloom;
+        std::memcpy(bloom.data(), value.data(), bloom.size());
+
+        // Blocks without logs, or missing any wanted address/topic, are skipped unread
+        if (std::all_of(bloom.begin(), bloom.end(), [](uint8_t b) { return b == 0; })) continue;
+        if (filter.address &&
+            !bloomMayContain(bloom, (const uint8_t*)filter.address->data(), filter.address->size())) {
+            continue;
+        }
+        bool possible = true;
+        for (const auto& topic : filter.topics) {
+            if (topic && !bloomMayContain(bloom, topic->data(), topic->size())) {
+                possible = false;
+                break;
+            }
+        }
+        if (!possible) continue;
+
+        uint64_t height = 0;
+        for (size_t i = prefixSize; i < key.size(); ++i) height = (height << 8) | (uint8_t)key[i];
+        std::vector<TransactionReceipt> receipts;
+        if (!getBlockReceipts(height, receipts)) continue;
+
+        uint64_t logIndex = 0;
+        for (size_t t = 0; t < receipts.size(); ++t) {
+            for (const auto& log : receipts[t].logs) {
+                if (matches(log, filter) && result.size() < MAX_LOGS) {
+                    result.push_back({log, height, receipts[t].blockHash, receipts[t].transactionHash, t, logIndex});
+                }
+                logIndex++;
+            }
+        }
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "rocksdb_wrapper.h"
+#include "core/receipt.h"
+#include <array>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace aegen {
+
+using LogsBloom = std::array<uint8_t, 256>; // 2048 bits
+
+/**
+ * ReceiptStore - Transaction receipts persisted per block
+ *
+ * Keys: "receipts:{height BE}" -> all receipts of the block, in order
+ *       "bloom:{height BE}"    -> 2048-bit bloom over the block's log addresses and topics
+ *       "rtx:{32-byte hash}"   -> height and index of a receipt
+ *
+ * Log queries walk the small bloom records of the range and decode the
+ * receipts only of blocks whose bloom matches the filter.
+ */
+class ReceiptStore {
+public:
+    // A log together with where it was emitted
+    struct LogEntry {
+        Log log;
+        uint64_t blockNumber = 0;
+        Hash blockHash{};
+        Hash transactionHash{};
+        uint64_t transactionIndex = 0;
+        uint64_t logIndex = 0; // Position within the block
+    };
+
+    // Topics match by position; an empty optional matches any topic
+    struct LogFilter {
+        uint64_t fromBlock = 0;
+        uint64_t toBlock = 0;
+        std::optional<Address> address;
+        std::vector<std::optional<Hash>> topics;
+    };
+
+    static constexpr size_t MAX_LOGS = 10000;
+
+    explicit ReceiptStore(RocksDBWrapper& db);
+
+    // Receipts of one block, in transaction order. Replaces any earlier set for the height.
+    // The write is synced; false if it failed, after which the database takes no writes.
+    bool putBlockReceipts(uint64_t height, const std::vector<TransactionReceipt>& receipts);
+    bool getBlockReceipts(uint64_t height, std::vector<TransactionReceipt>& receipts);
+    std::optional<TransactionReceipt> getReceipt(const Hash& txHash);
+    bool getBloom(uint64_t height, LogsBloom& bloom);
+
+    // At most MAX_LOGS entries, oldest first
+    std::vector<LogEntry> getLogs(const LogFilter& filter);
+
+    static void addToBloom(LogsBloom& bloom, const uint8_t* data, size_t size);
+    static bool bloomMayContain(const LogsBloom& bloom, const uint8_t* data, size_t size);
+    static LogsBloom bloomFor(const std::vector<TransactionReceipt>& receipts);
+
+    static std::string encodeReceipts(const std::vector<TransactionReceipt>& receipts);
+    static bool decodeReceipts(const std::string& data, std::vector<TransactionReceipt>& receipts);
+
+private:
+    RocksDBWrapper& db;
+
+    static std::string heightKey(const char* prefix, uint64_t height);
+    static bool matches(const Log& log, const LogFilter& filter);
+};
+
+}
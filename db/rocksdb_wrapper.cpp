@@ -1,7 +1,763 @@
-// RocksDBWrapper implementation is now header-only
-// See rocksdb_wrapper.h for the full implementation
 #include "rocksdb_wrapper.h"
+#include "coding.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+#include <functional>
+#include <cstdio>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace aegen {
-// All implementation is in the header file
+
+namespace fs = std::filesystem;
+
+static const char* MANIFEST_NAME = "MANIFEST";
+
+// Writes data to path through a temp file, so readers see the old or the new
+// contents but never a mix
+static bool replaceFileSync(const std::string& dir, const std::string& name, const std::string& data) {
+    std::string tmp = dir + "/" + name + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    const char* p = data.data();
+    size_t left = data.size();
+    bool ok = true;
+    while (left > 0) {
+        ssize_t n = ::write(fd, p, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ok = false;
+            break;
+        }
+        p += n;
+        left -= (size_t)n;
+    }
+    ok = ok && ::fsync(fd) == 0;
+    ::close(fd);
+    if (!ok || ::rename(tmp.c_str(), (dir + "/" + name).c_str()) != 0) return false;
+
+    int dirFd = ::open(dir.c_str(), O_RDONLY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+    return true;
+}
+
+static std::string readWholeFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return "";
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+// "000042.sst" -> 42; false for anything else
+static bool parseFileName(const std::string& name, const std::string& ext, uint64_t& number) {
+    if (name.size() <= ext.size() || name.compare(name.size() - ext.size(), ext.size(), ext) != 0) return false;
+    number = 0;
+    for (size_t i = 0; i < name.size() - ext.size(); ++i) {
+        if (name[i] < '0' || name[i] > '9') return false;
+        number = number * 10 + (uint64_t)(name[i] - '0');
+    }
+    return true;
+}
+
+RocksDBWrapper::RocksDBWrapper(const std::string& path, RocksDBOptions options)
+    : dir(path), options(options), mem(std::make_shared<MemTable>()), version(std::make_shared<Version>()) {
+    fs::create_directories(path);
+    recover();
+    background = std::thread([this]() { backgroundLoop(); });
+    walWriter = std::thread([this]() { walWriterLoop(); });
+}
+
+RocksDBWrapper::~RocksDBWrapper() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopWriter = true;
+        writeCv.notify_one();
+    }
+    walWriter.join();
+    {
+        // Flush what is left so the next open has no log to replay
+        std::unique_lock<std::mutex> lock(mtx);
+        makeRoomForWrite(lock, true);
+        shuttingDown = true;
+        bgCv.notify_one();
+    }
+    background.join();
+}
+
+std::string RocksDBWrapper::tablePath(uint64_t number) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%06llu.sst", (unsigned long long)number);
+    return dir + "/" + name;
+}
+
+std::string RocksDBWrapper::logPath(uint64_t number) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%06llu.log", (unsigned long long)number);
+    return dir + "/" + name;
+}
+
+// ---- Recovery ----
+
+// MANIFEST = CRC32C(4) | NEXT_FILE(8) | LOG_NUMBER(8) | COUNT(4) | COUNT x { LEVEL(1) | NUMBER(8) }
+void RocksDBWrapper::recover() {
+    auto v = std::make_shared<Version>();
+    MemTable recovered;
+
+    std::string manifestPath = dir + "/" + MANIFEST_NAME;
+    bool haveManifest = fs::exists(manifestPath);
+    if (haveManifest) {
+        std::string data = readWholeFile(manifestPath);
+        if (data.size() < 24 || coding::crc32c(data.data() + 4, data.size() - 4) != coding::decodeFixed32(data.data())) {
+            throw std::runtime_error("Corrupt MANIFEST in " + dir);
+        }
+        nextFileNumber = coding::decodeFixed64(data.data() + 4);
+        logNumber = coding::decodeFixed64(data.data() + 12);
+        uint32_t count = coding::decodeFixed32(data.data() + 20);
+        if (data.size() != 24 + (size_t)count * 9) {
+            throw std::runtime_error("Corrupt MANIFEST in " + dir);
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            const char* rec = data.data() + 24 + i * 9;
+            uint8_t level = (uint8_t)rec[0];
+            uint64_t number = coding::decodeFixed64(rec + 1);
+            auto table = SSTable::open(tablePath(number), number);
+            if (!table) throw std::runtime_error("Missing or corrupt table " + tablePath(number));
+            (level == 0 ? v->level0 : v->level1).push_back(table);
+        }
+        std::sort(v->level0.begin(), v->level0.end(),
+            [](const TablePtr& a, const TablePtr& b) { return a->number() > b->number(); });
+        std::sort(v->level1.begin(), v->level1.end(),
+            [](const TablePtr& a, const TablePtr& b) { return a->smallest() < b->smallest(); });
+    } else {
+        importLegacy(recovered);
+    }
+
+    // Replay the logs written since the last flush, oldest first
+    std::vector<uint64_t> logs;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        std::string name = entry.path().filename().string();
+        uint64_t number;
+        if (parseFileName(name, ".log", number)) {
+            if (number >= logNumber) logs.push_back(number);
+            if (number >= nextFileNumber) nextFileNumber = number + 1;
+        } else if (parseFileName(name, ".sst", number)) {
+            if (number >= nextFileNumber) nextFileNumber = number + 1;
+        }
+    }
+    std::sort(logs.begin(), logs.end());
+    for (uint64_t number : logs) {
+        auto stats = WriteAheadLog::replay(logPath(number), [&](const WriteAheadLog::Entry& e) {
+            if (e.op == WriteAheadLog::PUT) {
+                recovered[e.key] = e.value;
+            } else {
+                recovered[e.key] = std::nullopt;
+            }
+        });
+        if (stats.droppedBytes > 0) {
+            // A crash mid-append leaves a partial record. Nothing after it can be
+            // trusted; the log itself is deleted once its batches are in a table.
+            std::cerr << "[DB] " << logPath(number) << ": dropped " << stats.droppedBytes
+                      << " bytes of torn or corrupt tail after " << stats.batches << " batches" << std::endl;
+        }
+    }
+
+    walNumber = nextFileNumber++;
+    wal = std::make_unique<WriteAheadLog>(logPath(walNumber));
+    if (!wal->ok()) throw std::runtime_error("Cannot open WAL in " + dir);
+
+    // Turn whatever was recovered into a table right away, so every older log can go
+    if (!recovered.empty()) {
+        TablePtr table = writeTable(recovered);
+        if (!table) throw std::runtime_error("Cannot write table in " + dir);
+        v->level0.insert(v->level0.begin(), table);
+    }
+    version = v;
+    logNumber = walNumber;
+    if (!writeManifestLocked()) throw std::runtime_error("Cannot write MANIFEST in " + dir);
+
+    // Old logs, legacy files and tables orphaned by a crash mid-flush or mid-compaction
+    std::vector<uint64_t> live;
+    for (const auto& t : v->level0) live.push_back(t->number());
+    for (const auto& t : v->level1) live.push_back(t->number());
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        std::string name = entry.path().filename().string();
+        uint64_t number;
+        bool obsolete = (parseFileName(name, ".log", number) && number < logNumber) ||
+                        (parseFileName(name, ".sst", number) &&
+                         std::find(live.begin(), live.end(), number) == live.end()) ||
+                        name == "data.db" || name == "wal.log";
+        if (obsolete) {
+            std::error_code ec;
+            fs::remove(entry.path(), ec);
+        }
+    }
+}
+
+// Pre-LSM layout: data.db holds KEY_LEN|KEY|VALUE_LEN|VALUE\n records and
+// wal.log holds OP|KEY_LEN|KEY|VALUE_LEN|VALUE\n on top of it
+void RocksDBWrapper::importLegacy(MemTable& table) {
+    auto readField = [](const std::string& buf, size_t& pos, std::string& out) {
+        size_t bar = buf.find('|', pos);
+        if (bar == std::string::npos || bar == pos) return false;
+        size_t len = 0;
+        for (size_t i = pos; i < bar; ++i) {
+            if (buf[i] < '0' || buf[i] > '9') return false;
+            len = len * 10 + (buf[i] - '0');
+        }
+        if (bar + 1 + len > buf.size()) return false;
+        out.assign(buf, bar + 1, len);
+        pos = bar + 1 + len;
+        return true;
+    };
+
+    std::string data = readWholeFile(dir + "/data.db");
+    size_t pos = 0;
+    while (pos < data.size()) {
+        std::string key, value;
+        if (!readField(data, pos, key) || pos >= data.size() || data[pos] != '|') break;
+        ++pos;
+        if (!readField(data, pos, value)) break;
+        table[key] = value;
+        if (pos < data.size() && data[pos] == '\n') ++pos;
+    }
+
+    std::string log = readWholeFile(dir + "/wal.log");
+    pos = 0;
+    while (pos < log.size()) {
+        size_t opEnd = log.find('|', pos);
+        if (opEnd == std::string::npos) break;
+        std::string op = log.substr(pos, opEnd - pos);
+        pos = opEnd + 1;
+        std::string key, value;
+        if (!readField(log, pos, key) || pos >= log.size() || log[pos] != '|') break;
+        ++pos;
+        if (!readField(log, pos, value)) break;
+        if (op == "PUT") {
+            table[key] = value;
+        } else if (op == "DEL") {
+            table[key] = std::nullopt;
+        }
+        if (pos < log.size() && log[pos] == '\n') ++pos;
+    }
+}
+
+bool RocksDBWrapper::writeManifestLocked() {
+    std::string payload;
+    coding::putFixed64(payload, nextFileNumber);
+    coding::putFixed64(payload, logNumber);
+    coding::putFixed32(payload, (uint32_t)(version->level0.size() + version->level1.size()));
+    for (int level = 0; level < 2; ++level) {
+        for (const auto& t : level == 0 ? version->level0 : version->level1) {
+            payload.push_back((char)level);
+            coding::putFixed64(payload, t->number());
+        }
+    }
+    std::string data;
+    coding::putFixed32(data, coding::crc32c(payload));
+    data += payload;
+    if (!replaceFileSync(dir, MANIFEST_NAME, data)) {
+        std::cerr << "[DB] Failed to write MANIFEST in " << dir << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// ---- Writes ----
+
+void RocksDBWrapper::applyToMem(const std::string& key, std::optional<std::string> value) {
+    memBytes += key.size() + (value ? value->size() : 0) + 64; // Rough per-node overhead
+    (*mem)[key] = std::move(value);
+}
+
+void RocksDBWrapper::makeRoomForWrite(std::unique_lock<std::mutex>& lock, bool force) {
+    while (true) {
+        if (force ? mem->empty() : memBytes < options.memtableBytes) return;
+        if (walBusy || imm) {
+            // A group is mid-write to the current log, or the previous memtable is
+            // still flushing: stall rather than grow without bound
+            doneCv.wait(lock);
+            continue;
+        }
+        uint64_t number = nextFileNumber++;
+        auto next = std::make_unique<WriteAheadLog>(logPath(number));
+        if (!next->ok()) {
+            std::cerr << "[DB] Cannot open new WAL in " << dir << ", keeping the current memtable" << std::endl;
+            return;
+        }
+        // Async writes in the old log must not be lost behind later synced ones
+        wal->sync();
+        imm = mem;
+        immWalNumber = walNumber;
+        mem = std::make_shared<MemTable>();
+        memBytes = 0;
+        wal = std::move(next);
+        walNumber = number;
+        bgCv.notify_one();
+        return;
+    }
+}
+
+bool RocksDBWrapper::put(const std::string& key, const std::string& value) {
+    return writeBatch({{key, value}}, {});
+}
+
+bool RocksDBWrapper::del(const std::string& key) {
+    return writeBatch({}, {key});
+}
+
+bool RocksDBWrapper::writeBatch(const std::vector<std::pair<std::string, std::string>>& puts,
+                                const std::vector<std::string>& dels) {
+    return writeBatch(puts, dels, WriteOptions{options.syncWrites});
+}
+
+bool RocksDBWrapper::writeBatch(const std::vector<std::pair<std::string, std::string>>& puts,
+                                const std::vector<std::string>& dels, const WriteOptions& writeOptions) {
+    PendingWrite write{WriteAheadLog::encodeBatch(puts, dels), &puts, &dels, writeOptions.sync};
+
+    std::unique_lock<std::mutex> lock(mtx);
+    writeQueue.push_back(&write);
+    writeCv.notify_one();
+    writtenCv.wait(lock, [&write]() { return write.done; });
+    return write.ok;
+}
+
+// Group commit: take everything queued, write it to the log in one call with the
+// lock released, then apply it to the memtable in queue order
+void RocksDBWrapper::walWriterLoop() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        writeCv.wait(lock, [this]() { return !writeQueue.empty() || stopWriter; });
+        if (writeQueue.empty()) break; // Stopping, and every queued write is done
+
+        makeRoomForWrite(lock, false);
+
+        std::vector<PendingWrite*> group;
+        std::vector<const std::string*> payloads;
+        size_t bytes = 0;
+        bool sync = false;
+        while (!writeQueue.empty() && (group.empty() || bytes < options.maxGroupBytes)) {
+            PendingWrite* write = writeQueue.front();
+            writeQueue.pop_front();
+            group.push_back(write);
+            payloads.push_back(&write->payload);
+            bytes += write->payload.size();
+            sync = sync || write->sync;
+        }
+
+        // A failed write may have left part of a record behind, and replay stops
+        // at the first bad record, so nothing appended after it would survive a
+        // restart. Once the log fails, every later write fails too.
+        bool ok = !walFailed && !corrupted;
+        if (ok) {
+            walBusy = true;
+            WriteAheadLog* log = wal.get();
+            lock.unlock();
+            ok = log->append(payloads) && (!sync || log->sync());
+            lock.lock();
+            walBusy = false;
+            if (!ok) {
+                std::cerr << "[DB] WAL write failed in " << dir << ", refusing further writes" << std::endl;
+                walFailed = true;
+            }
+        }
+
+        // Nothing that missed the log is applied or acknowledged as written
+        for (PendingWrite* write : group) {
+            if (ok) {
+                for (const auto& [key, value] : *write->puts) {
+                    applyToMem(key, value);
+                }
+                for (const auto& key : *write->dels) {
+                    applyToMem(key, std::nullopt);
+                }
+            }
+            write->ok = ok;
+            write->done = true;
+        }
+        writtenCv.notify_all();
+        doneCv.notify_all();
+    }
+}
+
+// ---- Reads ----
+
+// nullopt: never written. Inner nullopt: deleted.
+std::optional<std::optional<std::string>> RocksDBWrapper::lookup(const std::string& key) {
+    std::shared_ptr<const Version> v;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = mem->find(key);
+        if (it != mem->end()) return it->second;
+        if (imm) {
+            it = imm->find(key);
+            if (it != imm->end()) return it->second;
+        }
+        v = version;
+    }
+
+    std::string value;
+    for (const auto& table : v->level0) {
+        switch (table->get(key, value)) {
+            case SSTable::Lookup::Found: return std::optional<std::string>(value);
+            case SSTable::Lookup::Deleted: return std::optional<std::string>();
+            case SSTable::Lookup::NotFound: break;
+            // Falling through to older tables would return a stale value
+            case SSTable::Lookup::Corrupt: reportCorruption(table->path());
+        }
+    }
+
+    auto it = std::lower_bound(v->level1.begin(), v->level1.end(), key,
+        [](const TablePtr& t, const std::string& k) { return t->largest() < k; });
+    if (it != v->level1.end()) {
+        switch ((*it)->get(key, value)) {
+            case SSTable::Lookup::Found: return std::optional<std::string>(value);
+            case SSTable::Lookup::Deleted: return std::optional<std::string>();
+            case SSTable::Lookup::NotFound: break;
+            case SSTable::Lookup::Corrupt: reportCorruption((*it)->path());
+        }
+    }
+    return std::nullopt;
+}
+
+void RocksDBWrapper::reportCorruption(const std::string& where) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        corrupted = true;
+    }
+    throw std::runtime_error("Corrupt table data in " + where);
+}
+
+bool RocksDBWrapper::isCorrupted() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return corrupted;
+}
+
+std::string RocksDBWrapper::get(const std::string& key) {
+    auto result = lookup(key);
+    return result && *result ? **result : "";
+}
+
+bool RocksDBWrapper::exists(const std::string& key) {
+    auto result = lookup(key);
+    return result && result->has_value();
+}
+
+namespace {
+
+// Public cursor: hides tombstones and clamps the merged view to the bounds.
+// Throws through onCorrupt rather than end early on a corrupt block.
+class DBIterator : public RocksDBWrapper::Iterator {
+    std::unique_ptr<InternalIterator> it;
+    ReadOptions bounds;
+    std::function<void()> onCorrupt;
+
+    bool belowUpper() const { return !bounds.upperBound || it->key() < *bounds.upperBound; }
+    bool aboveLower() const { return it->key() >= bounds.lowerBound; }
+    void skipForward() {
+        while (it->valid() && it->deleted() && belowUpper()) it->next();
+        if (it->corrupted()) onCorrupt();
+    }
+    void skipBackward() {
+        while (it->valid() && it->deleted() && aboveLower()) it->prev();
+        if (it->corrupted()) onCorrupt();
+    }
+
+public:
+    DBIterator(std::unique_ptr<InternalIterator> merged, ReadOptions bounds, std::function<void()> onCorrupt)
+        : it(std::move(merged)), bounds(std::move(bounds)), onCorrupt(std::move(onCorrupt)) {}
+
+    bool valid() const override {
+        return it->valid() && !it->deleted() && belowUpper() && aboveLower();
+    }
+    void seekToFirst() override {
+        it->seek(bounds.lowerBound);
+        skipForward();
+    }
+    void seekToLast() override {
+        if (bounds.upperBound) {
+            it->seek(*bounds.upperBound);
+            if (it->valid()) {
+                it->prev();
+            } else {
+                it->seekToLast();
+            }
+        } else {
+            it->seekToLast();
+        }
+        skipBackward();
+    }
+    void seek(std::string_view target) override {
+        it->seek(std::max(target, std::string_view(bounds.lowerBound)));
+        skipForward();
+    }
+    void next() override {
+        it->next();
+        skipForward();
+    }
+    void prev() override {
+        it->prev();
+        skipBackward();
+    }
+    std::string_view key() const override { return it->key(); }
+    std::string_view value() const override { return it->value(); }
+};
+
+}
+
+std::unique_ptr<RocksDBWrapper::Iterator> RocksDBWrapper::newIterator(const ReadOptions& readOptions) {
+    auto memView = std::make_shared<MemTable>();
+    std::shared_ptr<const MemTable> frozen;
+    std::shared_ptr<const Version> v;
+    {
+        // mem keeps changing, so copy the bounded range; imm and tables are immutable
+        std::lock_guard<std::mutex> lock(mtx);
+        auto end = readOptions.upperBound ? mem->lower_bound(*readOptions.upperBound) : mem->end();
+        for (auto it = mem->lower_bound(readOptions.lowerBound); it != end; ++it) {
+            memView->emplace_hint(memView->end(), *it);
+        }
+        frozen = imm;
+        v = version;
+    }
+
+    std::vector<std::unique_ptr<InternalIterator>> children;
+    children.push_back(newMemTableIterator(memView));
+    if (frozen) children.push_back(newMemTableIterator(frozen));
+    for (const auto& table : v->level0) {
+        children.push_back(newTableIterator(table));
+    }
+    children.push_back(newLevelIterator(v->level1));
+    return std::make_unique<DBIterator>(newMergingIterator(std::move(children)), readOptions,
+                                        [this]() { reportCorruption(dir); });
+}
+
+std::optional<std::string> RocksDBWrapper::prefixUpperBound(const std::string& prefix) {
+    std::string bound = prefix;
+    while (!bound.empty()) {
+        if ((uint8_t)bound.back() != 0xFF) {
+            bound.back() = (char)((uint8_t)bound.back() + 1);
+            return bound;
+        }
+        bound.pop_back();
+    }
+    return std::nullopt;
+}
+
+std::vector<std::pair<std::string, std::string>> RocksDBWrapper::prefixScan(const std::string& prefix) {
+    ReadOptions readOptions;
+    readOptions.lowerBound = prefix;
+    readOptions.upperBound = prefixUpperBound(prefix);
+
+    std::vector<std::pair<std::string, std::string>> results;
+    auto it = newIterator(readOptions);
+    for (it->seekToFirst(); it->valid(); it->next()) {
+        results.emplace_back(std::string(it->key()), std::string(it->value()));
+    }
+    return results;
+}
+
+std::vector<std::string> RocksDBWrapper::getAllKeys() {
+    std::vector<std::string> keys;
+    for (auto& [key, value] : prefixScan("")) {
+        keys.push_back(std::move(key));
+    }
+    return keys;
+}
+
+size_t RocksDBWrapper::size() {
+    return prefixScan("").size();
+}
+
+RocksDBWrapper::Stats RocksDBWrapper::getStats() {
+    Stats stats;
+    stats.keyCount = size();
+
+    std::lock_guard<std::mutex> lock(mtx);
+    stats.memoryBytes = memBytes;
+    stats.diskBytes = 0;
+    for (const auto& t : version->level0) stats.diskBytes += t->fileSize();
+    for (const auto& t : version->level1) stats.diskBytes += t->fileSize();
+    stats.pendingWrites = mem->size() + (imm ? imm->size() : 0);
+    return stats;
+}
+
+// ---- Background flush and compaction ----
+
+void RocksDBWrapper::forceCompact() {
+    std::unique_lock<std::mutex> lock(mtx);
+    makeRoomForWrite(lock, true);
+    compactAll = true;
+    bgCv.notify_one();
+    doneCv.wait(lock, [this]() { return !imm && !compactAll; });
+}
+
+bool RocksDBWrapper::needsCompaction() const {
+    if (compactionFailed || version->level0.empty()) return false;
+    return compactAll || version->level0.size() >= options.level0CompactionTrigger;
+}
+
+void RocksDBWrapper::backgroundLoop() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        if (imm) {
+            flushImmutable(lock);
+        } else if (needsCompaction()) {
+            compactLevel0(lock);
+        } else if (compactAll) {
+            compactAll = false;
+            doneCv.notify_all();
+        } else if (shuttingDown) {
+            break;
+        } else {
+            bgCv.wait(lock);
+        }
+    }
+}
+
+RocksDBWrapper::TablePtr RocksDBWrapper::writeTable(const MemTable& table) {
+    uint64_t number = nextFileNumber++;
+    std::string path = tablePath(number);
+    SSTableWriter writer(path, options.blockBytes);
+    for (const auto& [key, value] : table) {
+        writer.add(key, value);
+    }
+    TablePtr result = writer.finish() ? SSTable::open(path, number) : nullptr;
+    if (!result) {
+        std::error_code ec;
+        fs::remove(path, ec);
+    }
+    return result;
+}
+
+void RocksDBWrapper::flushImmutable(std::unique_lock<std::mutex>& lock) {
+    std::shared_ptr<MemTable> table = imm;
+    uint64_t tableLog = immWalNumber;
+
+    lock.unlock();
+    TablePtr written = writeTable(*table);
+    lock.lock();
+
+    if (!written) {
+        // Writers stall behind imm until a retry succeeds
+        std::cerr << "[DB] Memtable flush failed in " << dir << ", retrying" << std::endl;
+        bgCv.wait_for(lock, std::chrono::seconds(1));
+        return;
+    }
+
+    auto v = std::make_shared<Version>(*version);
+    v->level0.insert(v->level0.begin(), written);
+    version = v;
+    imm.reset();
+    logNumber = walNumber; // Everything older than mem's log is now in a table
+    if (writeManifestLocked()) {
+        std::error_code ec;
+        fs::remove(logPath(tableLog), ec);
+    }
+    doneCv.notify_all();
+}
+
+void RocksDBWrapper::compactLevel0(std::unique_lock<std::mutex>& lock) {
+    // Only this thread installs versions, so `base` stays current while unlocked
+    std::shared_ptr<const Version> base = version;
+
+    std::string lo = base->level0.front()->smallest();
+    std::string hi = base->level0.front()->largest();
+    for (const auto& t : base->level0) {
+        lo = std::min(lo, t->smallest());
+        hi = std::max(hi, t->largest());
+    }
+    std::vector<TablePtr> inputs = base->level0; // Newest first: earlier inputs win ties
+    std::vector<TablePtr> keptLevel1;
+    for (const auto& t : base->level1) {
+        if (t->largest() < lo || t->smallest() > hi) {
+            keptLevel1.push_back(t);
+        } else {
+            inputs.push_back(t);
+        }
+    }
+
+    lock.unlock();
+
+    std::vector<std::unique_ptr<InternalIterator>> children;
+    for (const auto& t : inputs) {
+        children.push_back(newTableIterator(t));
+    }
+    auto merged = newMergingIterator(std::move(children));
+
+    std::vector<TablePtr> outputs;
+    std::unique_ptr<SSTableWriter> writer;
+    uint64_t writerNumber = 0;
+    bool failed = false;
+    auto finishOutput = [&]() {
+        if (!writer) return;
+        TablePtr t = writer->finish() ? SSTable::open(tablePath(writerNumber), writerNumber) : nullptr;
+        writer.reset();
+        if (t) {
+            outputs.push_back(t);
+        } else {
+            failed = true;
+            std::error_code ec;
+            fs::remove(tablePath(writerNumber), ec);
+        }
+    };
+
+    for (merged->seekToFirst(); merged->valid() && !failed; merged->next()) {
+        // Level 1 is the bottom, so nothing older can hide behind a tombstone
+        if (merged->deleted()) continue;
+        if (!writer) {
+            writerNumber = nextFileNumber++;
+            writer = std::make_unique<SSTableWriter>(tablePath(writerNumber), options.blockBytes);
+        }
+        writer->add(std::string(merged->key()), std::string(merged->value()));
+        if (writer->fileSize() >= options.targetFileBytes) finishOutput();
+    }
+    finishOutput();
+    // The merge stopped at a corrupt block, so the outputs are missing its keys
+    // (and everything after it). Dropping the inputs would lose them for good.
+    bool corruptInput = merged->corrupted();
+
+    lock.lock();
+
+    if (failed || corruptInput) {
+        std::cerr << "[DB] Compaction failed in " << dir
+                  << (corruptInput ? ": corrupt input table, keeping every input" : "") << std::endl;
+        if (corruptInput) corrupted = true;
+        for (const auto& t : outputs) {
+            std::error_code ec;
+            fs::remove(t->path(), ec);
+        }
+        compactionFailed = true;
+        compactAll = false;
+        doneCv.notify_all();
+        return;
+    }
+
+    auto v = std::make_shared<Version>();
+    v->level1 = keptLevel1;
+    v->level1.insert(v->level1.end(), outputs.begin(), outputs.end());
+    std::sort(v->level1.begin(), v->level1.end(),
+        [](const TablePtr& a, const TablePtr& b) { return a->smallest() < b->smallest(); });
+    version = v;
+    if (writeManifestLocked()) deleteObsoleteFiles(inputs);
+
+    compactAll = false;
+    doneCv.notify_all();
+}
+
+void RocksDBWrapper::deleteObsoleteFiles(const std::vector<TablePtr>& dropped) {
+    // Readers still holding a table keep its descriptor open, so unlinking is safe
+    for (const auto& t : dropped) {
+        std::error_code ec;
+        fs::remove(t->path(), ec);
+    }
+}
+
 }
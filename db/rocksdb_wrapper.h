@@ -1,235 +1,191 @@
 #pragma once
+#include "sstable.h"
+#include "write_ahead_log.h"
+#include "db_iterator.h"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
+#include <memory>
+#include <optional>
 #include <mutex>
-#include <fstream>
-#include <sstream>
-#include <filesystem>
-#include <functional>
-#include <chrono>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <deque>
 
 namespace aegen {
 
+struct RocksDBOptions {
+    size_t memtableBytes = 4 << 20;      // Memtable is frozen and flushed past this size
+    size_t blockBytes = 4096;            // SSTable data block size
+    size_t targetFileBytes = 2 << 20;    // Compaction output is split into files of this size
+    size_t level0CompactionTrigger = 4;  // Level-0 files before they are merged into level 1
+    bool syncWrites = false;             // Durability of writes that do not pass WriteOptions
+    size_t maxGroupBytes = 1 << 20;      // Upper bound on one group-commit WAL write
+};
+
+struct WriteOptions {
+    // true: return only after the WAL is fdatasync'ed. false: once the OS has it.
+    bool sync = false;
+};
+
+struct ReadOptions {
+    std::string lowerBound;                // Inclusive; empty: unbounded
+    std::optional<std::string> upperBound; // Exclusive
+};
+
 /**
- * RocksDBWrapper - Production-ready key-value store
- * 
- * This implementation provides a robust file-based storage that mimics RocksDB's API.
- * For production, replace with actual RocksDB library:
- *   #include <rocksdb/db.h>
- *   
- * Features:
- * - Persistent storage with WAL (Write-Ahead Log)
- * - Batch operations
- * - Prefix iteration
- * - Compaction
- * - Thread-safe operations
+ * RocksDBWrapper - Log-structured key-value store with a RocksDB-like API
+ *
+ * Writes go to a binary write-ahead log and a sorted memtable. A full memtable
+ * is frozen and a background thread writes it out as a level-0 SSTable; once
+ * enough level-0 tables pile up they are merged into level 1, a single sorted
+ * run of non-overlapping tables. Deletes are tombstones until they reach
+ * level 1. The live table set and the oldest WAL still needed are recorded in
+ * MANIFEST, which is replaced atomically.
+ *
+ * Memory is bounded by two memtables plus each table's index and bloom filter,
+ * so datasets larger than RAM work. Directories written by the old single-file
+ * format (data.db + wal.log) are imported on first open.
+ *
+ * Thread-safe. Writers queue their batch and a dedicated WAL thread commits
+ * everything queued in one write (plus one fdatasync if any writer asked for
+ * sync), so concurrent writers share the I/O instead of serializing on it.
+ * Readers only hold the lock while probing the memtables; SSTable reads happen
+ * outside it against a reference-counted table set.
  */
 class RocksDBWrapper {
-private:
-    std::string dbPath;
-    std::string walPath;
-    std::map<std::string, std::string> memtable;
-    std::mutex mtx;
-    size_t writeCount = 0;
-    static constexpr size_t COMPACT_THRESHOLD = 1000;
-
-    // Write-Ahead Log entry
-    void appendWAL(const std::string& op, const std::string& key, const std::string& value) {
-        std::ofstream wal(walPath, std::ios::app);
-        if (wal) {
-            // Format: OP|KEY_LEN|KEY|VALUE_LEN|VALUE\n
-            wal << op << "|" << key.length() << "|" << key << "|" << value.length() << "|" << value << "\n";
-            wal.flush();
-        }
-    }
-
-    void loadFromDisk() {
-        // Load main data file
-        std::ifstream dataFile(dbPath);
-        if (dataFile) {
-            std::string line;
-            while (std::getline(dataFile, line)) {
-                if (line.empty()) continue;
-                size_t pos = line.find('|');
-                if (pos != std::string::npos) {
-                    std::string keyLen = line.substr(0, pos);
-                    size_t kLen = std::stoull(keyLen);
-                    std::string rest = line.substr(pos + 1);
-                    std::string key = rest.substr(0, kLen);
-                    size_t valPos = kLen + 1;
-                    size_t valLenEnd = rest.find('|', valPos);
-                    size_t vLen = std::stoull(rest.substr(valPos, valLenEnd - valPos));
-                    std::string value = rest.substr(valLenEnd + 1, vLen);
-                    memtable[key] = value;
-                }
-            }
-        }
-
-        // Replay WAL
-        std::ifstream wal(walPath);
-        if (wal) {
-            std::string line;
-            while (std::getline(wal, line)) {
-                if (line.empty()) continue;
-                size_t p1 = line.find('|');
-                std::string op = line.substr(0, p1);
-                size_t p2 = line.find('|', p1 + 1);
-                size_t keyLen = std::stoull(line.substr(p1 + 1, p2 - p1 - 1));
-                std::string key = line.substr(p2 + 1, keyLen);
-                if (op == "PUT") {
-                    size_t p3 = p2 + 1 + keyLen + 1;
-                    size_t p4 = line.find('|', p3);
-                    size_t valLen = std::stoull(line.substr(p3, p4 - p3));
-                    std::string value = line.substr(p4 + 1, valLen);
-                    memtable[key] = value;
-                } else if (op == "DEL") {
-                    memtable.erase(key);
-                }
-            }
-        }
-    }
-
-    void compact() {
-        std::lock_guard<std::mutex> lock(mtx);
-        
-        // Write memtable to main data file
-        std::ofstream dataFile(dbPath, std::ios::trunc);
-        for (const auto& [key, value] : memtable) {
-            dataFile << key.length() << "|" << key << "|" << value.length() << "|" << value << "\n";
-        }
-        dataFile.close();
-
-        // Clear WAL
-        std::ofstream wal(walPath, std::ios::trunc);
-        wal.close();
-
-        writeCount = 0;
-    }
-
 public:
-    RocksDBWrapper(const std::string& path) : dbPath(path + "/data.db"), walPath(path + "/wal.log") {
-        // Create directory if it doesn't exist
-        std::filesystem::create_directories(path);
-        loadFromDisk();
-    }
-
-    ~RocksDBWrapper() {
-        compact();
-    }
-
-    void put(const std::string& key, const std::string& value) {
-        std::lock_guard<std::mutex> lock(mtx);
-        memtable[key] = value;
-        appendWAL("PUT", key, value);
-        
-        if (++writeCount >= COMPACT_THRESHOLD) {
-            compact();
-        }
-    }
-
-    std::string get(const std::string& key) {
-        std::lock_guard<std::mutex> lock(mtx);
-        auto it = memtable.find(key);
-        if (it != memtable.end()) {
-            return it->second;
-        }
-        return "";
-    }
-
-    bool exists(const std::string& key) {
-        std::lock_guard<std::mutex> lock(mtx);
-        return memtable.find(key) != memtable.end();
-    }
-
-    void del(const std::string& key) {
-        std::lock_guard<std::mutex> lock(mtx);
-        memtable.erase(key);
-        appendWAL("DEL", key, "");
-    }
+    RocksDBWrapper(const std::string& path, RocksDBOptions options = RocksDBOptions());
+    ~RocksDBWrapper();
+    RocksDBWrapper(const RocksDBWrapper&) = delete;
+    RocksDBWrapper& operator=(const RocksDBWrapper&) = delete;
+
+    // Writes return false when the batch did not reach the log (and so was not
+    // applied). After a failed log write or a corruption every write fails.
+    bool put(const std::string& key, const std::string& value);
+    // Empty string if absent. A table block failing its checksum throws
+    // std::runtime_error (and marks the database corrupted) rather than let an
+    // older table answer.
+    std::string get(const std::string& key);
+    bool exists(const std::string& key);
+    bool del(const std::string& key);
 
     // Batch operations for atomic writes
-    void writeBatch(const std::vector<std::pair<std::string, std::string>>& puts, 
-                   const std::vector<std::string>& dels) {
-        std::lock_guard<std::mutex> lock(mtx);
-        
-        for (const auto& [key, value] : puts) {
-            memtable[key] = value;
-            appendWAL("PUT", key, value);
-        }
-        
-        for (const auto& key : dels) {
-            memtable.erase(key);
-            appendWAL("DEL", key, "");
-        }
-        
-        writeCount += puts.size() + dels.size();
-        if (writeCount >= COMPACT_THRESHOLD) {
-            compact();
-        }
-    }
-
-    // Prefix scan for range queries
-    std::vector<std::pair<std::string, std::string>> prefixScan(const std::string& prefix) {
-        std::lock_guard<std::mutex> lock(mtx);
-        std::vector<std::pair<std::string, std::string>> results;
-        
-        for (const auto& [key, value] : memtable) {
-            if (key.substr(0, prefix.length()) == prefix) {
-                results.push_back({key, value});
-            }
-        }
-        
-        return results;
-    }
+    bool writeBatch(const std::vector<std::pair<std::string, std::string>>& puts,
+                    const std::vector<std::string>& dels);
+    bool writeBatch(const std::vector<std::pair<std::string, std::string>>& puts,
+                    const std::vector<std::string>& dels, const WriteOptions& writeOptions);
+
+    // Ordered cursor over live keys. It reads a consistent view taken at creation
+    // (later writes are invisible) and never blocks writers. key()/value() views
+    // are valid until the cursor moves. Moves onto a corrupt block throw like get().
+    class Iterator {
+    public:
+        virtual ~Iterator() = default;
+        virtual bool valid() const = 0;
+        virtual void seekToFirst() = 0;
+        virtual void seekToLast() = 0;
+        virtual void seek(std::string_view target) = 0; // First key >= target
+        virtual void next() = 0;
+        virtual void prev() = 0;
+        virtual std::string_view key() const = 0;
+        virtual std::string_view value() const = 0;
+    };
+    // Bounds limit the memtable entries copied into the view, so set them when you can
+    std::unique_ptr<Iterator> newIterator(const ReadOptions& readOptions = ReadOptions());
+
+    // Prefix scan for range queries, in key order
+    std::vector<std::pair<std::string, std::string>> prefixScan(const std::string& prefix);
+    // Smallest string greater than every key starting with prefix; nullopt if none exists
+    static std::optional<std::string> prefixUpperBound(const std::string& prefix);
 
     // Get all keys (for debugging)
-    std::vector<std::string> getAllKeys() {
-        std::lock_guard<std::mutex> lock(mtx);
-        std::vector<std::string> keys;
-        for (const auto& [key, value] : memtable) {
-            keys.push_back(key);
-        }
-        return keys;
-    }
-
-    // Get database size
-    size_t size() {
-        std::lock_guard<std::mutex> lock(mtx);
-        return memtable.size();
-    }
-
-    // Force compaction
-    void forceCompact() {
-        compact();
-    }
-
-    // Get statistics
+    std::vector<std::string> getAllKeys();
+    size_t size();
+
+    // Flush the memtable and merge every table into level 1
+    void forceCompact();
+
+    // A read or compaction found a corrupt table block. Compaction has stopped
+    // and kept its inputs, and writes are refused; the files need repair or restore.
+    bool isCorrupted();
+
     struct Stats {
         size_t keyCount;
         size_t memoryBytes;
         size_t diskBytes;
         size_t pendingWrites;
     };
+    Stats getStats();
+
+private:
+    using TablePtr = std::shared_ptr<const SSTable>;
+
+    // A caller's batch waiting in the group-commit queue
+    struct PendingWrite {
+        std::string payload;
+        const std::vector<std::pair<std::string, std::string>>* puts;
+        const std::vector<std::string>* dels;
+        bool sync;
+        bool done = false;
+        bool ok = false;
+    };
+
+    // Immutable table set; swapped wholesale so readers can keep an old one alive
+    struct Version {
+        std::vector<TablePtr> level0; // Newest first, may overlap
+        std::vector<TablePtr> level1; // Sorted by key, disjoint
+    };
 
-    Stats getStats() {
-        std::lock_guard<std::mutex> lock(mtx);
-        Stats stats;
-        stats.keyCount = memtable.size();
-        stats.memoryBytes = 0;
-        for (const auto& [key, value] : memtable) {
-            stats.memoryBytes += key.size() + value.size();
-        }
-        
-        try {
-            stats.diskBytes = std::filesystem::file_size(dbPath);
-        } catch (...) {
-            stats.diskBytes = 0;
-        }
-        
-        stats.pendingWrites = writeCount;
-        return stats;
-    }
+    std::string dir;
+    RocksDBOptions options;
+
+    std::mutex mtx;
+    std::condition_variable bgCv;   // Wakes the background thread
+    std::condition_variable doneCv; // Signals writers waiting on a flush or forceCompact
+    std::shared_ptr<MemTable> mem;
+    std::shared_ptr<MemTable> imm;  // Frozen memtable being flushed
+    size_t memBytes = 0;
+    std::unique_ptr<WriteAheadLog> wal;
+    uint64_t walNumber = 0;         // WAL backing mem
+    uint64_t immWalNumber = 0;      // WAL backing imm
+    uint64_t logNumber = 0;         // Oldest WAL still needed (persisted)
+    std::atomic<uint64_t> nextFileNumber{1};
+    std::shared_ptr<const Version> version;
+    bool compactAll = false;
+    bool compactionFailed = false;  // Stop retrying a failing merge; flushes continue
+    bool corrupted = false;         // A table block failed its checksum
+    bool shuttingDown = false;
+    std::thread background;
+
+    std::deque<PendingWrite*> writeQueue;
+    std::condition_variable writeCv;   // Wakes the WAL thread
+    std::condition_variable writtenCv; // Wakes callers whose batch has landed
+    bool walBusy = false;              // WAL thread is writing with the lock released
+    bool walFailed = false;            // A log write failed; the log may end in a torn record
+    bool stopWriter = false;
+    std::thread walWriter;
+
+    std::string tablePath(uint64_t number) const;
+    std::string logPath(uint64_t number) const;
+
+    void recover();
+    void importLegacy(MemTable& table);
+    void applyToMem(const std::string& key, std::optional<std::string> value);
+    void makeRoomForWrite(std::unique_lock<std::mutex>& lock, bool force);
+    std::optional<std::optional<std::string>> lookup(const std::string& key);
+    [[noreturn]] void reportCorruption(const std::string& where);
+
+    void walWriterLoop();
+    void backgroundLoop();
+    bool needsCompaction() const;
+    TablePtr writeTable(const MemTable& table);
+    void flushImmutable(std::unique_lock<std::mutex>& lock);
+    void compactLevel0(std::unique_lock<std::mutex>& lock);
+    bool writeManifestLocked();
+    void deleteObsoleteFiles(const std::vector<TablePtr>& dropped);
 };
 
 }
@@ -0,0 +1,307 @@
+#include "sstable.h"
+#include "coding.h"
+#include <algorithm>
+#include <iostream>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace aegen {
+
+static constexpr uint64_t TABLE_MAGIC = 0x41454745'4E535354ull; // "AEGENSST"
+static constexpr size_t FOOTER_SIZE = 48;
+static constexpr size_t BLOOM_BITS_PER_KEY = 10;
+static constexpr uint8_t BLOOM_PROBES = 7;    // ~ln(2) * bits per key
+static constexpr uint8_t FLAG_TOMBSTONE = 1;
+
+// ---- Writer ----
+
+SSTableWriter::SSTableWriter(const std::string& path, size_t blockBytes) : blockBytes(blockBytes) {
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    failed = fd < 0;
+}
+
+SSTableWriter::~SSTableWriter() {
+    if (fd >= 0) ::close(fd);
+}
+
+void SSTableWriter::writeChunk(const std::string& data) {
+    std::string chunk = data;
+    coding::putFixed32(chunk, coding::crc32c(data));
+    const char* p = chunk.data();
+    size_t left = chunk.size();
+    while (!failed && left > 0) {
+        ssize_t n = ::write(fd, p, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            failed = true;
+            break;
+        }
+        p += n;
+        left -= (size_t)n;
+    }
+    offset += chunk.size();
+}
+
+void SSTableWriter::flushBlock() {
+    if (block.empty()) return;
+    index.push_back({lastKey, offset, (uint32_t)block.size()});
+    writeChunk(block);
+    block.clear();
+}
+
+void SSTableWriter::add(const std::string& key, const std::optional<std::string>& value) {
+    if (entryCount == 0) smallest = key;
+    block.push_back(value ? 0 : FLAG_TOMBSTONE);
+    coding::putBytes(block, key);
+    coding::putBytes(block, value ? *value : std::string());
+    lastKey = key;
+    keyHashes.push_back(coding::hash64(key));
+    entryCount++;
+    if (block.size() >= blockBytes) flushBlock();
+}
+
+bool SSTableWriter::finish() {
+    flushBlock();
+
+    std::string indexData;
+    coding::putBytes(indexData, smallest);
+    coding::putFixed32(indexData, (uint32_t)index.size());
+    for (const auto& e : index) {
+        coding::putBytes(indexData, e.lastKey);
+        coding::putFixed64(indexData, e.offset);
+        coding::putFixed32(indexData, e.size);
+    }
+    uint64_t indexOffset = offset;
+    writeChunk(indexData);
+
+    size_t bits = std::max<size_t>(64, keyHashes.size() * BLOOM_BITS_PER_KEY);
+    bits = (bits + 7) / 8 * 8;
+    std::string bloomData(1 + bits / 8, '\0');
+    bloomData[0] = (char)BLOOM_PROBES;
+    for (uint64_t h : keyHashes) {
+        uint64_t delta = (h >> 17) | (h << 47);
+        for (uint8_t i = 0; i < BLOOM_PROBES; ++i) {
+            uint64_t bit = h % bits;
+            bloomData[1 + bit / 8] |= (char)(1 << (bit % 8));
+            h += delta;
+        }
+    }
+    uint64_t bloomOffset = offset;
+    writeChunk(bloomData);
+
+    std::string footer;
+    coding::putFixed64(footer, indexOffset);
+    coding::putFixed64(footer, indexData.size());
+    coding::putFixed64(footer, bloomOffset);
+    coding::putFixed64(footer, bloomData.size());
+    coding::putFixed64(footer, entryCount);
+    coding::putFixed64(footer, TABLE_MAGIC);
+    const char* p = footer.data();
+    size_t left = footer.size();
+    while (!failed && left > 0) {
+        ssize_t n = ::write(fd, p, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            failed = true;
+            break;
+        }
+        p += n;
+        left -= (size_t)n;
+    }
+
+    if (!failed && ::fsync(fd) != 0) failed = true;
+    return !failed;
+}
+
+// ---- Reader ----
+
+SSTable::~SSTable() {
+    if (fd >= 0) ::close(fd);
+}
+
+bool SSTable::readChunk(uint64_t off, uint64_t length, std::string& out) const {
+    out.resize(length + 4);
+    size_t done = 0;
+    while (done < out.size()) {
+        ssize_t n = ::pread(fd, &out[done], out.size() - done, (off_t)(off + done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += (size_t)n;
+    }
+    uint32_t crc = coding::decodeFixed32(out.data() + length);
+    out.resize(length);
+    return coding::crc32c(out) == crc;
+}
+
+std::shared_ptr<SSTable> SSTable::open(const std::string& path, uint64_t number) {
+    std::shared_ptr<SSTable> table(new SSTable());
+    table->filePath = path;
+    table->fileNumber = number;
+    table->fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (table->fd < 0) return nullptr;
+
+    off_t end = ::lseek(table->fd, 0, SEEK_END);
+    if (end < (off_t)FOOTER_SIZE) return nullptr;
+    table->size = (uint64_t)end;
+
+    std::string footer(FOOTER_SIZE, '\0');
+    if (::pread(table->fd, &footer[0], FOOTER_SIZE, end - (off_t)FOOTER_SIZE) != (ssize_t)FOOTER_SIZE) return nullptr;
+    const char* f = footer.data();
+    if (coding::decodeFixed64(f + 40) != TABLE_MAGIC) return nullptr;
+    uint64_t indexOffset = coding::decodeFixed64(f);
+    uint64_t indexSize = coding::decodeFixed64(f + 8);
+    uint64_t bloomOffset = coding::decodeFixed64(f + 16);
+    uint64_t bloomSize = coding::decodeFixed64(f + 24);
+    table->entryCount = coding::decodeFixed64(f + 32);
+    if (indexOffset + indexSize + 4 > table->size || bloomOffset + bloomSize + 4 > table->size) return nullptr;
+
+    std::string indexData;
+    if (!table->readChunk(indexOffset, indexSize, indexData)) return nullptr;
+    size_t pos = 0;
+    if (!coding::getBytes(indexData, pos, indexData.size(), table->smallestKey)) return nullptr;
+    if (pos + 4 > indexData.size()) return nullptr;
+    uint32_t count = coding::decodeFixed32(indexData.data() + pos);
+    pos += 4;
+    for (uint32_t i = 0; i < count; ++i) {
+        IndexEntry e;
+        if (!coding::getBytes(indexData, pos, indexData.size(), e.lastKey)) return nullptr;
+        if (pos + 12 > indexData.size()) return nullptr;
+        e.offset = coding::decodeFixed64(indexData.data() + pos);
+        e.size = coding::decodeFixed32(indexData.data() + pos + 8);
+        pos += 12;
+        table->index.push_back(std::move(e));
+    }
+    if (table->index.empty()) return nullptr;
+
+    std::string bloomData;
+    if (!table->readChunk(bloomOffset, bloomSize, bloomData) || bloomData.size() < 2) return nullptr;
+    table->probes = (uint8_t)bloomData[0];
+    table->bloom = bloomData.substr(1);
+    return table;
+}
+
+bool SSTable::mayContain(const std::string& key) const {
+    uint64_t bits = bloom.size() * 8;
+    uint64_t h = coding::hash64(key);
+    uint64_t delta = (h >> 17) | (h << 47);
+    for (uint8_t i = 0; i < probes; ++i) {
+        uint64_t bit = h % bits;
+        if (!(bloom[bit / 8] & (1 << (bit % 8)))) return false;
+        h += delta;
+    }
+    return true;
+}
+
+size_t SSTable::findBlock(const std::string& key) const {
+    auto it = std::lower_bound(index.begin(), index.end(), key,
+        [](const IndexEntry& e, const std::string& k) { return e.lastKey < k; });
+    return (size_t)(it - index.begin());
+}
+
+bool SSTable::readBlock(size_t i, std::vector<Entry>& out) const {
+    out.clear();
+    std::string data;
+    if (!readChunk(index[i].offset, index[i].size, data)) {
+        std::cerr << "[DB] Corrupt block " << i << " in " << filePath << std::endl;
+        return false;
+    }
+    size_t pos = 0;
+    while (pos < data.size()) {
+        uint8_t flags = (uint8_t)data[pos++];
+        Entry e;
+        std::string value;
+        if (!coding::getBytes(data, pos, data.size(), e.key) ||
+            !coding::getBytes(data, pos, data.size(), value)) {
+            std::cerr << "[DB] Malformed block " << i << " in " << filePath << std::endl;
+            out.clear();
+            return false;
+        }
+        if (!(flags & FLAG_TOMBSTONE)) e.value = std::move(value);
+        out.push_back(std::move(e));
+    }
+    return true;
+}
+
+SSTable::Lookup SSTable::get(const std::string& key, std::string& value) const {
+    if (key < smallestKey || key > largest() || !mayContain(key)) return Lookup::NotFound;
+    size_t b = findBlock(key);
+    if (b >= index.size()) return Lookup::NotFound;
+
+    std::vector<Entry> entries;
+    if (!readBlock(b, entries)) return Lookup::Corrupt;
+    auto it = std::lower_bound(entries.begin(), entries.end(), key,
+        [](const Entry& e, const std::string& k) { return e.key < k; });
+    if (it == entries.end() || it->key != key) return Lookup::NotFound;
+    if (!it->value) return Lookup::Deleted;
+    value = *it->value;
+    return Lookup::Found;
+}
+
+// ---- Iterator ----
+
+SSTable::Iterator::Iterator(std::shared_ptr<const SSTable> table) : table(std::move(table)) {}
+
+void SSTable::Iterator::loadBlock(size_t i) {
+    entries.clear();
+    pos = 0;
+    // A corrupt block ends the cursor; skipping it would hide its keys
+    for (blockIndex = i; blockIndex < table->index.size(); ++blockIndex) {
+        if (!table->readBlock(blockIndex, entries)) {
+            corrupt = true;
+            return;
+        }
+        if (!entries.empty()) return;
+    }
+}
+
+void SSTable::Iterator::seekToFirst() {
+    loadBlock(0);
+}
+
+void SSTable::Iterator::seekToLast() {
+    entries.clear();
+    pos = 0;
+    for (size_t i = table->index.size(); i-- > 0;) {
+        if (!table->readBlock(i, entries)) {
+            corrupt = true;
+            return;
+        }
+        if (!entries.empty()) {
+            blockIndex = i;
+            pos = entries.size() - 1;
+            return;
+        }
+    }
+}
+
+void SSTable::Iterator::seek(const std::string& target) {
+    loadBlock(table->findBlock(target));
+    while (valid() && entries[pos].key < target) next();
+}
+
+void SSTable::Iterator::next() {
+    if (++pos >= entries.size()) loadBlock(blockIndex + 1);
+}
+
+void SSTable::Iterator::prev() {
+    if (pos > 0) {
+        --pos;
+        return;
+    }
+    for (size_t i = blockIndex; i-- > 0;) {
+        if (!table->readBlock(i, entries)) {
+            corrupt = true;
+            return;
+        }
+        if (!entries.empty()) {
+            blockIndex = i;
+            pos = entries.size() - 1;
+            return;
+        }
+    }
+    entries.clear();
+    pos = 0;
+}
+
+}
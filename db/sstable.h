@@ -0,0 +1,128 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <cstdint>
+
+namespace aegen {
+
+/**
+ * SSTable - Immutable sorted run on disk
+ *
+ * Layout: data blocks, index, bloom filter, fixed 48-byte footer.
+ *   block entry = FLAGS(1) | KLEN(4) | KEY | VLEN(4) | VALUE   (FLAGS bit 0: tombstone)
+ *   index       = SMALLEST_KEY | COUNT(4) | COUNT x { LAST_KEY | OFFSET(8) | SIZE(4) }
+ *   bloom       = PROBES(1) | BITS
+ *   footer      = INDEX_OFF(8) | INDEX_SIZE(8) | BLOOM_OFF(8) | BLOOM_SIZE(8) | ENTRIES(8) | MAGIC(8)
+ * Blocks, index and bloom each carry a trailing CRC32C (not included in their size).
+ *
+ * The index and bloom filter stay in memory. Data blocks are read with pread on
+ * demand, so an open table costs O(blocks) memory however large the file is.
+ */
+class SSTableWriter {
+public:
+    SSTableWriter(const std::string& path, size_t blockBytes);
+    ~SSTableWriter();
+
+    // Keys must be added in strictly ascending order. nullopt marks a deletion.
+    void add(const std::string& key, const std::optional<std::string>& value);
+    // Writes index, bloom and footer and syncs the file
+    bool finish();
+
+    uint64_t fileSize() const { return offset + block.size(); }
+    uint64_t entries() const { return entryCount; }
+
+private:
+    struct IndexEntry {
+        std::string lastKey;
+        uint64_t offset;
+        uint32_t size;
+    };
+
+    int fd = -1;
+    bool failed = false;
+    size_t blockBytes;
+    uint64_t offset = 0;
+    uint64_t entryCount = 0;
+    std::string block;
+    std::string smallest;
+    std::string lastKey;
+    std::vector<IndexEntry> index;
+    std::vector<uint64_t> keyHashes;
+
+    void writeChunk(const std::string& data);
+    void flushBlock();
+};
+
+class SSTable {
+public:
+    enum class Lookup { NotFound, Found, Deleted, Corrupt };
+
+    struct Entry {
+        std::string key;
+        std::optional<std::string> value; // nullopt: tombstone
+    };
+
+    // nullptr if the file is missing or its footer, index or bloom is corrupt
+    static std::shared_ptr<SSTable> open(const std::string& path, uint64_t number);
+    ~SSTable();
+
+    Lookup get(const std::string& key, std::string& value) const;
+
+    uint64_t number() const { return fileNumber; }
+    uint64_t fileSize() const { return size; }
+    uint64_t entries() const { return entryCount; }
+    const std::string& smallest() const { return smallestKey; }
+    const std::string& largest() const { return index.back().lastKey; }
+    const std::string& path() const { return filePath; }
+
+    // Cursor over the table, loading one block at a time
+    class Iterator {
+    public:
+        explicit Iterator(std::shared_ptr<const SSTable> table);
+        void seekToFirst();
+        void seekToLast();
+        void seek(const std::string& target); // First entry with key >= target
+        bool valid() const { return pos < entries.size(); }
+        // A block failed its checksum; the cursor stopped there and is invalid
+        bool corrupted() const { return corrupt; }
+        void next();
+        void prev();
+        const Entry& entry() const { return entries[pos]; }
+
+    private:
+        std::shared_ptr<const SSTable> table;
+        size_t blockIndex = 0;
+        std::vector<Entry> entries;
+        size_t pos = 0;
+        bool corrupt = false;
+
+        void loadBlock(size_t i);
+    };
+
+private:
+    struct IndexEntry {
+        std::string lastKey;
+        uint64_t offset;
+        uint32_t size;
+    };
+
+    std::string filePath;
+    uint64_t fileNumber = 0;
+    int fd = -1;
+    uint64_t size = 0;
+    uint64_t entryCount = 0;
+    std::string smallestKey;
+    std::vector<IndexEntry> index;
+    std::string bloom;
+    uint8_t probes = 0;
+
+    SSTable() = default;
+    bool mayContain(const std::string& key) const;
+    size_t findBlock(const std::string& key) const; // First block whose lastKey >= key
+    bool readBlock(size_t i, std::vector<Entry>& out) const;
+    bool readChunk(uint64_t offset, uint64_t length, std::string& out) const;
+};
+
+}
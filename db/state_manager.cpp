@@ -1,86 +1,261 @@
 #include "state_manager.h"
+#include "coding.h"
 #include "util/crypto.h"
-#include <map>
+#include <iostream>
+#include <cstring>
 
 namespace aegen {
 
-// In-Memory cache replaced by member cache with mutex for thread safety
+// Height of the block whose state is committed, written in the commit batch
+static const std::string HEIGHT_KEY = "meta:stateHeight";
 
-StateManager::StateManager(RocksDBWrapper& db) : db(db) {}
+StateManager::StateManager(RocksDBWrapper& db, size_t cacheCapacity)
+    : db(db), tree(db), cache(cacheCapacity) {
+    if (tree.empty()) {
+        buildTreeFromAccounts();
+    }
+
+    auto version = std::make_shared<StateVersion>();
+    std::string height = db.get(HEIGHT_KEY);
+    if (!height.empty() && !coding::parseUint64(height, version->height)) {
+        std::cerr << "[DB] Corrupt " << HEIGHT_KEY << ", assuming 0" << std::endl;
+    }
+    version->stateRoot = tree.committedRoot();
+    head.store(version);
+    history.push_back(version);
+}
+
+// Databases written before the tree existed only hold "acct:" records
+void StateManager::buildTreeFromAccounts() {
+    const std::string prefix = "acct:";
+    bool any = false;
+    for (const auto& [key, value] : db.prefixScan(prefix)) {
+        AccountState state;
+        if (!AccountState::decode(value, state)) continue;
+        tree.update(hashAccountKey(key.substr(prefix.size())), hashAccountState(state));
+        any = true;
+    }
+    if (!any) return;
+
+    std::vector<std::pair<std::string, std::string>> puts;
+    tree.flush(puts);
+    db.writeBatch(puts, {});
+}
+
+Hash StateManager::hashAccountKey(const Address& addr) {
+    return crypto::sha256_bytes(std::vector<uint8_t>(addr.begin(), addr.end()));
+}
+
+Hash StateManager::hashAccountState(const AccountState& state) {
+    std::string encoded = state.encode();
+    return crypto::sha256_bytes(std::vector<uint8_t>(encoded.begin(), encoded.end()));
+}
 
 AccountState StateManager::getAccountState(const Address& addr) {
-    std::shared_lock<std::shared_mutex> lock(cacheMutex);
-    auto it = cache.find(addr);
-    if (it != cache.end()) {
+    // Held across the committed lookup too, so a concurrent commit() cannot
+    // interleave between reading RocksDB and filling the cache
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    auto it = dirty.find(addr);
+    if (it != dirty.end()) {
         return it->second;
     }
+    return loadCommitted(addr);
+}
+
+AccountState StateManager::loadCommitted(const Address& addr) {
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (AccountState* hit = cache.get(addr)) {
+            return *hit;
+        }
+    }
+
     // Return empty/default state if not found
-    return AccountState{0, 0};
+    AccountState state{0, 0};
+    std::string raw = db.get(accountKey(addr));
+    if (!raw.empty() && !AccountState::decode(raw, state)) {
+        state = AccountState{0, 0};
+    }
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cache.put(addr, state);
+    return state;
 }
 
 void StateManager::setAccountState(const Address& addr, const AccountState& state) {
-    std::unique_lock<std::shared_mutex> lock(cacheMutex);
-    cache[addr] = state;
+    std::unique_lock<std::shared_mutex> lock(stateMutex);
+    dirty[addr] = state;
+    treePending.insert(addr);
 }
 
-void StateManager::commit() {
-    // In a real impl, this would serialize state changes to batch writes in RocksDB
-    // For now, we keep it in memory
+void StateManager::applyPendingToTree() {
+    for (const auto& addr : treePending) {
+        tree.update(hashAccountKey(addr), hashAccountState(dirty[addr]));
+    }
+    treePending.clear();
+}
+
+bool StateManager::commit(uint64_t height) {
+    std::unique_lock<std::shared_mutex> lock(stateMutex);
+
+    auto version = std::make_shared<StateVersion>();
+    version->height = height;
+    auto successor = std::make_shared<StateVersion::Successor>();
+    successor->next = version;
+
+    std::vector<std::pair<std::string, std::string>> puts;
+    puts.reserve(dirty.size() + dirtyKeys.size() + 1);
+    for (const auto& [addr, state] : dirty) {
+        successor->prior[accountKey(addr)] = loadCommitted(addr).encode();
+        puts.push_back({accountKey(addr), state.encode()});
+    }
+    for (const auto& [key, value] : dirtyKeys) {
+        successor->prior[key] = db.get(key);
+        puts.push_back({key, value});
+    }
+    puts.push_back({HEIGHT_KEY, std::to_string(height)});
+    // Accounts and tree nodes land in the same batch so they never disagree
+    applyPendingToTree();
+    tree.flush(puts);
+    version->stateRoot = tree.committedRoot();
+
+    // Snapshots of the previous version must find the prior values before the
+    // new ones can be read from RocksDB
+    head.load()->successor.store(successor);
+    if (!db.writeBatch(puts, {}, WriteOptions{true})) {
+        // The database refuses writes from here on, so the block cannot be retried
+        std::cerr << "[StateManager] Failed to persist state of block " << height << std::endl;
+        head.load()->successor.store(nullptr);
+        return false;
+    }
+    head.store(version);
+    {
+        std::lock_guard<std::mutex> historyLock(historyMutex);
+        history.push_back(version);
+        if (history.size() > SNAPSHOT_HISTORY) history.pop_front();
+    }
+
+    {
+        std::lock_guard<std::mutex> cacheLock(cacheMutex);
+        for (const auto& [addr, state] : dirty) {
+            cache.put(addr, state);
+        }
+    }
+    dirty.clear();
+    dirtyKeys.clear();
+    return true;
 }
 
 void StateManager::rollback() {
-    std::unique_lock<std::shared_mutex> lock(cacheMutex);
-    cache.clear();
+    std::unique_lock<std::shared_mutex> lock(stateMutex);
+    dirty.clear();
+    dirtyKeys.clear();
+    treePending.clear();
+    tree.discard();
+}
+
+StateSnapshot StateManager::snapshot() const {
+    return StateSnapshot(db, head.load());
+}
+
+std::optional<StateSnapshot> StateManager::snapshotAt(uint64_t height) const {
+    std::lock_guard<std::mutex> lock(historyMutex);
+    for (auto it = history.rbegin(); it != history.rend(); ++it) {
+        if ((*it)->height == height) return StateSnapshot(db, *it);
+    }
+    return std::nullopt;
 }
 
 Hash StateManager::getRootHash() {
-    std::shared_lock<std::shared_mutex> lock(cacheMutex);
-    if (cache.empty()) return Hash{};
-    
-    // Compute Merkle root of all account states
-    std::vector<Hash> leaves;
-    for (const auto& [addr, state] : cache) {
-        // Hash each account: H(addr || nonce || balance)
-        std::string data = addr + std::to_string(state.nonce) + std::to_string(state.balance);
-        std::vector<uint8_t> bytes(data.begin(), data.end());
-        leaves.push_back(crypto::sha256_bytes(bytes));
-    }
-    
-    // Build Merkle tree
-    while (leaves.size() > 1) {
-        std::vector<Hash> nextLevel;
-        for (size_t i = 0; i < leaves.size(); i += 2) {
-            std::vector<uint8_t> combined;
-            combined.insert(combined.end(), leaves[i].begin(), leaves[i].end());
-            if (i + 1 < leaves.size()) {
-                combined.insert(combined.end(), leaves[i+1].begin(), leaves[i+1].end());
-            } else {
-                combined.insert(combined.end(), leaves[i].begin(), leaves[i].end()); // Duplicate if odd
-            }
-            nextLevel.push_back(crypto::sha256_bytes(combined));
-        }
-        leaves = nextLevel;
+    std::unique_lock<std::shared_mutex> lock(stateMutex);
+    applyPendingToTree();
+    return tree.root();
+}
+
+StateManager::AccountProof StateManager::getAccountProof(const Address& addr) {
+    std::unique_lock<std::shared_mutex> lock(stateMutex);
+    AccountProof result;
+    result.address = addr;
+    result.stateRoot = tree.committedRoot();
+
+    Hash key = hashAccountKey(addr);
+    result.proof = tree.prove(key);
+    result.exists = result.proof.hasLeaf && result.proof.leafKey == key;
+    if (result.exists) {
+        result.state = loadCommitted(addr);
     }
-    return leaves[0];
+    return result;
+}
+
+bool StateManager::verifyAccountProof(const AccountProof& proof) {
+    std::optional<Hash> valueHash;
+    if (proof.exists) valueHash = hashAccountState(proof.state);
+    return StateTree::verify(proof.stateRoot, hashAccountKey(proof.address), valueHash, proof.proof);
 }
 
-// Storage keys will be prefixed with "storage:" in RocksDB
 std::string StateManager::getContractStorage(const std::string& contractAddr, const std::string& key) {
-   std::string dbKey = "storage:" + contractAddr + ":" + key;
-   return db.get(dbKey);
+    return getDirtyOrCommitted(storageKey(contractAddr, key));
 }
 
 void StateManager::setContractStorage(const std::string& contractAddr, const std::string& key, const std::string& value) {
-   std::string dbKey = "storage:" + contractAddr + ":" + key;
-   db.put(dbKey, value);
+    std::unique_lock<std::shared_mutex> lock(stateMutex);
+    dirtyKeys[storageKey(contractAddr, key)] = value;
+}
+
+std::string StateManager::getDirtyOrCommitted(const std::string& key) {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    auto it = dirtyKeys.find(key);
+    if (it != dirtyKeys.end()) {
+        return it->second;
+    }
+    return db.get(key);
+}
+
+std::vector<std::pair<std::string, std::string>> StateManager::dumpContractStorage(const std::string& contractAddr,
+                                                                                  const std::string& startKey,
+                                                                                  size_t limit) {
+    std::string prefix = storageKey(contractAddr, "");
+    ReadOptions range;
+    range.lowerBound = prefix;
+    range.upperBound = RocksDBWrapper::prefixUpperBound(prefix);
+
+    std::vector<std::pair<std::string, std::string>> slots;
+    auto it = db.newIterator(range);
+    for (it->seek(prefix + startKey); it->valid() && slots.size() < limit; it->next()) {
+        slots.emplace_back(std::string(it->key().substr(prefix.size())), std::string(it->value()));
+    }
+    return slots;
 }
 
 std::string StateManager::getContractCode(const std::string& contractAddr) {
-    return db.get("code:" + contractAddr);
+    return getDirtyOrCommitted(codeKey(contractAddr));
 }
 
 void StateManager::setContractCode(const std::string& contractAddr, const std::string& code) {
-    db.put("code:" + contractAddr, code);
+    Hash hash = crypto::sha256_bytes(reinterpret_cast<const uint8_t*>(code.data()), code.size());
+    std::unique_lock<std::shared_mutex> lock(stateMutex);
+    dirtyKeys[codeKey(contractAddr)] = code;
+    dirtyKeys[codeHashKey(contractAddr)] = std::string(reinterpret_cast<const char*>(hash.data()), hash.size());
+}
+
+std::optional<Hash> StateManager::getContractCodeHash(const std::string& contractAddr) {
+    return decodeCodeHash(getDirtyOrCommitted(codeHashKey(contractAddr)));
+}
+
+uint64_t StateManager::getContractNonce(const std::string& contractAddr) {
+    return decodeNonce(getDirtyOrCommitted(nonceKey(contractAddr)));
+}
+
+void StateManager::setContractNonce(const std::string& contractAddr, uint64_t nonce) {
+    std::unique_lock<std::shared_mutex> lock(stateMutex);
+    dirtyKeys[nonceKey(contractAddr)] = std::to_string(nonce);
+}
+
+std::optional<Hash> StateManager::decodeCodeHash(const std::string& raw) {
+    if (raw.size() != sizeof(Hash)) return std::nullopt;
+    Hash hash;
+    std::memcpy(hash.data(), raw.data(), hash.size());
+    return hash;
 }
 
 }
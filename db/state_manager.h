@@ -2,18 +2,52 @@
 #include "rocksdb_wrapper.h"
 #include "core/types.h"
 #include "core/account.h"
+#include "state_tree.h"
+#include "state_snapshot.h"
+#include "util/lru_cache.h"
 #include <unordered_map>
+#include <unordered_set>
 #include <shared_mutex>
+#include <mutex>
+#include <deque>
+#include <optional>
+#include <vector>
+#include <cstdint>
 
 namespace aegen {
 
+/**
+ * StateManager - Account and contract state on top of RocksDB
+ *
+ * Accounts, contract storage and code written during a block live in dirty
+ * sets until commit(), which persists them in one batch under
+ * "acct:{address}", "storage:{contract}:{key}", "code:{contract}",
+ * "codehash:{contract}" and "nonce:{contract}".
+ * Committed accounts are served from a bounded LRU so a restart only needs
+ * to reopen the database.
+ *
+ * The state root comes from a sparse Merkle tree keyed by H(address); only the
+ * paths of accounts touched since the last root are rehashed.
+ *
+ * Readers that must not see a block half-applied (RPC) take a StateSnapshot
+ * of the last committed height instead of calling the getters here.
+ */
 class StateManager {
-    RocksDBWrapper& db;
-    std::unordered_map<Address, AccountState> cache;
-    mutable std::shared_mutex cacheMutex;
-
 public:
-    StateManager(RocksDBWrapper& db);
+    static constexpr size_t DEFAULT_CACHE_CAPACITY = 100000;
+    // Committed heights that snapshotAt() can still serve
+    static constexpr size_t SNAPSHOT_HISTORY = 16;
+
+    // Committed account state together with its path to the committed root
+    struct AccountProof {
+        Address address;
+        AccountState state{0, 0};
+        bool exists = false;
+        Hash stateRoot{};
+        StateTree::Proof proof;
+    };
+
+    StateManager(RocksDBWrapper& db, size_t cacheCapacity = DEFAULT_CACHE_CAPACITY);
     
     AccountState getAccountState(const Address& addr);
     void setAccountState(const Address& addr, const AccountState& state);
@@ -21,14 +55,73 @@ public:
     // Contract Storage Support
     std::string getContractStorage(const std::string& contractAddr, const std::string& key);
     void setContractStorage(const std::string& contractAddr, const std::string& key, const std::string& value);
+    // A contract's committed slots in key order, starting at startKey; one bounded range scan
+    std::vector<std::pair<std::string, std::string>> dumpContractStorage(const std::string& contractAddr,
+                                                                         const std::string& startKey = "",
+                                                                         size_t limit = SIZE_MAX);
 
     // Code Support
     std::string getContractCode(const std::string& contractAddr);
     void setContractCode(const std::string& contractAddr, const std::string& code);
+    // SHA-256 of the code, stored alongside it; nullopt for code set before hashes were kept
+    std::optional<Hash> getContractCodeHash(const std::string& contractAddr);
+    // Contracts created so far by a contract; CREATE derives addresses from it
+    uint64_t getContractNonce(const std::string& contractAddr);
+    void setContractNonce(const std::string& contractAddr, uint64_t nonce);
 
-    void commit();
+    // Persist the state changed since the last commit as the state of block `height`.
+    // The write is synced; false if it failed, after which the database takes no writes.
+    bool commit(uint64_t height);
+    // Discard the state changed since the last commit
     void rollback();
     Hash getRootHash();
+
+    // Last committed state; never blocks on a block being executed
+    StateSnapshot snapshot() const;
+    // Committed state of a recent block, if still retained
+    std::optional<StateSnapshot> snapshotAt(uint64_t height) const;
+
+    // Proofs cover committed state only, so they match the last block's root
+    AccountProof getAccountProof(const Address& addr);
+    static bool verifyAccountProof(const AccountProof& proof);
+
+    static std::string accountKey(const Address& addr) { return "acct:" + addr; }
+    static std::string storageKey(const std::string& contractAddr, const std::string& key) {
+        return "storage:" + contractAddr + ":" + key;
+    }
+    static std::string codeKey(const std::string& contractAddr) { return "code:" + contractAddr; }
+    static std::string codeHashKey(const std::string& contractAddr) { return "codehash:" + contractAddr; }
+    static std::string nonceKey(const std::string& contractAddr) { return "nonce:" + contractAddr; }
+    static std::optional<Hash> decodeCodeHash(const std::string& raw);
+    static uint64_t decodeNonce(const std::string& raw) { return raw.empty() ? 0 : std::stoull(raw); }
+
+private:
+    RocksDBWrapper& db;
+
+    // Uncommitted changes of the current block, plus the tree built over them.
+    // stateMutex guards dirty, dirtyKeys, treePending and tree.
+    std::unordered_map<Address, AccountState> dirty;
+    std::unordered_map<std::string, std::string> dirtyKeys; // Storage and code, by raw key
+    std::unordered_set<Address> treePending; // Dirty accounts not yet in the tree
+    StateTree tree;
+    mutable std::shared_mutex stateMutex;
+
+    // Hot committed accounts
+    LRUCache<Address, AccountState> cache;
+    std::mutex cacheMutex;
+
+    // Newest committed version; the history keeps recent ones reachable by height
+    std::atomic<std::shared_ptr<StateVersion>> head;
+    std::deque<std::shared_ptr<StateVersion>> history;
+    mutable std::mutex historyMutex;
+
+    static Hash hashAccountKey(const Address& addr);
+    static Hash hashAccountState(const AccountState& state);
+    AccountState loadCommitted(const Address& addr);
+    std::string getDirtyOrCommitted(const std::string& key);
+    // Callers hold stateMutex exclusively
+    void applyPendingToTree();
+    void buildTreeFromAccounts();
 };
 
 }
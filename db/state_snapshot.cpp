@@ -0,0 +1,44 @@
+#include "state_snapshot.h"
+#include "state_manager.h"
+
+namespace aegen {
+
+std::string StateSnapshot::read(const std::string& key) const {
+    // RocksDB first: if it already shows a later commit, that commit's prior
+    // values are visible below
+    std::string value = db->get(key);
+    for (const StateVersion* v = version.get();;) {
+        std::shared_ptr<const StateVersion::Successor> succ = v->successor.load();
+        if (!succ) return value;
+        auto it = succ->prior.find(key);
+        if (it != succ->prior.end()) return it->second;
+        v = succ->next.get();
+    }
+}
+
+AccountState StateSnapshot::getAccountState(const Address& addr) const {
+    AccountState state{0, 0};
+    std::string raw = read(StateManager::accountKey(addr));
+    if (!raw.empty() && !AccountState::decode(raw, state)) {
+        state = AccountState{0, 0};
+    }
+    return state;
+}
+
+std::string StateSnapshot::getContractStorage(const std::string& contractAddr, const std::string& key) const {
+    return read(StateManager::storageKey(contractAddr, key));
+}
+
+std::string StateSnapshot::getContractCode(const std::string& contractAddr) const {
+    return read(StateManager::codeKey(contractAddr));
+}
+
+std::optional<Hash> StateSnapshot::getContractCodeHash(const std::string& contractAddr) const {
+    return StateManager::decodeCodeHash(read(StateManager::codeHashKey(contractAddr)));
+}
+
+uint64_t StateSnapshot::getContractNonce(const std::string& contractAddr) const {
+    return StateManager::decodeNonce(read(StateManager::nonceKey(contractAddr)));
+}
+
+}
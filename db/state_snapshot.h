@@ -0,0 +1,56 @@
+#pragma once
+#include "rocksdb_wrapper.h"
+#include "core/types.h"
+#include "core/account.h"
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace aegen {
+
+// One committed block's worth of state. The commit that supersedes it publishes
+// the values it is about to overwrite, before its batch reaches RocksDB.
+struct StateVersion {
+    struct Successor {
+        std::unordered_map<std::string, std::string> prior; // Raw key -> value at this version ("" if absent)
+        std::shared_ptr<StateVersion> next;
+    };
+
+    uint64_t height = 0;
+    Hash stateRoot{};
+    std::atomic<std::shared_ptr<const Successor>> successor;
+};
+
+/**
+ * StateSnapshot - Read-only view of state as of one committed block
+ *
+ * Reads go to RocksDB, which holds the newest committed state, and are then
+ * corrected by walking the prior values of every later commit. A reader that
+ * observed a newer value also observes the prior values published ahead of
+ * it, so no StateManager lock is needed. Cheap to copy; a snapshot keeps its
+ * version (and the newer ones it walks through) alive.
+ */
+class StateSnapshot {
+public:
+    StateSnapshot(RocksDBWrapper& db, std::shared_ptr<const StateVersion> version)
+        : db(&db), version(std::move(version)) {}
+
+    uint64_t height() const { return version->height; }
+    const Hash& stateRoot() const { return version->stateRoot; }
+
+    AccountState getAccountState(const Address& addr) const;
+    std::string getContractStorage(const std::string& contractAddr, const std::string& key) const;
+    std::string getContractCode(const std::string& contractAddr) const;
+    std::optional<Hash> getContractCodeHash(const std::string& contractAddr) const;
+    uint64_t getContractNonce(const std::string& contractAddr) const;
+
+private:
+    RocksDBWrapper* db;
+    std::shared_ptr<const StateVersion> version;
+
+    std::string read(const std::string& key) const;
+};
+
+}
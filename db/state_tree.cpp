@@ -0,0 +1,233 @@
+#include "state_tree.h"
+#include "util/crypto.h"
+#include <algorithm>
+
+namespace aegen {
+
+static const std::string NODE_PREFIX = "smt:";
+
+StateTree::StateTree(RocksDBWrapper& db, size_t cacheCapacity) : db(db), cache(cacheCapacity) {}
+
+// Path = 2-byte depth + key with every bit at or below `depth` cleared
+std::string StateTree::pathKey(const Hash& key, int depth) {
+    std::string path(2 + key.size(), '\0');
+    path[0] = (char)(depth >> 8);
+    path[1] = (char)(depth & 0xFF);
+    int fullBytes = depth / 8;
+    for (int i = 0; i < fullBytes; ++i) {
+        path[2 + i] = (char)key[i];
+    }
+    if (depth % 8 != 0) {
+        uint8_t mask = (uint8_t)(0xFF << (8 - depth % 8));
+        path[2 + fullBytes] = (char)(key[fullBytes] & mask);
+    }
+    return path;
+}
+
+static int pathDepth(const std::string& path) {
+    return ((uint8_t)path[0] << 8) | (uint8_t)path[1];
+}
+
+static std::string childPath(const std::string& path, int bit) {
+    int depth = pathDepth(path);
+    std::string child = path;
+    child[0] = (char)((depth + 1) >> 8);
+    child[1] = (char)((depth + 1) & 0xFF);
+    if (bit) child[2 + depth / 8] |= (char)(0x80 >> (depth % 8));
+    return child;
+}
+
+int StateTree::bitAt(const Hash& key, int depth) {
+    return (key[depth / 8] >> (7 - depth % 8)) & 1;
+}
+
+Hash StateTree::leafHash(const Hash& key, const Hash& valueHash) {
+    crypto::SHA256 hasher;
+    uint8_t tag = 0x00;
+    hasher.update(&tag, 1);
+    hasher.update(key.data(), key.size());
+    hasher.update(valueHash.data(), valueHash.size());
+    return hasher.finalize();
+}
+
+Hash StateTree::internalHash(const Hash& left, const Hash& right) {
+    crypto::SHA256 hasher;
+    uint8_t tag = 0x01;
+    hasher.update(&tag, 1);
+    hasher.update(left.data(), left.size());
+    hasher.update(right.data(), right.size());
+    return hasher.finalize();
+}
+
+// Encoding: type(1) | hash(32) | leaf: key(32) valueHash(32) / internal: left(32) right(32)
+std::string StateTree::encodeNode(const Node& node) {
+    std::string out;
+    out.reserve(1 + 32 * 3);
+    out.push_back(node.leaf ? 0 : 1);
+    out.append((const char*)node.hash.data(), 32);
+    const Hash& a = node.leaf ? node.key : node.left;
+    const Hash& b = node.leaf ? node.valueHash : node.right;
+    out.append((const char*)a.data(), 32);
+    out.append((const char*)b.data(), 32);
+    return out;
+}
+
+bool StateTree::decodeNode(const std::string& data, Node& node) {
+    if (data.size() != 1 + 32 * 3) return false;
+    node.leaf = data[0] == 0;
+    std::copy(data.begin() + 1, data.begin() + 33, node.hash.begin());
+    Hash& a = node.leaf ? node.key : node.left;
+    Hash& b = node.leaf ? node.valueHash : node.right;
+    std::copy(data.begin() + 33, data.begin() + 65, a.begin());
+    std::copy(data.begin() + 65, data.begin() + 97, b.begin());
+    return true;
+}
+
+std::optional<StateTree::Node> StateTree::getNode(const std::string& path) {
+    auto it = overlay.find(path);
+    if (it != overlay.end()) return it->second;
+    return loadNode(path);
+}
+
+std::optional<StateTree::Node> StateTree::loadNode(const std::string& path) {
+    if (Node* hit = cache.get(path)) return *hit;
+
+    std::string raw = db.get(NODE_PREFIX + path);
+    Node node;
+    if (raw.empty() || !decodeNode(raw, node)) return std::nullopt;
+    cache.put(path, node);
+    return node;
+}
+
+void StateTree::putNode(const std::string& path, const Node& node) {
+    overlay[path] = node;
+}
+
+void StateTree::update(const Hash& key, const Hash& valueHash) {
+    Node leaf;
+    leaf.leaf = true;
+    leaf.key = key;
+    leaf.valueHash = valueHash;
+    leaf.hash = leafHash(key, valueHash);
+
+    int depth = 0;
+    while (true) {
+        std::string path = pathKey(key, depth);
+        auto node = getNode(path);
+
+        if (!node) {
+            putNode(path, leaf);
+            break;
+        }
+        if (!node->leaf) {
+            // Internal node on the way down: it will need a rehash
+            if (!overlay.count(path)) putNode(path, *node);
+            staleInternals.insert(path);
+            depth++;
+            continue;
+        }
+        if (node->key == key) {
+            putNode(path, leaf);
+            break;
+        }
+
+        // Another leaf owns this slot: push both down to where the keys diverge.
+        // A leaf's hash does not depend on its depth, so the old one moves as is.
+        int split = depth;
+        while (bitAt(node->key, split) == bitAt(key, split)) split++;
+        for (int d = depth; d <= split; ++d) {
+            std::string chain = pathKey(key, d);
+            putNode(chain, Node{});
+            staleInternals.insert(chain);
+        }
+        putNode(pathKey(node->key, split + 1), *node);
+        putNode(pathKey(key, split + 1), leaf);
+        break;
+    }
+}
+
+Hash StateTree::root() {
+    if (!staleInternals.empty()) {
+        // Deepest first, so every child hash is final before its parent reads it
+        std::vector<std::string> paths(staleInternals.begin(), staleInternals.end());
+        std::sort(paths.begin(), paths.end(), [](const std::string& a, const std::string& b) {
+            return pathDepth(a) > pathDepth(b);
+        });
+        for (const auto& path : paths) {
+            Node& node = overlay[path];
+            // Untouched children keep the hash already recorded in this node
+            auto left = overlay.find(childPath(path, 0));
+            if (left != overlay.end()) node.left = left->second.hash;
+            auto right = overlay.find(childPath(path, 1));
+            if (right != overlay.end()) node.right = right->second.hash;
+            node.hash = internalHash(node.left, node.right);
+        }
+        staleInternals.clear();
+    }
+
+    auto rootNode = getNode(pathKey(Hash{}, 0));
+    return rootNode ? rootNode->hash : Hash{};
+}
+
+bool StateTree::empty() {
+    return !getNode(pathKey(Hash{}, 0)).has_value();
+}
+
+Hash StateTree::committedRoot() {
+    auto rootNode = loadNode(pathKey(Hash{}, 0));
+    return rootNode ? rootNode->hash : Hash{};
+}
+
+StateTree::Proof StateTree::prove(const Hash& key) {
+    Proof proof;
+    for (int depth = 0;; ++depth) {
+        auto node = loadNode(pathKey(key, depth));
+        if (!node) break;
+        if (node->leaf) {
+            proof.hasLeaf = true;
+            proof.leafKey = node->key;
+            proof.leafValueHash = node->valueHash;
+            break;
+        }
+        proof.siblings.push_back(bitAt(key, depth) ? node->left : node->right);
+    }
+    return proof;
+}
+
+bool StateTree::verify(const Hash& root, const Hash& key, const std::optional<Hash>& valueHash, const Proof& proof) {
+    int depth = (int)proof.siblings.size();
+    if (depth > 256) return false;
+
+    if (valueHash) {
+        if (!proof.hasLeaf || proof.leafKey != key || proof.leafValueHash != *valueHash) return false;
+    } else if (proof.hasLeaf) {
+        // A different leaf only proves absence if it really sits on our path
+        if (proof.leafKey == key) return false;
+        for (int d = 0; d < depth; ++d) {
+            if (bitAt(proof.leafKey, d) != bitAt(key, d)) return false;
+        }
+    }
+
+    Hash current = proof.hasLeaf ? leafHash(proof.leafKey, proof.leafValueHash) : Hash{};
+    for (int d = depth - 1; d >= 0; --d) {
+        const Hash& sibling = proof.siblings[d];
+        current = bitAt(key, d) ? internalHash(sibling, current) : internalHash(current, sibling);
+    }
+    return current == root;
+}
+
+void StateTree::flush(std::vector<std::pair<std::string, std::string>>& puts) {
+    root();
+    for (const auto& [path, node] : overlay) {
+        puts.push_back({NODE_PREFIX + path, encodeNode(node)});
+        cache.put(path, node);
+    }
+    overlay.clear();
+}
+
+void StateTree::discard() {
+    overlay.clear();
+    staleInternals.clear();
+}
+
+}
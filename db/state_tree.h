@@ -0,0 +1,84 @@
+#pragma once
+#include "rocksdb_wrapper.h"
+#include "core/types.h"
+#include "util/lru_cache.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <optional>
+
+namespace aegen {
+
+/**
+ * StateTree - Compact sparse Merkle tree over hashed account keys
+ *
+ * Leaves sit at the shallowest depth where their 256-bit key is unique, so the
+ * shape (and root) depends only on the key set, never on insertion order.
+ *   leaf     = H(0x00 || key || valueHash)
+ *   internal = H(0x01 || left || right), empty child = 32 zero bytes
+ *
+ * Nodes are stored individually in RocksDB under "smt:{depth}{prefix}" and read
+ * on demand through an LRU, so opening a large state is O(1). Changes made since
+ * the last flush() live in an overlay; root() rehashes only the overlay's paths.
+ */
+class StateTree {
+public:
+    static constexpr size_t DEFAULT_CACHE_CAPACITY = 200000;
+
+    // Path from the root to where a key's lookup ends. If that slot holds a
+    // leaf it is included; when its key differs the proof shows absence.
+    struct Proof {
+        std::vector<Hash> siblings; // Root first
+        bool hasLeaf = false;
+        Hash leafKey{};
+        Hash leafValueHash{};
+    };
+
+    StateTree(RocksDBWrapper& db, size_t cacheCapacity = DEFAULT_CACHE_CAPACITY);
+
+    // Insert or overwrite a leaf. Hashing is deferred to root().
+    void update(const Hash& key, const Hash& valueHash);
+    Hash root();
+    bool empty();
+
+    // Root and proofs of the tree as of the last flush(), ignoring the overlay.
+    // O(depth) node reads, mostly LRU hits.
+    Hash committedRoot();
+    Proof prove(const Hash& key);
+    // Checks that `key` maps to `valueHash` (or is absent, if nullopt) under `root`
+    static bool verify(const Hash& root, const Hash& key, const std::optional<Hash>& valueHash, const Proof& proof);
+
+    // Append the overlay's node writes to a batch and make them the committed tree
+    void flush(std::vector<std::pair<std::string, std::string>>& puts);
+    // Drop every change made since the last flush()
+    void discard();
+
+private:
+    struct Node {
+        bool leaf = false;
+        Hash hash{};
+        Hash key{};       // Leaf only
+        Hash valueHash{}; // Leaf only
+        Hash left{};      // Internal only: child hashes
+        Hash right{};
+    };
+
+    RocksDBWrapper& db;
+    LRUCache<std::string, Node> cache;                // Committed nodes
+    std::unordered_map<std::string, Node> overlay;     // Uncommitted nodes
+    std::unordered_set<std::string> staleInternals;    // Overlay internals needing a rehash
+
+    static std::string pathKey(const Hash& key, int depth);
+    static int bitAt(const Hash& key, int depth);
+    static Hash leafHash(const Hash& key, const Hash& valueHash);
+    static Hash internalHash(const Hash& left, const Hash& right);
+    static std::string encodeNode(const Node& node);
+    static bool decodeNode(const std::string& data, Node& node);
+
+    std::optional<Node> getNode(const std::string& path);
+    std::optional<Node> loadNode(const std::string& path); // Committed only
+    void putNode(const std::string& path, const Node& node);
+};
+
+}
@@ -0,0 +1,112 @@
+#include "write_ahead_log.h"
+#include "coding.h"
+#include <fstream>
+#include <sstream>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace aegen {
+
+WriteAheadLog::WriteAheadLog(const std::string& path) : filePath(path) {
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    if (fd >= 0) ::close(fd);
+}
+
+std::string WriteAheadLog::encodeBatch(const std::vector<std::pair<std::string, std::string>>& puts,
+                                       const std::vector<std::string>& dels) {
+    std::string payload;
+    coding::putFixed32(payload, (uint32_t)(puts.size() + dels.size()));
+    for (const auto& [key, value] : puts) {
+        payload.push_back((char)PUT);
+        coding::putBytes(payload, key);
+        coding::putBytes(payload, value);
+    }
+    for (const auto& key : dels) {
+        payload.push_back((char)DEL);
+        coding::putBytes(payload, key);
+        coding::putBytes(payload, "");
+    }
+    return payload;
+}
+
+bool WriteAheadLog::append(const std::vector<const std::string*>& payloads) {
+    if (fd < 0) return false;
+
+    size_t total = 0;
+    for (const auto* payload : payloads) total += 8 + payload->size();
+    std::string buf;
+    buf.reserve(total);
+    for (const auto* payload : payloads) {
+        size_t start = buf.size();
+        coding::putFixed32(buf, 0); // CRC placeholder
+        coding::putFixed32(buf, (uint32_t)payload->size());
+        buf.append(*payload);
+        uint32_t crc = coding::crc32c(buf.data() + start + 4, buf.size() - start - 4);
+        for (int i = 0; i < 4; ++i) buf[start + i] = (char)(crc >> (8 * i));
+    }
+
+    const char* p = buf.data();
+    size_t left = buf.size();
+    while (left > 0) {
+        ssize_t n = ::write(fd, p, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        left -= (size_t)n;
+    }
+    return true;
+}
+
+bool WriteAheadLog::sync() {
+    return fd >= 0 && ::fdatasync(fd) == 0;
+}
+
+static bool decodeBatch(const std::string& buf, size_t pos, size_t end, std::vector<WriteAheadLog::Entry>& out) {
+    if (pos + 4 > end) return false;
+    uint32_t count = coding::decodeFixed32(buf.data() + pos);
+    pos += 4;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (pos >= end) return false;
+        WriteAheadLog::Entry entry;
+        entry.op = (WriteAheadLog::Op)(uint8_t)buf[pos++];
+        if (entry.op != WriteAheadLog::PUT && entry.op != WriteAheadLog::DEL) return false;
+        if (!coding::getBytes(buf, pos, end, entry.key)) return false;
+        if (!coding::getBytes(buf, pos, end, entry.value)) return false;
+        out.push_back(std::move(entry));
+    }
+    return pos == end;
+}
+
+WriteAheadLog::ReplayStats WriteAheadLog::replay(const std::string& path, const std::function<void(const Entry&)>& apply) {
+    ReplayStats stats;
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return stats;
+    std::stringstream ss;
+    ss << in.rdbuf();
+    std::string buf = ss.str();
+
+    size_t pos = 0;
+    while (pos + 8 <= buf.size()) {
+        uint32_t crc = coding::decodeFixed32(buf.data() + pos);
+        uint32_t len = coding::decodeFixed32(buf.data() + pos + 4);
+        if (len > buf.size() - pos - 8) break; // Torn tail
+        if (coding::crc32c(buf.data() + pos + 4, 4 + (size_t)len) != crc) break;
+
+        std::vector<Entry> entries;
+        if (!decodeBatch(buf, pos + 8, pos + 8 + len, entries)) break;
+        for (const auto& entry : entries) apply(entry);
+        stats.batches++;
+        pos += 8 + len;
+    }
+    stats.validBytes = pos;
+    stats.droppedBytes = buf.size() - pos;
+    return stats;
+}
+
+}
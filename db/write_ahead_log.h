@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+namespace aegen {
+
+/**
+ * WriteAheadLog - Append-only binary log backing the memtable
+ *
+ * Every writeBatch becomes one record, so a batch replays all-or-nothing:
+ *   CRC32C(4) | LEN(4) | PAYLOAD(LEN)
+ *   PAYLOAD = COUNT(4) then COUNT x { OP(1) | KLEN(4) | KEY | VLEN(4) | VALUE }
+ * The CRC covers LEN and PAYLOAD. The file stays open for the log's lifetime.
+ */
+class WriteAheadLog {
+public:
+    enum Op : uint8_t { PUT = 1, DEL = 2 };
+
+    struct Entry {
+        Op op;
+        std::string key;
+        std::string value;
+    };
+
+    explicit WriteAheadLog(const std::string& path);
+    ~WriteAheadLog();
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    bool ok() const { return fd >= 0; }
+    const std::string& path() const { return filePath; }
+
+    static std::string encodeBatch(const std::vector<std::pair<std::string, std::string>>& puts,
+                                   const std::vector<std::string>& dels);
+
+    // Frames the encoded batches and writes them with a single write(2).
+    // Reaches the OS, not necessarily the disk; see sync().
+    bool append(const std::vector<const std::string*>& payloads);
+    bool append(const std::string& payload) { return append(std::vector<const std::string*>{&payload}); }
+    bool sync(); // fdatasync
+
+    struct ReplayStats {
+        size_t batches = 0;
+        uint64_t validBytes = 0;   // Length of the intact prefix
+        uint64_t droppedBytes = 0; // Torn or corrupt tail after it
+    };
+
+    // Applies every intact batch in order and stops at the first torn or corrupt
+    // record; nothing after it is trusted.
+    static ReplayStats replay(const std::string& path, const std::function<void(const Entry&)>& apply);
+
+private:
+    std::string filePath;
+    int fd = -1;
+};
+
+}
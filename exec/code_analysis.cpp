@@ -0,0 +1,219 @@
+#include "code_analysis.h"
+#include "vm.h"
+#include <algorithm>
+#include <array>
+
+namespace aegen {
+
+using Handler = CodeAnalysis::Handler;
+
+namespace {
+
+// How an opcode decodes: its handler, stack effect and static gas
+struct OpInfo {
+    Handler handler = Handler::UNDEFINED;
+    uint8_t n = 0;
+    int stackIn = 0;
+    int stackOut = 0;
+    uint64_t gas = GAS_COST_BASE;
+};
+
+std::array<OpInfo, 256> buildOpTable() {
+    std::array<OpInfo, 256> table{};
+    for (size_t op = 0; op < table.size(); ++op) table[op].n = (uint8_t)op;
+
+    auto set = [&](OpCode op, Handler handler, int in, int out, uint64_t extraGas = 0) {
+        table[(uint8_t)op] = {handler, 0, in, out, GAS_COST_BASE + extraGas};
+    };
+    set(OpCode::STOP, Handler::STOP, 0, 0);
+    set(OpCode::ADD, Handler::ADD, 2, 1);
+    set(OpCode::MUL, Handler::MUL, 2, 1);
+    set(OpCode::SUB, Handler::SUB, 2, 1);
+    set(OpCode::DIV, Handler::DIV, 2, 1);
+    set(OpCode::MOD, Handler::MOD, 2, 1);
+    set(OpCode::AND, Handler::AND, 2, 1);
+    set(OpCode::OR, Handler::OR, 2, 1);
+    set(OpCode::XOR, Handler::XOR, 2, 1);
+    set(OpCode::NOT, Handler::NOT, 1, 1);
+    set(OpCode::LT, Handler::LT, 2, 1);
+    set(OpCode::EQ, Handler::EQ, 2, 1);
+    set(OpCode::ISZERO, Handler::ISZERO, 1, 1);
+    set(OpCode::POP, Handler::POP, 1, 0);
+    set(OpCode::MLOAD, Handler::MLOAD, 1, 1);
+    set(OpCode::MSTORE, Handler::MSTORE, 2, 0);
+    set(OpCode::MSTORE8, Handler::MSTORE8, 2, 0);
+    set(OpCode::SLOAD, Handler::SLOAD, 1, 1, GAS_COST_SLOAD);
+    set(OpCode::SSTORE, Handler::SSTORE, 2, 0, GAS_COST_SSTORE_SET);
+    set(OpCode::JUMP, Handler::JUMP, 1, 0);
+    set(OpCode::JUMPI, Handler::JUMPI, 2, 0);
+    set(OpCode::JUMPDEST, Handler::JUMPDEST, 0, 0, GAS_COST_JUMPDEST);
+    set(OpCode::ADDRESS, Handler::ADDRESS, 0, 1);
+    set(OpCode::CALLER, Handler::CALLER, 0, 1);
+    set(OpCode::CALLVALUE, Handler::CALLVALUE, 0, 1);
+    set(OpCode::CALLDATALOAD, Handler::CALLDATALOAD, 1, 1, 1);
+    set(OpCode::CALLDATASIZE, Handler::CALLDATASIZE, 0, 1);
+    set(OpCode::CALLDATACOPY, Handler::CALLDATACOPY, 3, 0, 1);
+    set(OpCode::CODESIZE, Handler::CODESIZE, 0, 1);
+    set(OpCode::CODECOPY, Handler::CODECOPY, 3, 0, 1);
+    set(OpCode::RETURNDATASIZE, Handler::RETURNDATASIZE, 0, 1);
+    set(OpCode::RETURNDATACOPY, Handler::RETURNDATACOPY, 3, 0, 1);
+    set(OpCode::GAS, Handler::GAS, 0, 1);
+    set(OpCode::CREATE, Handler::CREATE, 3, 1, GAS_COST_CREATE);
+    set(OpCode::CALL, Handler::CALL, 7, 1, GAS_COST_CALL);
+    set(OpCode::RETURN, Handler::RETURN, 2, 0);
+    set(OpCode::DELEGATECALL, Handler::DELEGATECALL, 6, 1, GAS_COST_CALL);
+    set(OpCode::CREATE2, Handler::CREATE2, 4, 1, GAS_COST_CREATE);
+    set(OpCode::STATICCALL, Handler::STATICCALL, 6, 1, GAS_COST_CALL);
+    set(OpCode::REVERT, Handler::REVERT, 2, 0);
+    set(OpCode::INVALID, Handler::INVALID, 0, 0);
+    for (int i = 0; i < 32; ++i) {
+        table[(uint8_t)OpCode::PUSH1 + i] = {Handler::PUSH, (uint8_t)(i + 1), 0, 1, GAS_COST_BASE};
+    }
+    for (int i = 0; i < 16; ++i) {
+        table[(uint8_t)OpCode::DUP1 + i] = {Handler::DUP, (uint8_t)(i + 1), i + 1, i + 2, GAS_COST_BASE};
+        table[(uint8_t)OpCode::SWAP1 + i] = {Handler::SWAP, (uint8_t)(i + 1), i + 2, i + 2, GAS_COST_BASE};
+    }
+    for (int i = 0; i <= 4; ++i) {
+        table[(uint8_t)OpCode::LOG0 + i] = {Handler::LOG, (uint8_t)i, i + 2, 0,
+                                            GAS_COST_BASE + GAS_COST_LOG + GAS_COST_LOG_TOPIC * i};
+    }
+    return table;
+}
+
+const std::array<OpInfo, 256>& opTable() {
+    static const std::array<OpInfo, 256> table = buildOpTable();
+    return table;
+}
+
+bool endsBlock(Handler handler) {
+    switch (handler) {
+        case Handler::STOP:
+        case Handler::JUMP:
+        case Handler::JUMPI:
+        case Handler::GAS:
+        case Handler::CREATE:
+        case Handler::CALL:
+        case Handler::RETURN:
+        case Handler::DELEGATECALL:
+        case Handler::CREATE2:
+        case Handler::STATICCALL:
+        case Handler::REVERT:
+        case Handler::INVALID:
+        case Handler::UNDEFINED:
+            return true;
+        default:
+            return false;
+    }
+}
+
+}
+
+const CodeAnalysis::BasicBlock& CodeAnalysis::blockAt(uint64_t offset) const {
+    auto it = std::lower_bound(blocks.begin(), blocks.end(), offset,
+                               [](const BasicBlock& block, uint64_t value) { return block.start < value; });
+    return *it;
+}
+
+CodeAnalysis CodeAnalysis::analyze(const uint8_t* code, size_t size) {
+    const auto& ops = opTable();
+    CodeAnalysis analysis;
+    analysis.codeSize = size;
+    analysis.code.assign(code, code + size);
+    analysis.jumpdests.assign((size + 63) / 64, 0);
+    analysis.instructions.reserve(size + 1);
+
+    BasicBlock current;
+    bool open = false;
+    int height = 0; // Relative to the height on entry to the current block
+    int required = 0;
+    int growth = 0;
+    auto close = [&](size_t end) {
+        current.end = (uint32_t)end;
+        current.stackRequired = (uint32_t)required;
+        current.stackGrowth = (uint32_t)growth;
+        analysis.blocks.push_back(current);
+        open = false;
+    };
+
+    for (size_t pc = 0; pc < size;) {
+        uint8_t op = code[pc];
+        const OpInfo& info = ops[op];
+        if (op == (uint8_t)OpCode::JUMPDEST) {
+            if (open) close(pc);
+            analysis.jumpdests[pc / 64] |= uint64_t(1) << (pc % 64);
+        }
+        if (!open) {
+            current = BasicBlock{(uint32_t)pc, 0, 0, (uint32_t)analysis.instructions.size()};
+            analysis.instructions.push_back({Handler::BEGIN_BLOCK, 0, (uint32_t)analysis.blocks.size()});
+            open = true;
+            height = required = growth = 0;
+        }
+
+        Instruction instruction{info.handler, info.n};
+        pc++;
+        if (info.handler == Handler::PUSH) {
+            // Code past the end reads as zeros
+            uint8_t bytes[32] = {};
+            size_t available = std::min<size_t>(info.n, size - pc);
+            std::copy(code + pc, code + pc + available, bytes + (32 - info.n));
+            instruction.arg = (uint32_t)analysis.pushValues.size();
+            analysis.pushValues.push_back(UInt256::loadBigEndian(bytes));
+            pc += available;
+        }
+        analysis.instructions.push_back(instruction);
+
+        current.instructions++;
+        current.gasCost += info.gas;
+        required = std::max(required, info.stackIn - height);
+        height += info.stackOut - info.stackIn;
+        growth = std::max(growth, height);
+
+        if (endsBlock(info.handler) || pc == size) close(pc);
+    }
+    analysis.instructions.push_back({Handler::STOP});
+    return analysis;
+}
+
+CodeAnalysisCache::CodeAnalysisCache(size_t capacity) : entries(capacity) {}
+
+std::shared_ptr<const CodeAnalysis> CodeAnalysisCache::get(const Hash& codeHash, const std::vector<uint8_t>& code) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (auto* cached = entries.get(codeHash)) {
+            hitCount++;
+            return *cached;
+        }
+        missCount++;
+    }
+
+    // Analyzed outside the lock; a concurrent miss on the same code only repeats the work
+    auto analysis = std::make_shared<const CodeAnalysis>(CodeAnalysis::analyze(code.data(), code.size()));
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.put(codeHash, analysis);
+    return analysis;
+}
+
+std::shared_ptr<const CodeAnalysis> CodeAnalysisCache::find(const Hash& codeHash) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto* cached = entries.get(codeHash);
+    if (!cached) return nullptr;
+    hitCount++;
+    return *cached;
+}
+
+size_t CodeAnalysisCache::size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+uint64_t CodeAnalysisCache::hits() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hitCount;
+}
+
+uint64_t CodeAnalysisCache::misses() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return missCount;
+}
+
+}
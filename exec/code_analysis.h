@@ -0,0 +1,103 @@
+#pragma once
+#include "core/types.h"
+#include "util/lru_cache.h"
+#include "util/uint256.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace aegen {
+
+/**
+ * CodeAnalysis - Bytecode decoded for the interpreter
+ *
+ * A bitmap of the offsets that are JUMPDEST instructions (a 0x5B inside PUSH
+ * data is not one), and the code split into basic blocks: straight-line runs
+ * that start at offset 0, at a JUMPDEST or after a jump, and end after a
+ * jump, a halting instruction or an instruction that reads or forwards the
+ * gas left (GAS, calls, creations), or just before the next JUMPDEST.
+ *
+ * The code is also decoded into an instruction stream with PUSH values
+ * parsed. Each block opens with a BEGIN_BLOCK instruction carrying the
+ * block's static gas and stack bounds, so the interpreter checks those once
+ * per block rather than once per instruction.
+ */
+struct CodeAnalysis {
+    // Interpreter entry points. Opcodes sharing a body (PUSHn, DUPn, SWAPn,
+    // LOGn) share a handler; anything without one decodes to UNDEFINED.
+    enum class Handler : uint8_t {
+        BEGIN_BLOCK,
+        STOP, ADD, MUL, SUB, DIV, MOD, AND, OR, XOR, NOT, LT, EQ, ISZERO,
+        POP, MLOAD, MSTORE, MSTORE8, SLOAD, SSTORE, JUMP, JUMPI, JUMPDEST,
+        PUSH, DUP, SWAP, LOG,
+        ADDRESS, CALLER, CALLVALUE, CALLDATALOAD, CALLDATASIZE, CALLDATACOPY,
+        CODESIZE, CODECOPY, RETURNDATASIZE, RETURNDATACOPY, GAS,
+        CREATE, CALL, RETURN, DELEGATECALL, CREATE2, STATICCALL,
+        REVERT, INVALID, UNDEFINED,
+        COUNT
+    };
+
+    struct Instruction {
+        Handler handler;
+        uint8_t n = 0;    // DUPn/SWAPn/LOGn: n; UNDEFINED: the opcode byte
+        uint32_t arg = 0; // BEGIN_BLOCK: block index; PUSH: index into pushValues
+    };
+
+    struct BasicBlock {
+        uint32_t start = 0;
+        uint32_t end = 0; // One past the last byte, PUSH data included
+        uint32_t instructions = 0;
+        uint32_t entry = 0;      // Index of the block's BEGIN_BLOCK instruction
+        uint64_t gasCost = 0;    // Static gas of all its instructions
+        uint32_t stackRequired = 0; // Stack height needed on entry
+        uint32_t stackGrowth = 0;   // Highest the stack rises above the entry height
+    };
+
+    size_t codeSize = 0;
+    std::vector<uint8_t> code; // For CODECOPY
+    std::vector<uint64_t> jumpdests; // Bit i set when offset i is a JUMPDEST
+    std::vector<BasicBlock> blocks;  // In code order, covering the whole code
+    std::vector<Instruction> instructions; // Ends with a STOP for running off the end
+    std::vector<UInt256> pushValues;
+
+    bool isJumpDest(uint64_t offset) const {
+        return offset < codeSize && (jumpdests[offset / 64] >> (offset % 64)) & 1;
+    }
+
+    // Block starting at `offset`, which must be a JUMPDEST
+    const BasicBlock& blockAt(uint64_t offset) const;
+
+    static CodeAnalysis analyze(const uint8_t* code, size_t size);
+};
+
+/**
+ * CodeAnalysisCache - Analyses of recently executed code, by code hash
+ *
+ * Contracts called many times per block are analyzed once. Entries are
+ * shared, so an analysis stays valid for a running call after eviction.
+ * Thread-safe: eth_call simulations run next to block execution.
+ */
+class CodeAnalysisCache {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+    explicit CodeAnalysisCache(size_t capacity = DEFAULT_CAPACITY);
+
+    // `codeHash` must be the hash of `code`
+    std::shared_ptr<const CodeAnalysis> get(const Hash& codeHash, const std::vector<uint8_t>& code);
+    // Cached analysis only, so callers can skip loading the code on a hit; a miss is counted by get()
+    std::shared_ptr<const CodeAnalysis> find(const Hash& codeHash);
+
+    size_t size();
+    uint64_t hits();
+    uint64_t misses();
+
+private:
+    std::mutex mutex;
+    LRUCache<Hash, std::shared_ptr<const CodeAnalysis>, HashHasher> entries;
+    uint64_t hitCount = 0;
+    uint64_t missCount = 0;
+};
+
+}
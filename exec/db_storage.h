@@ -32,6 +32,27 @@ public:
         std::string valHex = stateManager.getContractStorage(contractAddr.toHex(), key.toHex());
         return UInt256::fromHex(valHex);
     }
+
+    std::vector<uint8_t> getCode(const UInt256& contractAddr) const override {
+        std::string code = stateManager.getContractCode(contractKey(contractAddr));
+        return std::vector<uint8_t>(code.begin(), code.end());
+    }
+
+    void setCode(const UInt256& contractAddr, const std::vector<uint8_t>& code) override {
+        stateManager.setContractCode(contractKey(contractAddr), std::string(code.begin(), code.end()));
+    }
+
+    std::optional<Hash> getCodeHash(const UInt256& contractAddr) const override {
+        return stateManager.getContractCodeHash(contractKey(contractAddr));
+    }
+
+    uint64_t getNonce(const UInt256& contractAddr) const override {
+        return stateManager.getContractNonce(contractKey(contractAddr));
+    }
+
+    void setNonce(const UInt256& contractAddr, uint64_t nonce) override {
+        stateManager.setContractNonce(contractKey(contractAddr), nonce);
+    }
 };
 
 }
@@ -1,5 +1,7 @@
 #include "execution_engine.h"
+#include <algorithm>
 #include <iostream>
+#include <unordered_map>
 #include "util/crypto.h"
 #include "tokens/token_transfer.h"
 #include "vm.h"
@@ -8,63 +10,278 @@
 
 namespace aegen {
 
-ExecutionEngine::ExecutionEngine(StateManager& sm) : stateManager(sm) {}
+// Account reads and writes of one transaction. The sequential path goes
+// straight to the StateManager; speculative execution records them.
+class AccountView {
+public:
+    virtual ~AccountView() = default;
+    virtual AccountState get(const Address& addr) = 0;
+    virtual void set(const Address& addr, const AccountState& state) = 0;
+    // Adds to a balance; speculative views do not make it depend on the prior value
+    virtual void credit(const Address& addr, uint64_t amount) = 0;
+};
 
-bool ExecutionEngine::validateTransaction(const Transaction& tx) {
-    // 1. Check signature - CRITICAL SECURITY FIX
-    // Extract public key from sender address
-    // For Kadena-style "k:pubkey" addresses
-    if (tx.sender.substr(0, 2) == "k:") {
-        std::string pubKeyHex = tx.sender.substr(2);
-        // Convert hex to bytes
-        PublicKey senderPubKey;
-        if (pubKeyHex.length() == 64) { // 32 bytes = 64 hex chars
-            senderPubKey.resize(32);
-            for (size_t i = 0; i < 32; ++i) {
-                std::string byteStr = pubKeyHex.substr(i * 2, 2);
-                senderPubKey[i] = static_cast<uint8_t>(std::stoul(byteStr, nullptr, 16));
-            }
-            
-            // Verify signature
-            if (tx.signature.empty() || !tx.isSignedBy(senderPubKey)) {
-                std::cerr << "[SECURITY] Signature verification FAILED for " << tx.sender << std::endl;
-                return false;
-            }
+namespace {
+
+bool sameState(const AccountState& a, const AccountState& b) {
+    return a.nonce == b.nonce && a.balance == b.balance;
+}
+
+class StateView : public AccountView {
+    StateManager& state;
+
+public:
+    explicit StateView(StateManager& state) : state(state) {}
+
+    AccountState get(const Address& addr) override { return state.getAccountState(addr); }
+    void set(const Address& addr, const AccountState& value) override { state.setAccountState(addr, value); }
+    void credit(const Address& addr, uint64_t amount) override {
+        AccountState value = state.getAccountState(addr);
+        value.balance += amount;
+        state.setAccountState(addr, value);
+    }
+};
+
+using AccountOverlay = std::map<Address, AccountState>;
+
+// Executes against a fixed view of the state (the overlay of already
+// committed transactions over the StateManager) and records the first value
+// read from each account, the values written and blind balance credits.
+// The run stays valid as long as every recorded read still holds.
+class SpeculativeView : public AccountView {
+    StateManager* state;
+    const AccountOverlay* overlay;
+    std::unordered_map<Address, AccountState> reads;
+    std::unordered_map<Address, AccountState> writes;
+    std::unordered_map<Address, uint64_t> credits;
+
+    AccountState load(const Address& addr) const {
+        if (overlay) {
+            auto it = overlay->find(addr);
+            if (it != overlay->end()) return it->second;
+        }
+        return state->getAccountState(addr);
+    }
+
+public:
+    SpeculativeView(StateManager& state, const AccountOverlay* overlay) : state(&state), overlay(overlay) {}
+
+    AccountState get(const Address& addr) override {
+        auto written = writes.find(addr);
+        if (written != writes.end()) return written->second;
+        auto read = reads.find(addr);
+        if (read == reads.end()) read = reads.emplace(addr, load(addr)).first;
+
+        // A pending credit now needs the base value after all
+        auto credit = credits.find(addr);
+        if (credit == credits.end()) return read->second;
+        AccountState value = read->second;
+        value.balance += credit->second;
+        credits.erase(credit);
+        writes[addr] = value;
+        return value;
+    }
+
+    void set(const Address& addr, const AccountState& value) override {
+        credits.erase(addr);
+        writes[addr] = value;
+    }
+
+    void credit(const Address& addr, uint64_t amount) override {
+        auto written = writes.find(addr);
+        if (written != writes.end()) {
+            written->second.balance += amount;
+        } else if (auto read = reads.find(addr); read != reads.end()) {
+            AccountState value = read->second;
+            value.balance += amount;
+            writes[addr] = value;
         } else {
-            std::cerr << "[SECURITY] Invalid public key format in address: " << tx.sender << std::endl;
-            return false;
+            credits[addr] += amount;
         }
-    } else {
-        // For simple addresses (alice, bob, etc.) - require signature in production
-        // For now, log a warning
-        std::cerr << "[WARNING] Simple address used without key verification: " << tx.sender << std::endl;
     }
-    
+
+    bool readsHold(const AccountOverlay& committed) const {
+        for (const auto& [addr, value] : reads) {
+            auto it = committed.find(addr);
+            if (!sameState(it != committed.end() ? it->second : state->getAccountState(addr), value)) return false;
+        }
+        return true;
+    }
+
+    void applyTo(AccountOverlay& committed) const {
+        for (const auto& [addr, value] : writes) committed[addr] = value;
+        for (const auto& [addr, amount] : credits) {
+            auto it = committed.find(addr);
+            AccountState value = it != committed.end() ? it->second : state->getAccountState(addr);
+            value.balance += amount;
+            committed[addr] = value;
+        }
+    }
+};
+
+}
+
+ExecutionEngine::ExecutionEngine(StateManager& sm, size_t workerThreads) : stateManager(sm) {
+    if (workerThreads == 0) workerThreads = std::max(1u, std::thread::hardware_concurrency());
+    workers = std::make_unique<ThreadPool>(workerThreads - 1);
+    signatures = std::make_unique<SignatureVerifier>(*workers);
+}
+
+ExecutionEngine::~ExecutionEngine() = default;
+
+bool ExecutionEngine::validateTransaction(const Transaction& tx) {
+    // Usually a cache hit: verified when the tx entered the mempool
+    if (!signatures->verify(tx)) return false;
+    StateView view(stateManager);
+    std::string error;
+    if (!checkAccount(tx, view, error)) {
+        std::cerr << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ExecutionEngine::checkAccount(const Transaction& tx, AccountView& view, std::string& error) {
     // 2. Check nonce
-    AccountState senderState = stateManager.getAccountState(tx.sender);
+    AccountState senderState = view.get(tx.sender);
     if (tx.nonce != senderState.nonce) {
-        std::cerr << "[VALIDATION] Nonce mismatch. Expected: " << senderState.nonce 
-                  << ", Got: " << tx.nonce << std::endl;
+        error = "[VALIDATION] Nonce mismatch. Expected: " + std::to_string(senderState.nonce) +
+                ", Got: " + std::to_string(tx.nonce);
         return false;
     }
     
     // 3. Check balance
     uint64_t totalCost = tx.amount + (tx.gasLimit * tx.gasPrice);
     if (senderState.balance < totalCost) {
-        std::cerr << "[VALIDATION] Insufficient balance. Required: " << totalCost 
-                  << ", Available: " << senderState.balance << std::endl;
+        error = "[VALIDATION] Insufficient balance. Required: " + std::to_string(totalCost) +
+                ", Available: " + std::to_string(senderState.balance);
         return false;
     }
 
     return true;
 }
 
+bool ExecutionEngine::applyBlock(const Block& block) {
+    BlockContext context(block.header);
+    std::vector<bool> applied = applyTransactions(block.transactions, context);
+    for (size_t i = 0; i < applied.size(); ++i) {
+        if (!applied[i]) {
+            std::cerr << "Block contains invalid tx: " << crypto::to_hex(block.transactions[i].hash) << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
 void ExecutionEngine::applyTransaction(const Transaction& tx, const Address& coinbase) {
+    BlockContext context;
+    context.coinbase = coinbase;
+    applyTransaction(tx, context);
+}
+
+bool ExecutionEngine::applyTransaction(const Transaction& tx, BlockContext& block) {
+    StateView view(stateManager);
+    TransactionReceipt receipt;
+    std::string error;
+    if (!execute(tx, block, view, receipt, error)) {
+        std::cerr << error << std::endl;
+        return false;
+    }
+    recordReceipt(std::move(receipt), block);
+    return true;
+}
+
+std::vector<bool> ExecutionEngine::applyTransactions(const std::vector<Transaction>& txs, BlockContext& block) {
+    // Signatures first, as one batch; only those not seen by the mempool cost a check
+    std::vector<bool> signatureValid = signatures->verifyBatch(txs);
+
+    std::vector<bool> applied(txs.size(), false);
+    for (size_t start = 0; start < txs.size();) {
+        // VM transactions touch contract storage, which speculation does not
+        // track; they run alone at their position
+        if (!txs[start].data.empty()) {
+            applied[start] = signatureValid[start] && validateTransaction(txs[start]) &&
+                             applyTransaction(txs[start], block);
+            start++;
+            continue;
+        }
+        size_t end = start;
+        while (end < txs.size() && txs[end].data.empty()) end++;
+        applyTransfers(txs, start, end, signatureValid, block, applied);
+        start = end;
+    }
+    return applied;
+}
+
+// Block-STM style: every transfer first runs in parallel against the state
+// before the segment. Commit then walks them in block order; a run whose
+// reads were changed by an earlier transaction is executed again on top of
+// the committed prefix, so the result matches sequential execution.
+void ExecutionEngine::applyTransfers(const std::vector<Transaction>& txs, size_t start, size_t end,
+                                     const std::vector<bool>& signatureValid, BlockContext& block,
+                                     std::vector<bool>& applied) {
+    struct Run {
+        bool ok = false;
+        std::optional<SpeculativeView> view;
+        TransactionReceipt receipt;
+        std::string error;
+    };
+    std::vector<Run> runs(end - start);
+
+    workers->parallelFor(runs.size(), [&](size_t i) {
+        const Transaction& tx = txs[start + i];
+        Run& run = runs[i];
+        if (!signatureValid[start + i]) return;
+        run.view.emplace(stateManager, nullptr);
+        run.ok = checkAccount(tx, *run.view, run.error) && execute(tx, block, *run.view, run.receipt, run.error);
+    });
+
+    AccountOverlay committed;
+    for (size_t i = 0; i < runs.size(); ++i) {
+        const Transaction& tx = txs[start + i];
+        Run& run = runs[i];
+        if (!signatureValid[start + i]) continue;
+        if (!run.view->readsHold(committed)) {
+            run.view.emplace(stateManager, &committed);
+            run.receipt = TransactionReceipt{};
+            run.error.clear();
+            run.ok = checkAccount(tx, *run.view, run.error) && execute(tx, block, *run.view, run.receipt, run.error);
+        }
+        if (!run.ok) {
+            std::cerr << run.error << std::endl;
+            continue;
+        }
+        run.view->applyTo(committed);
+        recordReceipt(std::move(run.receipt), block);
+        applied[start + i] = true;
+    }
+
+    for (const auto& [addr, state] : committed) {
+        stateManager.setAccountState(addr, state);
+    }
+}
+
+void ExecutionEngine::recordReceipt(TransactionReceipt receipt, BlockContext& block) {
+    receipt.transactionIndex = block.transactionIndex++;
+    receipt.blockNumber = block.number;
+    block.cumulativeGasUsed += receipt.gasUsed;
+    receipt.cumulativeGasUsed = block.cumulativeGasUsed;
+
+    // Held until the block is finalized
+    std::string key = crypto::to_hex(receipt.transactionHash);
+    std::lock_guard<std::mutex> lock(receiptsMutex);
+    pendingReceipts[key] = std::move(receipt);
+}
+
+bool ExecutionEngine::execute(const Transaction& tx, const BlockContext& block, AccountView& view,
+                              TransactionReceipt& receipt, std::string& error) {
+    const Address& coinbase = block.coinbase;
+
     // Re-validate strict context (nonce must match exactly for execution)
-    AccountState senderState = stateManager.getAccountState(tx.sender);
+    AccountState senderState = view.get(tx.sender);
     if (tx.nonce != senderState.nonce) {
-        std::cerr << "Error: Invalid nonce for tx " << aegen::crypto::to_hex(tx.hash) << std::endl;
-        return;
+        error = "Error: Invalid nonce for tx " + crypto::to_hex(tx.hash);
+        return false;
     }
 
     // Deduct upfront cost from sender (amount + max gas fee)
@@ -75,16 +292,16 @@ void ExecutionEngine::applyTransaction(const Transaction& tx, const Address& coi
     if (senderState.balance < totalUpfrontCost) {
          // Should not happen if pre-validated, but safety check.
          // If fail, we can't even pay for gas, so we drop.
-         std::cerr << "Error: Insufficient balance during execution" << std::endl;
-         return;
+         error = "Error: Insufficient balance during execution";
+         return false;
     }
 
+    AccountState original = senderState;
     senderState.balance -= totalUpfrontCost;
     senderState.nonce++;
-    stateManager.setAccountState(tx.sender, senderState);
+    view.set(tx.sender, senderState);
 
     // Prepare Receipt
-    TransactionReceipt receipt;
     receipt.transactionHash = tx.hash;
     receipt.from = tx.sender;
     receipt.to = tx.receiver;
@@ -92,8 +309,10 @@ void ExecutionEngine::applyTransaction(const Transaction& tx, const Address& coi
     receipt.gasUsed = 21000; // Intrinsic gas (basic transfer)
     
     // Execute Data (VM) if present
-    if (!tx.data.empty()) {
-        executeData(tx, receipt);
+    if (!tx.data.empty() && !executeData(tx, receipt, error)) {
+        // The node failed, not the transaction: leave it unapplied
+        view.set(tx.sender, original);
+        return false;
     }
     
     // Cap gasUsed at gasLimit logic is implicit in VM, but safety check:
@@ -105,17 +324,16 @@ void ExecutionEngine::applyTransaction(const Transaction& tx, const Address& coi
     
     // 1. Refund Sender
     if (refund > 0) {
-        senderState = stateManager.getAccountState(tx.sender); // Reload in case it's same as receiver or changed (e.g. loops)
+        senderState = view.get(tx.sender); // Reload in case it's same as receiver or changed (e.g. loops)
         senderState.balance += refund;
-        stateManager.setAccountState(tx.sender, senderState);
+        view.set(tx.sender, senderState);
     }
     
     // 2. Pay Validator (Coinbase)
-    // Only if coinbase is valid
+    // Only if coinbase is valid. A credit, so that transactions paying the
+    // same coinbase do not conflict under parallel execution.
     if (!coinbase.empty()) {
-        AccountState coinbaseState = stateManager.getAccountState(coinbase);
-        coinbaseState.balance += actualGasFee;
-        stateManager.setAccountState(coinbase, coinbaseState);
+        view.credit(coinbase, actualGasFee);
     }
 
     // 3. Transfer Value to Receiver
@@ -126,24 +344,23 @@ void ExecutionEngine::applyTransaction(const Transaction& tx, const Address& coi
     // So if failed, we must refund the AMOUNT too.
     
     if (receipt.status) {
-         AccountState receiverState = stateManager.getAccountState(tx.receiver);
+         AccountState receiverState = view.get(tx.receiver);
          receiverState.balance += tx.amount;
-         stateManager.setAccountState(tx.receiver, receiverState);
+         view.set(tx.receiver, receiverState);
     } else {
          // Revert: Refund the value amount to sender
          // Sender was already deducted `amount + maxGas`. 
          // We refunded `maxGas - actualGas = unusedGas`.
          // Now we refund `amount`.
-         senderState = stateManager.getAccountState(tx.sender);
+         senderState = view.get(tx.sender);
          senderState.balance += tx.amount;
-         stateManager.setAccountState(tx.sender, senderState);
+         view.set(tx.sender, senderState);
     }
 
-    // Cache receipt
-    receiptCache[crypto::to_hex(tx.hash)] = receipt;
+    return true;
 }
 
-void ExecutionEngine::executeData(const Transaction& tx, TransactionReceipt& receipt) {
+bool ExecutionEngine::executeData(const Transaction& tx, TransactionReceipt& receipt, std::string& error) {
     // Check if EVM transaction (heuristic: hex-like data or receiver with code)
     // If receiver is empty -> Deploy
     // If receiver has code -> Call
@@ -155,12 +372,12 @@ void ExecutionEngine::executeData(const Transaction& tx, TransactionReceipt& rec
          // This is a simplified internal token operation format
          // In production, this would be replaced by ABI-encoded calls
          receipt.gasUsed = 21000; // Base gas for token op
-         return;
+         return true;
     }
     
     // EVM Execution
     DBStorage storageBackend(stateManager);
-    VM vm(&storageBackend);
+    VM vm(&storageBackend, &codeAnalyses);
     
     CallContext ctx;
     ctx.caller = UInt256::fromHex(crypto::to_hex(crypto::sha256(tx.sender))); 
@@ -172,17 +389,27 @@ void ExecutionEngine::executeData(const Transaction& tx, TransactionReceipt& rec
     
     if (tx.receiver.empty()) {
         // CONTRACT DEPLOYMENT
-        ctx.address = UInt256(0); // For deployment context
+        // The init code runs as the new contract, so constructor writes land in its storage
+        std::string contractAddr = deploymentAddress(tx);
+        if (!stateManager.getContractCode(contractAddr).empty()) {
+            // Address taken: as for CREATE, the deployment fails and its gas is lost
+            receipt.gasUsed = tx.gasLimit;
+            receipt.status = false;
+            return true;
+        }
+        ctx.address = UInt256::fromHex(contractAddr.substr(2));
+        ctx.creation = true;
         
         // Execute init code
         auto result = vm.execute(tx.data, ctx);
+        if (result.status == EVMStatus::INTERNAL_ERROR) {
+            error = "[VM] " + result.error;
+            return false;
+        }
         receipt.gasUsed += result.gasUsed;
         receipt.status = result.success;
         
         if (result.success) {
-            // Calculate Contract Address (mock: hash of sender + nonce)
-            // Real ETH: keccak(RLP(sender, nonce))
-            std::string contractAddr = "0x" + crypto::to_hex(crypto::sha256(tx.sender + std::to_string(tx.nonce))).substr(24);
             stateManager.setContractCode(contractAddr, std::string(result.output.begin(), result.output.end()));
             receipt.contractAddress = contractAddr;
             receipt.to = contractAddr; // In receipt, 'to' is null for deployment, 'contractAddress' is set.
@@ -191,13 +418,18 @@ void ExecutionEngine::executeData(const Transaction& tx, TransactionReceipt& rec
         // CONTRACT CALL
         // Load code from state
         std::string codeStr = stateManager.getContractCode(tx.receiver);
-        if (codeStr.empty()) return; // Not a contract or empty
+        if (codeStr.empty()) return true; // Not a contract or empty
         
         code.assign(codeStr.begin(), codeStr.end());
+        ctx.codeHash = stateManager.getContractCodeHash(tx.receiver);
         
         ctx.address = UInt256::fromHex(tx.receiver.substr(0, 2) == "0x" ? tx.receiver.substr(2) : tx.receiver);
         
         auto result = vm.execute(code, ctx);
+        if (result.status == EVMStatus::INTERNAL_ERROR) {
+            error = "[VM] " + result.error;
+            return false;
+        }
         receipt.gasUsed += result.gasUsed;
         receipt.status = result.success;
 
@@ -207,23 +439,61 @@ void ExecutionEngine::executeData(const Transaction& tx, TransactionReceipt& rec
             log.address = "0x" + logEntry.address.toHex();
             for (const auto& topic : logEntry.topics) {
                 Hash h;
-                auto bytes = topic.toBigEndianBytes();
-                std::copy(bytes.begin(), bytes.end(), h.begin());
+                topic.storeBigEndian(h.data());
                 log.topics.push_back(h);
             }
             log.data = logEntry.data;
             receipt.logs.push_back(log);
         }
     }
+    return true;
+}
+
+std::string ExecutionEngine::deploymentAddress(const Transaction& tx) {
+    // Mock: hash of sender + nonce. Real ETH: keccak(RLP(sender, nonce))
+    return "0x" + crypto::to_hex(crypto::sha256(tx.sender + std::to_string(tx.nonce))).substr(24);
 }
 
 std::optional<TransactionReceipt> ExecutionEngine::getReceipt(const std::string& txHash) {
-    if (receiptCache.count(txHash)) return receiptCache[txHash];
-    return std::nullopt;
+    {
+        std::lock_guard<std::mutex> lock(receiptsMutex);
+        auto it = pendingReceipts.find(txHash);
+        if (it != pendingReceipts.end()) return it->second;
+    }
+    if (!receiptStore) return std::nullopt;
+
+    std::vector<uint8_t> bytes = crypto::from_hex(txHash);
+    if (bytes.size() != sizeof(Hash)) return std::nullopt;
+    Hash hash;
+    std::copy(bytes.begin(), bytes.end(), hash.begin());
+    return receiptStore->getReceipt(hash);
+}
+
+bool ExecutionEngine::commitBlockReceipts(const Block& block, uint64_t& gasUsed) {
+    std::vector<TransactionReceipt> receipts;
+    receipts.reserve(block.transactions.size());
+    Hash blockHash = block.calculateHash();
+    gasUsed = 0;
+    {
+        std::lock_guard<std::mutex> lock(receiptsMutex);
+        for (const auto& tx : block.transactions) {
+            auto it = pendingReceipts.find(crypto::to_hex(tx.hash));
+            if (it == pendingReceipts.end()) continue;
+            it->second.blockHash = blockHash;
+            gasUsed += it->second.gasUsed;
+            receipts.push_back(it->second);
+        }
+    }
+
+    // Stored before the pending copies go, so a lookup in between finds one of them
+    if (receiptStore && !receiptStore->putBlockReceipts(block.header.height, receipts)) return false;
+    std::lock_guard<std::mutex> lock(receiptsMutex);
+    pendingReceipts.clear();
+    return true;
 }
-std::string ExecutionEngine::simulateTransaction(const Transaction& tx) {
-    SandboxStorage sandbox(stateManager);
-    VM vm(&sandbox);
+std::string ExecutionEngine::simulateTransaction(const Transaction& tx, const std::optional<StateSnapshot>& at) {
+    SandboxStorage sandbox = at ? SandboxStorage(*at) : SandboxStorage(stateManager);
+    VM vm(&sandbox, &codeAnalyses);
     
     CallContext ctx;
     // Mock caller derivation
@@ -236,12 +506,15 @@ std::string ExecutionEngine::simulateTransaction(const Transaction& tx) {
     if (tx.receiver.empty()) {
         // Simulation of deployment - executes init code
         code = tx.data;
-        ctx.address = UInt256(0);
+        ctx.address = UInt256::fromHex(deploymentAddress(tx).substr(2));
+        ctx.creation = true;
     } else {
-        std::string codeStr = stateManager.getContractCode(tx.receiver);
+        std::string codeStr = at ? at->getContractCode(tx.receiver) : stateManager.getContractCode(tx.receiver);
         if (codeStr.empty()) return "0x";
         code.assign(codeStr.begin(), codeStr.end());
-        ctx.address = UInt256::fromHex(crypto::to_hex(crypto::sha256(tx.receiver)));
+        ctx.codeHash = at ? at->getContractCodeHash(tx.receiver) : stateManager.getContractCodeHash(tx.receiver);
+        // Same address as execution uses, so storage and calls to other contracts resolve alike
+        ctx.address = UInt256::fromHex(tx.receiver.substr(0, 2) == "0x" ? tx.receiver.substr(2) : tx.receiver);
         ctx.data = tx.data;
     }
     
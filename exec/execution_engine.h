@@ -2,12 +2,35 @@
 #include "core/transaction.h"
 #include "core/block.h"
 #include "db/state_manager.h"
+#include "db/receipt_store.h"
 #include "core/receipt.h"
+#include "signature_verifier.h"
+#include "code_analysis.h"
+#include "util/thread_pool.h"
 #include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <vector>
 
 namespace aegen {
 
+// Position of execution within the block being built or replayed. Each
+// applied transaction takes the next index and adds its gas to the total.
+struct BlockContext {
+    uint64_t number = 0;
+    uint64_t timestamp = 0;
+    Address coinbase;
+    uint64_t transactionIndex = 0;
+    uint64_t cumulativeGasUsed = 0;
+
+    BlockContext() = default;
+    explicit BlockContext(const BlockHeader& header)
+        : number(header.height), timestamp(header.timestamp), coinbase(header.producer) {}
+};
+
+class AccountView;
+
 class ExecutionEngine {
     StateManager& stateManager;
     
@@ -15,21 +38,66 @@ class ExecutionEngine {
     void executeData(const Transaction& tx);
     
 public:
-    ExecutionEngine(StateManager& sm);
+    // Transfers of a block execute on `workerThreads` threads, the caller
+    // included; 0 uses one per hardware thread
+    explicit ExecutionEngine(StateManager& sm, size_t workerThreads = 0);
+    ~ExecutionEngine();
 
-    void applyBlock(const Block& block);
-    void applyTransaction(const Transaction& tx, const Address& coinbase);
+    // Validates and applies the block's transactions in order; false if any
+    // is invalid, with the valid ones still applied
+    bool applyBlock(const Block& block);
+    // Validates and applies `txs` with the same result as one after another,
+    // executing plain transfers in parallel. applied[i] is false for a
+    // transaction that was invalid or failed; it changed no state.
+    std::vector<bool> applyTransactions(const std::vector<Transaction>& txs, BlockContext& block);
+    // Returns false if the transaction could not be applied; `block` only
+    // advances for applied ones
+    bool applyTransaction(const Transaction& tx, BlockContext& block);
+    void applyTransaction(const Transaction& tx, const Address& coinbase = "");
     bool validateTransaction(const Transaction& tx);
+
+    // Signature stage, shared with the mempool entry points
+    SignatureVerifier& signatureVerifier() { return *signatures; }
+    // JUMPDEST analyses of called contracts, shared by execution and simulation
+    CodeAnalysisCache& codeAnalysisCache() { return codeAnalyses; }
     
     // Simulate execution without state changes (for eth_call)
+    // Reads `at` when given, otherwise the state of the block being executed
     // Returns hex-encoded output
-    std::string simulateTransaction(const Transaction& tx);
+    std::string simulateTransaction(const Transaction& tx, const std::optional<StateSnapshot>& at = std::nullopt);
 
+    // Receipts of executed but not yet finalized transactions are held in
+    // memory; committed blocks are looked up in the receipt store when set
+    void setReceiptStore(ReceiptStore* store) { receiptStore = store; }
     std::optional<TransactionReceipt> getReceipt(const std::string& txHash);
 
+    // Stamps the block hash on the receipts of the block's transactions and
+    // moves them, in block order, into the receipt store, dropping all other
+    // pending receipts. Sets the block's gas used; false if the receipts could
+    // not be stored, in which case they stay pending.
+    bool commitBlockReceipts(const Block& block, uint64_t& gasUsed);
+
 private:
-    std::map<std::string, TransactionReceipt> receiptCache;
-    void executeData(const Transaction& tx, TransactionReceipt& receipt);
+    std::unique_ptr<ThreadPool> workers;
+    std::unique_ptr<SignatureVerifier> signatures;
+    CodeAnalysisCache codeAnalyses;
+    ReceiptStore* receiptStore = nullptr;
+    // Keyed by hex tx hash. Written by the block producing and finalizing
+    // threads while RPC threads read it, so guarded by receiptsMutex.
+    std::map<std::string, TransactionReceipt> pendingReceipts;
+    std::mutex receiptsMutex;
+    // False, with `error` set, when the VM hit an internal error; its state writes are undone
+    bool executeData(const Transaction& tx, TransactionReceipt& receipt, std::string& error);
+    // Where a deployment transaction puts its contract
+    static std::string deploymentAddress(const Transaction& tx);
+
+    bool checkAccount(const Transaction& tx, AccountView& view, std::string& error);
+    // The state transition of one transaction; leaves the block position to recordReceipt
+    bool execute(const Transaction& tx, const BlockContext& block, AccountView& view,
+                 TransactionReceipt& receipt, std::string& error);
+    void applyTransfers(const std::vector<Transaction>& txs, size_t start, size_t end,
+                        const std::vector<bool>& signatureValid, BlockContext& block, std::vector<bool>& applied);
+    void recordReceipt(TransactionReceipt receipt, BlockContext& block);
 };
 
 }
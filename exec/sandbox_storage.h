@@ -2,16 +2,22 @@
 #include "storage_interface.h"
 #include "db/state_manager.h"
 #include <map>
+#include <optional>
 #include <string>
+#include <vector>
 
 namespace aegen {
 
 class SandboxStorage : public StorageInterface {
-    StateManager& backend;
+    StateManager* backend = nullptr;
+    std::optional<StateSnapshot> snapshot; // Read instead of backend when set
     std::map<std::string, UInt256> dirtyStorage; // Key: "addr_key", Value: val
+    std::map<std::string, std::vector<uint8_t>> dirtyCode; // By contract key
+    std::map<std::string, uint64_t> dirtyNonces;
 
 public:
-    SandboxStorage(StateManager& sm) : backend(sm) {}
+    SandboxStorage(StateManager& sm) : backend(&sm) {}
+    SandboxStorage(const StateSnapshot& snap) : snapshot(snap) {}
 
     void setStorage(const UInt256& contractAddr, const UInt256& key, const UInt256& value) override {
         std::string mapKey = contractAddr.toHex() + "_" + key.toHex();
@@ -28,9 +34,44 @@ public:
         }
 
         // 2. Check persistent backend
-        std::string valHex = const_cast<StateManager&>(backend).getContractStorage(contractAddr.toHex(), key.toHex());
+        std::string valHex = snapshot ? snapshot->getContractStorage(contractAddr.toHex(), key.toHex())
+                                      : backend->getContractStorage(contractAddr.toHex(), key.toHex());
         return UInt256::fromHex(valHex);
     }
+
+    std::vector<uint8_t> getCode(const UInt256& contractAddr) const override {
+        std::string contract = contractKey(contractAddr);
+        auto it = dirtyCode.find(contract);
+        if (it != dirtyCode.end()) {
+            return it->second;
+        }
+        std::string code = snapshot ? snapshot->getContractCode(contract) : backend->getContractCode(contract);
+        return std::vector<uint8_t>(code.begin(), code.end());
+    }
+
+    void setCode(const UInt256& contractAddr, const std::vector<uint8_t>& code) override {
+        dirtyCode[contractKey(contractAddr)] = code;
+    }
+
+    std::optional<Hash> getCodeHash(const UInt256& contractAddr) const override {
+        // Code created in the sandbox is analyzed per call rather than cached
+        std::string contract = contractKey(contractAddr);
+        if (dirtyCode.count(contract)) return std::nullopt;
+        return snapshot ? snapshot->getContractCodeHash(contract) : backend->getContractCodeHash(contract);
+    }
+
+    uint64_t getNonce(const UInt256& contractAddr) const override {
+        std::string contract = contractKey(contractAddr);
+        auto it = dirtyNonces.find(contract);
+        if (it != dirtyNonces.end()) {
+            return it->second;
+        }
+        return snapshot ? snapshot->getContractNonce(contract) : backend->getContractNonce(contract);
+    }
+
+    void setNonce(const UInt256& contractAddr, uint64_t nonce) override {
+        dirtyNonces[contractKey(contractAddr)] = nonce;
+    }
 };
 
 }
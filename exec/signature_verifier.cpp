@@ -0,0 +1,86 @@
+#include "signature_verifier.h"
+#include <iostream>
+
+namespace aegen {
+
+SignatureVerifier::SignatureVerifier(ThreadPool& workers, size_t cacheCapacity)
+    : workers(workers), verified(cacheCapacity) {}
+
+bool SignatureVerifier::isVerified(const Transaction& tx) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    const Address* sender = verified.get(tx.hash);
+    return sender && *sender == tx.sender;
+}
+
+bool SignatureVerifier::verify(const Transaction& tx) {
+    if (isVerified(tx)) return true;
+    if (!check(tx)) return false;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    verified.put(tx.hash, tx.sender);
+    return true;
+}
+
+std::vector<bool> SignatureVerifier::verifyBatch(const std::vector<Transaction>& txs) {
+    std::vector<char> valid(txs.size(), 0); // Not vector<bool>: written from several threads
+    std::vector<size_t> misses;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        for (size_t i = 0; i < txs.size(); ++i) {
+            const Address* sender = verified.get(txs[i].hash);
+            if (sender && *sender == txs[i].sender) {
+                valid[i] = 1;
+            } else {
+                misses.push_back(i);
+            }
+        }
+    }
+
+    workers.parallelFor(misses.size(), [&](size_t i) { valid[misses[i]] = check(txs[misses[i]]) ? 1 : 0; });
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    for (size_t i : misses) {
+        if (valid[i]) verified.put(txs[i].hash, txs[i].sender);
+    }
+    return std::vector<bool>(valid.begin(), valid.end());
+}
+
+size_t SignatureVerifier::cacheSize() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return verified.size();
+}
+
+// Messages go out in one write each, as pool workers log concurrently
+bool SignatureVerifier::check(const Transaction& tx) {
+    // Extract public key from sender address
+    // For Kadena-style "k:pubkey" addresses
+    if (tx.sender.substr(0, 2) == "k:") {
+        std::string pubKeyHex = tx.sender.substr(2);
+        // Convert hex to bytes
+        PublicKey senderPubKey;
+        // 32 bytes = 64 hex chars. Checked up front: this runs on pool workers, which must not throw
+        if (pubKeyHex.length() == 64 && pubKeyHex.find_first_not_of("0123456789abcdefABCDEF") == std::string::npos) {
+            senderPubKey.resize(32);
+            for (size_t i = 0; i < 32; ++i) {
+                std::string byteStr = pubKeyHex.substr(i * 2, 2);
+                senderPubKey[i] = static_cast<uint8_t>(std::stoul(byteStr, nullptr, 16));
+            }
+            
+            // Verify signature
+            if (tx.signature.empty() || !tx.isSignedBy(senderPubKey)) {
+                std::cerr << "[SECURITY] Signature verification FAILED for " + tx.sender + "\n";
+                return false;
+            }
+        } else {
+            std::cerr << "[SECURITY] Invalid public key format in address: " + tx.sender + "\n";
+            return false;
+        }
+    } else {
+        // For simple addresses (alice, bob, etc.) - require signature in production
+        // For now, log a warning
+        std::cerr << "[WARNING] Simple address used without key verification: " + tx.sender + "\n";
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "core/transaction.h"
+#include "util/lru_cache.h"
+#include "util/thread_pool.h"
+#include <mutex>
+#include <vector>
+
+namespace aegen {
+
+/**
+ * SignatureVerifier - Signature checks as a stage ahead of execution
+ *
+ * Transactions are verified once, when they are submitted to the mempool or
+ * in parallel batches when a block arrives. Senders that passed are kept by
+ * tx hash, which covers the signature, so the proposer and validators find
+ * them here instead of verifying again. Failures are not cached.
+ *
+ * Thread-safe: RPC workers verify concurrently with block execution.
+ */
+class SignatureVerifier {
+public:
+    static constexpr size_t DEFAULT_CACHE_CAPACITY = 100000;
+
+    explicit SignatureVerifier(ThreadPool& workers, size_t cacheCapacity = DEFAULT_CACHE_CAPACITY);
+
+    bool verify(const Transaction& tx);
+    // Verifies the uncached ones on the pool; result[i] is verify(txs[i])
+    std::vector<bool> verifyBatch(const std::vector<Transaction>& txs);
+    bool isVerified(const Transaction& tx);
+
+    size_t cacheSize();
+
+    // The signature check itself, uncached
+    static bool check(const Transaction& tx);
+
+private:
+    ThreadPool& workers;
+    std::mutex cacheMutex;
+    LRUCache<Hash, Address, HashHasher> verified; // tx hash -> sender
+};
+
+}
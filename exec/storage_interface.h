@@ -1,5 +1,9 @@
 #pragma once
+#include "core/types.h"
 #include "util/uint256.h"
+#include <optional>
+#include <string>
+#include <vector>
 
 namespace aegen {
 
@@ -7,10 +11,34 @@ namespace aegen {
 class StorageInterface {
 public:
     virtual ~StorageInterface() = default;
-    
+
     // contractAddr is expected to be part of the key prefix
     virtual void setStorage(const UInt256& contractAddr, const UInt256& key, const UInt256& value) = 0;
     virtual UInt256 getStorage(const UInt256& contractAddr, const UInt256& key) const = 0;
+
+    // Code deployed at an address; empty when there is none
+    virtual std::vector<uint8_t> getCode(const UInt256& contractAddr) const = 0;
+    virtual void setCode(const UInt256& contractAddr, const std::vector<uint8_t>& code) = 0;
+    // Hash of that code where the backend keeps one, so its analysis can be
+    // cached without reading the code
+    virtual std::optional<Hash> getCodeHash(const UInt256& contractAddr) const = 0;
+
+    // Contracts created so far by a contract
+    virtual uint64_t getNonce(const UInt256& contractAddr) const = 0;
+    virtual void setNonce(const UInt256& contractAddr, uint64_t nonce) = 0;
+
+    // State keeps contracts under "0x" and the 40 hex digits of their 20-byte address
+    static std::string contractKey(const UInt256& contractAddr) {
+        static const char digits[] = "0123456789abcdef";
+        uint8_t bytes[32];
+        contractAddr.storeBigEndian(bytes);
+        std::string key = "0x";
+        for (size_t i = 12; i < 32; ++i) {
+            key += digits[bytes[i] >> 4];
+            key += digits[bytes[i] & 0x0f];
+        }
+        return key;
+    }
 };
 
 }
@@ -2,406 +2,710 @@
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>
+#include <cstring>
 #include "proofs/zk_proof.h"
+#include "util/crypto.h"
 
 namespace aegen {
 
-// Constants
-constexpr uint64_t MAX_STACK_SIZE = 1024;
-constexpr uint64_t GAS_COST_JUMPDEST = 1;
-constexpr uint64_t GAS_COST_BASE = 2; // Simplified base cost
-constexpr uint64_t GAS_COST_VERYLOW = 3;
-constexpr uint64_t GAS_COST_LOW = 5;
-constexpr uint64_t GAS_COST_MID = 8;
-constexpr uint64_t GAS_COST_HIGH = 10;
-constexpr uint64_t GAS_COST_SSTORE_SET = 20000;
-constexpr uint64_t GAS_COST_SSTORE_RESET = 5000;
-constexpr uint64_t GAS_COST_SLOAD = 800;
-constexpr uint64_t GAS_COST_CREATE = 32000;
-
-void VM::stackPush(const UInt256& val) {
-    if (stack.size() >= MAX_STACK_SIZE) throw std::runtime_error("Stack overflow");
-    stack.push_back(val);
+bool VM::consumeGas(uint64_t amount) {
+    if (gasRemaining < amount) {
+        return false;
+    }
+    gasRemaining -= amount;
+    return true;
+}
+
+const char* toString(EVMStatus status) {
+    switch (status) {
+        case EVMStatus::SUCCESS: return "Success";
+        case EVMStatus::REVERT: return "REVERT";
+        case EVMStatus::OUT_OF_GAS: return "Out of gas";
+        case EVMStatus::STACK_UNDERFLOW: return "Stack underflow";
+        case EVMStatus::STACK_OVERFLOW: return "Stack overflow";
+        case EVMStatus::BAD_JUMP_DESTINATION: return "Invalid Jump Destination";
+        case EVMStatus::INVALID_INSTRUCTION: return "INVALID Opcode";
+        case EVMStatus::UNDEFINED_INSTRUCTION: return "Unknown Opcode";
+        case EVMStatus::STATIC_MODE_VIOLATION: return "State change in static call";
+        case EVMStatus::RETURN_DATA_OUT_OF_BOUNDS: return "Return data out of bounds";
+        case EVMStatus::INTERNAL_ERROR: return "Internal error";
+    }
+    return "Unknown status";
 }
 
-UInt256 VM::stackPop() {
-    if (stack.empty()) throw std::runtime_error("Stack underflow");
-    UInt256 val = stack.back();
-    stack.pop_back();
-    return val;
+namespace {
+
+// Low 64 bits, or UINT64_MAX for values that do not fit, so oversized
+// offsets and sizes fail the memory bounds instead of wrapping around
+uint64_t saturate(const UInt256& value) {
+    uint64_t low = value.toUint64();
+    return UInt256(low) == value ? low : UINT64_MAX;
 }
 
-UInt256 VM::stackPeek(int offset) const {
-    if (offset < 0 || offset >= stack.size()) throw std::runtime_error("Stack underflow");
-    return stack[stack.size() - 1 - offset];
+// Copies `size` bytes of src starting at srcOffset; bytes past srcSize read as zero
+void copyPadded(uint8_t* dst, const uint8_t* src, size_t srcSize, uint64_t srcOffset, uint64_t size) {
+    size_t available = srcOffset < srcSize ? std::min<uint64_t>(size, srcSize - srcOffset) : 0;
+    if (available > 0) std::memcpy(dst, src + srcOffset, available);
+    std::memset(dst + available, 0, size - available);
 }
 
-void VM::stackSwap(int n) {
-    if (stack.size() <= n) throw std::runtime_error("Stack underflow for SWAP");
-    std::swap(stack[stack.size()-1], stack[stack.size()-1-n]);
+// Contract addresses are the last 20 bytes of a SHA-256 preimage, as deployments
+// from transactions are; Ethereum uses keccak256 and RLP
+UInt256 addressFromPreimage(const std::vector<uint8_t>& preimage) {
+    Hash hash = crypto::sha256_bytes(preimage);
+    uint8_t bytes[32] = {};
+    std::memcpy(bytes + 12, hash.data() + 12, 20);
+    return UInt256::loadBigEndian(bytes);
 }
 
-void VM::stackDup(int n) {
-    if (stack.size() < n) throw std::runtime_error("Stack underflow for DUP");
-    stackPush(stack[stack.size()-n]);
+std::vector<uint8_t> addressBytes(const UInt256& addr) {
+    uint8_t bytes[32];
+    addr.storeBigEndian(bytes);
+    return std::vector<uint8_t>(bytes + 12, bytes + 32);
+}
+
+// CREATE: from the creator and its nonce
+UInt256 createAddress(const UInt256& creator, uint64_t nonce) {
+    std::vector<uint8_t> preimage = addressBytes(creator);
+    for (int shift = 56; shift >= 0; shift -= 8) preimage.push_back((uint8_t)(nonce >> shift));
+    return addressFromPreimage(preimage);
+}
+
+// CREATE2: from the creator, a salt and the init code, so it is known before deployment
+UInt256 create2Address(const UInt256& creator, const UInt256& salt, const uint8_t* initCode, size_t size) {
+    std::vector<uint8_t> preimage = {0xff};
+    std::vector<uint8_t> creatorBytes = addressBytes(creator);
+    preimage.insert(preimage.end(), creatorBytes.begin(), creatorBytes.end());
+    preimage.resize(preimage.size() + 32);
+    salt.storeBigEndian(preimage.data() + preimage.size() - 32);
+    Hash codeHash = crypto::sha256_bytes(initCode, size);
+    preimage.insert(preimage.end(), codeHash.begin(), codeHash.end());
+    return addressFromPreimage(preimage);
 }
 
-bool VM::consumeGas(uint64_t amount) {
-    if (gasRemaining < amount) {
-        return false;
-    }
-    gasRemaining -= amount;
-    return true;
 }
 
 // Simplified memory expansion cost model (linear for MVP)
-void VM::expandMemory(uint64_t offset, uint64_t size) {
+bool VM::expandMemory(uint64_t offset, uint64_t size) {
+    if (size == 0) return true; // Empty ranges touch no memory, wherever they point
+    // Far beyond what any gas limit pays for, and keeps offset + size from overflowing
+    if (offset > MAX_MEMORY_SIZE || size > MAX_MEMORY_SIZE) return false;
     uint64_t required = offset + size;
-    if (required > memory.size()) {
+    if (required > memorySize) {
         // Round up to word size (32 bytes)
         uint64_t newSize = (required + 31) / 32 * 32;
-        uint64_t expansion = newSize - memory.size();
+        uint64_t expansion = newSize - memorySize;
         
         // Gas cost for memory: 3 per word + quadratic. 
         // Simplified: 3 per word
         uint64_t cost = (expansion / 32) * 3;
-        if (!consumeGas(cost)) throw std::runtime_error("Out of gas (memory expansion)");
+        if (!consumeGas(cost)) return false;
         
-        memory.resize(newSize, 0);
+        // The last callee's output sits where this frame grows into
+        if (returnDataInArena) {
+            returnBuffer.assign(returnData(), returnData() + returnDataSize);
+            returnDataInArena = false;
+            arena->popFrame(memoryBase + memorySize);
+        }
+        arena->grow(memoryBase, newSize);
+        memorySize = newSize;
     }
+    return true;
 }
 
-void VM::memStore(uint64_t offset, const UInt256& val) {
-    expandMemory(offset, 32);
-    auto bytes = val.toBigEndianBytes();
-    std::copy(bytes.begin(), bytes.end(), memory.begin() + offset);
+bool VM::expandForCopy(uint64_t offset, uint64_t size) {
+    return expandMemory(offset, size) && consumeGas(GAS_COST_COPY_WORD * ((size + 31) / 32));
 }
 
-void VM::memStore8(uint64_t offset, uint8_t val) {
-    expandMemory(offset, 1);
-    memory[offset] = val;
+void VM::clearReturnData() {
+    if (returnDataInArena) arena->popFrame(memoryBase + memorySize);
+    returnDataInArena = false;
+    returnDataSize = 0;
 }
 
-UInt256 VM::memLoad(uint64_t offset) {
-    expandMemory(offset, 32);
-    std::vector<uint8_t> bytes(32);
-    std::copy(memory.begin() + offset, memory.begin() + offset + 32, bytes.begin());
-    return UInt256::fromBigEndianBytes(bytes);
+std::shared_ptr<const CodeAnalysis> VM::loadCode(const UInt256& addr) {
+    if (!storage) return nullptr;
+    std::optional<Hash> codeHash = analyses ? storage->getCodeHash(addr) : std::nullopt;
+    if (codeHash) {
+        if (auto cached = analyses->find(*codeHash)) return cached->codeSize > 0 ? cached : nullptr;
+    }
+    std::vector<uint8_t> code = storage->getCode(addr);
+    if (code.empty()) return nullptr;
+    if (codeHash) return analyses->get(*codeHash, code);
+    return std::make_shared<const CodeAnalysis>(CodeAnalysis::analyze(code.data(), code.size()));
 }
 
+void VM::revertJournal(size_t size) {
+    while (journal.size() > size) {
+        const JournalEntry& entry = journal.back();
+        switch (entry.kind) {
+            case JournalEntry::Kind::STORAGE: storage->setStorage(entry.address, entry.key, entry.previous); break;
+            case JournalEntry::Kind::CODE: storage->setCode(entry.address, {}); break;
+            case JournalEntry::Kind::NONCE: storage->setNonce(entry.address, entry.previous.toUint64()); break;
+        }
+        journal.pop_back();
+    }
+}
+
+// The interpreter jumps straight from one handler to the next through a
+// table of label addresses where the compiler supports it (GCC, Clang), and
+// falls back to a switch in a loop elsewhere. Handlers end with NEXT(), or
+// HALT() with the status to stop the current frame with; nothing in the loop
+// throws.
+#if defined(__GNUC__)
+#define VM_COMPUTED_GOTO 1
+#define HANDLER(name) h_##name
+#define DISPATCH() goto *dispatchTable[(size_t)ip->handler]
+#define INTERPRETER_BEGIN DISPATCH();
+#define INTERPRETER_END
+#else
+#define HANDLER(name) case Handler::name
+#define DISPATCH() continue
+#define INTERPRETER_BEGIN for (;;) switch (ip->handler) {
+#define INTERPRETER_END }
+#endif
+#define NEXT() do { ++ip; DISPATCH(); } while (0)
+#define HALT(why) do { status = (why); goto end_frame; } while (0)
+
 ExecutionResult VM::execute(const std::vector<uint8_t>& code, const CallContext& ctx) {
-    stack.clear();
-    memory.clear();
+    using Handler = CodeAnalysis::Handler;
+
     currentLogs.clear(); // Clear logs from previous run if any
-    pc = 0;
+    journal.clear();
+    callFrames.clear();
     gasRemaining = ctx.gasLimit;
-    reverted = false;
     
     ExecutionResult result;
-    result.success = true;
+    EVMStatus status = EVMStatus::SUCCESS;
+    std::string internalError;
+    size_t outputOffset = 0; // Output of the frame that halted, in the arena
+    size_t outputSize = 0;
     
-    // Jump table validation could happen here (for JUMPDEST analysis)
-    // Production EVM pre-scans code for JUMPDESTs. Skipped for brevity.
-
-    try {
-        while (pc < code.size()) {
-            uint8_t op = code[pc];
-            
-            // Basic gas cost
-            if (!consumeGas(GAS_COST_BASE)) throw std::runtime_error("Out of gas2");
-            
-            pc++;
-
-            switch (static_cast<OpCode>(op)) {
-                case OpCode::STOP: 
-                    goto end_execution;
-                
-                // Arithmetic
-                case OpCode::ADD: stackPush(stackPop() + stackPop()); break;
-                case OpCode::MUL: stackPush(stackPop() * stackPop()); break;
-                case OpCode::SUB: {
-                     UInt256 a = stackPop();
-                     UInt256 b = stackPop();
-                     stackPush(a - b); 
-                     break;
-                }
-                case OpCode::DIV: {
-                    UInt256 b = stackPop();
-                    UInt256 a = stackPop();
-                    stackPush(a / b);
-                    break;
-                }
-                case OpCode::MOD: {
-                     UInt256 b = stackPop();
-                     UInt256 a = stackPop();
-                     stackPush(a % b);
-                     break;
-                }
-                // Bitwise
-                case OpCode::AND: stackPush(stackPop() & stackPop()); break;
-                case OpCode::OR: stackPush(stackPop() | stackPop()); break;
-                case OpCode::XOR: stackPush(stackPop() ^ stackPop()); break;
-                case OpCode::NOT: stackPush(~stackPop()); break;
-                
-                // Comparision
-                case OpCode::LT: {
-                    UInt256 b = stackPop();
-                    UInt256 a = stackPop();
-                    stackPush(a < b ? UInt256(1) : UInt256(0));
-                    break;
-                }
-                case OpCode::EQ: {
-                    UInt256 a = stackPop();
-                    UInt256 b = stackPop();
-                    stackPush(a == b ? UInt256(1) : UInt256(0));
-                    break;
+    // Jumps may only land on JUMPDESTs found by the analysis, never in PUSH data
+    std::shared_ptr<const CodeAnalysis> entryAnalysis;
+    if (analyses && ctx.codeHash) {
+        entryAnalysis = analyses->get(*ctx.codeHash, code);
+    } else {
+        entryAnalysis = std::make_shared<const CodeAnalysis>(CodeAnalysis::analyze(code.data(), code.size()));
+    }
+
+    // Each frame takes the stack for its depth and opens its memory after its
+    // caller's. Stack bounds and static gas are checked on entry to each basic
+    // block, so the handlers below touch the stack without checks.
+    FramePool& frames = FramePool::local();
+    arena = &frames.memory;
+    memoryBase = arena->pushFrame();
+    memorySize = 0;
+    returnDataInArena = false;
+    returnDataSize = 0;
+
+    CallFrame* frame = &callFrames.emplace_back();
+    frame->analysis = std::move(entryAnalysis);
+    frame->kind = ctx.creation ? CallKind::CREATE : CallKind::CALL;
+    frame->caller = ctx.caller;
+    frame->address = ctx.address;
+    frame->value = ctx.value;
+    frame->data = ctx.data.data();
+    frame->dataSize = ctx.data.size();
+    frame->bottom = frames.acquireStack();
+    frame->memoryBase = memoryBase;
+
+    const CodeAnalysis* analysis = frame->analysis.get();
+    UInt256* bottom = frame->bottom;
+    UInt256* top = bottom; // One past the top item
+    const CodeAnalysis::Instruction* ip = analysis->instructions.data();
+
+    // Arguments of a call or creation, popped by its handler for begin_call
+    struct CallRequest {
+        CallKind kind;
+        UInt256 gas;
+        UInt256 address;
+        UInt256 value; // Transferred; DELEGATECALL keeps its caller's instead
+        UInt256 salt;
+        uint64_t argsOffset; // Init code for creations
+        uint64_t argsSize;
+        uint64_t retOffset;
+        uint64_t retSize;
+    } call;
+
+#ifdef VM_COMPUTED_GOTO
+    static const void* const dispatchTable[] = {
+        &&h_BEGIN_BLOCK,
+        &&h_STOP, &&h_ADD, &&h_MUL, &&h_SUB, &&h_DIV, &&h_MOD, &&h_AND, &&h_OR, &&h_XOR, &&h_NOT,
+        &&h_LT, &&h_EQ, &&h_ISZERO,
+        &&h_POP, &&h_MLOAD, &&h_MSTORE, &&h_MSTORE8, &&h_SLOAD, &&h_SSTORE, &&h_JUMP, &&h_JUMPI,
+        &&h_JUMPDEST,
+        &&h_PUSH, &&h_DUP, &&h_SWAP, &&h_LOG,
+        &&h_ADDRESS, &&h_CALLER, &&h_CALLVALUE, &&h_CALLDATALOAD, &&h_CALLDATASIZE, &&h_CALLDATACOPY,
+        &&h_CODESIZE, &&h_CODECOPY, &&h_RETURNDATASIZE, &&h_RETURNDATACOPY, &&h_GAS,
+        &&h_CREATE, &&h_CALL, &&h_RETURN, &&h_DELEGATECALL, &&h_CREATE2, &&h_STATICCALL,
+        &&h_REVERT, &&h_INVALID, &&h_UNDEFINED,
+    };
+    static_assert(sizeof(dispatchTable) / sizeof(dispatchTable[0]) == (size_t)Handler::COUNT);
+#endif
+
+    // Entry of the block starting at `dest`, or nullptr unless it is a JUMPDEST
+    auto jumpTarget = [&](const UInt256& dest) -> const CodeAnalysis::Instruction* {
+        uint64_t target = dest.toUint64();
+        if (UInt256(target) != dest || !analysis->isJumpDest(target)) return nullptr;
+        return &analysis->instructions[analysis->blockAt(target).entry];
+    };
+
+    // Runs until the outermost frame halts; each pass ends one frame
+    for (;;) {
+        try {
+            INTERPRETER_BEGIN
+
+            HANDLER(BEGIN_BLOCK): {
+                const CodeAnalysis::BasicBlock& block = analysis->blocks[ip->arg];
+                if (!consumeGas(block.gasCost)) HALT(EVMStatus::OUT_OF_GAS);
+                size_t height = top - bottom;
+                if (height < block.stackRequired) HALT(EVMStatus::STACK_UNDERFLOW);
+                if (height + block.stackGrowth > MAX_STACK_SIZE) HALT(EVMStatus::STACK_OVERFLOW);
+                NEXT();
+            }
+
+            HANDLER(STOP):
+                HALT(EVMStatus::SUCCESS);
+
+            // Arithmetic
+            HANDLER(ADD): top[-2] = top[-1] + top[-2]; --top; NEXT();
+            HANDLER(MUL): top[-2] = top[-1] * top[-2]; --top; NEXT();
+            HANDLER(SUB): top[-2] = top[-1] - top[-2]; --top; NEXT();
+            HANDLER(DIV): top[-2] = top[-2] / top[-1]; --top; NEXT();
+            HANDLER(MOD): top[-2] = top[-2] % top[-1]; --top; NEXT();
+
+            // Bitwise
+            HANDLER(AND): top[-2] = top[-1] & top[-2]; --top; NEXT();
+            HANDLER(OR): top[-2] = top[-1] | top[-2]; --top; NEXT();
+            HANDLER(XOR): top[-2] = top[-1] ^ top[-2]; --top; NEXT();
+            HANDLER(NOT): top[-1] = ~top[-1]; NEXT();
+
+            // Comparison
+            HANDLER(LT): top[-2] = top[-2] < top[-1] ? UInt256(1) : UInt256(0); --top; NEXT();
+            HANDLER(EQ): top[-2] = top[-1] == top[-2] ? UInt256(1) : UInt256(0); --top; NEXT();
+            HANDLER(ISZERO): top[-1] = top[-1] == UInt256(0) ? UInt256(1) : UInt256(0); NEXT();
+
+            // Stack
+            HANDLER(POP): --top; NEXT();
+            HANDLER(PUSH): *top++ = analysis->pushValues[ip->arg]; NEXT();
+            HANDLER(DUP): *top = top[-(int)ip->n]; ++top; NEXT();
+            HANDLER(SWAP): std::swap(top[-1], top[-1 - (int)ip->n]); NEXT();
+
+            // Memory
+            HANDLER(MLOAD): {
+                uint64_t offset = saturate(top[-1]);
+                if (!expandMemory(offset, 32)) HALT(EVMStatus::OUT_OF_GAS);
+                top[-1] = UInt256::loadBigEndian(mem() + offset);
+                NEXT();
+            }
+            HANDLER(MSTORE): {
+                uint64_t offset = saturate(top[-1]);
+                if (!expandMemory(offset, 32)) HALT(EVMStatus::OUT_OF_GAS);
+                top[-2].storeBigEndian(mem() + offset);
+                top -= 2;
+                NEXT();
+            }
+            HANDLER(MSTORE8): {
+                uint64_t offset = saturate(top[-1]);
+                if (!expandMemory(offset, 1)) HALT(EVMStatus::OUT_OF_GAS);
+                mem()[offset] = (uint8_t)top[-2].toUint64();
+                top -= 2;
+                NEXT();
+            }
+
+            // Storage
+            HANDLER(SLOAD): {
+                UInt256 val(0);
+                if (storage) {
+                    val = storage->getStorage(frame->address, top[-1]);
                 }
-                case OpCode::ISZERO: {
-                    UInt256 a = stackPop();
-                    stackPush(a == UInt256(0) ? UInt256(1) : UInt256(0));
-                    break;
+                top[-1] = val;
+                NEXT();
+            }
+            HANDLER(SSTORE): {
+                if (frame->isStatic) HALT(EVMStatus::STATIC_MODE_VIOLATION);
+                if (storage) {
+                    // Journaled, so a frame that fails can put the old value back
+                    journal.push_back({JournalEntry::Kind::STORAGE, frame->address, top[-1],
+                                       storage->getStorage(frame->address, top[-1])});
+                    storage->setStorage(frame->address, top[-1], top[-2]);
                 }
-                
-                // Stack
-                case OpCode::POP: stackPop(); break;
-                
-                // Memory
-                case OpCode::MLOAD: {
-                    UInt256 offset = stackPop();
-                    stackPush(memLoad(offset.toUint64()));
-                    break;
+                top -= 2;
+                NEXT();
+            }
+
+            // Flow
+            HANDLER(JUMP): {
+                --top;
+                ip = jumpTarget(*top);
+                if (!ip) HALT(EVMStatus::BAD_JUMP_DESTINATION);
+                DISPATCH();
+            }
+            HANDLER(JUMPI): {
+                top -= 2;
+                if (top[0] != UInt256(0)) {
+                    ip = jumpTarget(top[1]);
+                    if (!ip) HALT(EVMStatus::BAD_JUMP_DESTINATION);
+                    DISPATCH();
                 }
-                case OpCode::MSTORE: {
-                    UInt256 offset = stackPop();
-                    UInt256 val = stackPop();
-                    memStore(offset.toUint64(), val);
-                    break;
+                NEXT();
+            }
+            HANDLER(JUMPDEST): NEXT();
+
+            // Logs
+            HANDLER(LOG): {
+                if (frame->isStatic) HALT(EVMStatus::STATIC_MODE_VIOLATION);
+                uint8_t numTopics = ip->n;
+                uint64_t memOffset = saturate(top[-1]);
+                uint64_t len = saturate(top[-2]);
+                std::vector<UInt256> topics;
+                for (uint8_t i = 0; i < numTopics; ++i) {
+                    topics.push_back(top[-3 - i]);
                 }
-                case OpCode::MSTORE8: {
-                    UInt256 offset = stackPop();
-                     UInt256 val = stackPop();
-                     memStore8(offset.toUint64(), (uint8_t)val.toUint64());
-                     break;
+                top -= 2 + numTopics;
+
+                // 375 per log and per topic are static; the data is charged here,
+                // after the expansion has bounded len
+                if (!expandMemory(memOffset, len) || !consumeGas(GAS_COST_LOG_DATA * len)) {
+                    HALT(EVMStatus::OUT_OF_GAS);
                 }
                 
-                // Storage
-                case OpCode::SLOAD: {
-                    if (!consumeGas(GAS_COST_SLOAD)) throw std::runtime_error("Out of gas (SLOAD)");
-                    UInt256 key = stackPop();
-                    UInt256 val(0);
-                    if (storage) {
-                        val = storage->getStorage(ctx.address, key);
-                    }
-                    stackPush(val);
-                    break;
-                }
-                case OpCode::SSTORE: {
-                    if (!consumeGas(GAS_COST_SSTORE_SET)) throw std::runtime_error("Out of gas (SSTORE)");
-                    UInt256 key = stackPop();
-                    UInt256 val = stackPop();
-                    if (storage) {
-                        storage->setStorage(ctx.address, key, val);
-                    }
-                    break;
+                std::vector<uint8_t> data;
+                if (len > 0) {
+                    data.assign(mem() + memOffset, mem() + memOffset + len);
                 }
                 
-                // Flow
-                case OpCode::JUMP: {
-                    UInt256 dest = stackPop();
-                    uint64_t target = dest.toUint64();
-                    if (target >= code.size() || code[target] != (uint8_t)OpCode::JUMPDEST) {
-                        throw std::runtime_error("Invalid Jump Destination");
-                    }
-                    pc = target;
-                    break;
+                // Add to logs
+                currentLogs.push_back({frame->address, topics, data});
+                NEXT();
+            }
+
+            // Call context
+            HANDLER(ADDRESS): *top++ = frame->address; NEXT();
+            HANDLER(CALLER): *top++ = frame->caller; NEXT();
+            HANDLER(CALLVALUE): *top++ = frame->value; NEXT();
+            HANDLER(CALLDATALOAD): {
+                uint8_t word[32];
+                copyPadded(word, callData(*frame), frame->dataSize, saturate(top[-1]), 32);
+                top[-1] = UInt256::loadBigEndian(word);
+                NEXT();
+            }
+            HANDLER(CALLDATASIZE): *top++ = UInt256(frame->dataSize); NEXT();
+            HANDLER(CALLDATACOPY): {
+                // memOffset, dataOffset, size
+                uint64_t memOffset = saturate(top[-1]);
+                uint64_t dataOffset = saturate(top[-2]);
+                uint64_t size = saturate(top[-3]);
+                top -= 3;
+                if (!expandForCopy(memOffset, size)) HALT(EVMStatus::OUT_OF_GAS);
+                if (size > 0) copyPadded(mem() + memOffset, callData(*frame), frame->dataSize, dataOffset, size);
+                NEXT();
+            }
+            HANDLER(CODESIZE): *top++ = UInt256(analysis->codeSize); NEXT();
+            HANDLER(CODECOPY): {
+                uint64_t memOffset = saturate(top[-1]);
+                uint64_t codeOffset = saturate(top[-2]);
+                uint64_t size = saturate(top[-3]);
+                top -= 3;
+                if (!expandForCopy(memOffset, size)) HALT(EVMStatus::OUT_OF_GAS);
+                if (size > 0) copyPadded(mem() + memOffset, analysis->code.data(), analysis->codeSize, codeOffset, size);
+                NEXT();
+            }
+            HANDLER(RETURNDATASIZE): *top++ = UInt256(returnDataSize); NEXT();
+            HANDLER(RETURNDATACOPY): {
+                uint64_t memOffset = saturate(top[-1]);
+                uint64_t dataOffset = saturate(top[-2]);
+                uint64_t size = saturate(top[-3]);
+                top -= 3;
+                // Unlike call data, reading past the end is an error
+                if (dataOffset > returnDataSize || size > returnDataSize - dataOffset) {
+                    HALT(EVMStatus::RETURN_DATA_OUT_OF_BOUNDS);
                 }
-                case OpCode::JUMPI: {
-                    UInt256 dest = stackPop();
-                    UInt256 cond = stackPop();
-                    if (cond.toUint64() != 0) {
-                        uint64_t target = dest.toUint64();
-                        if (target >= code.size() || code[target] != (uint8_t)OpCode::JUMPDEST) {
-                            throw std::runtime_error("Invalid JUMPI Destination");
-                        }
-                        pc = target;
-                    }
-                    break;
+                if (!expandForCopy(memOffset, size)) HALT(EVMStatus::OUT_OF_GAS);
+                if (size > 0) std::memcpy(mem() + memOffset, returnData() + dataOffset, size);
+                NEXT();
+            }
+            HANDLER(GAS): *top++ = UInt256(gasRemaining); NEXT();
+
+            // Calls and creations
+            HANDLER(CALL): {
+                // gas, address, value, argsOffset, argsSize, retOffset, retSize
+                call = {CallKind::CALL, top[-1], top[-2], top[-3], UInt256(0),
+                        saturate(top[-4]), saturate(top[-5]), saturate(top[-6]), saturate(top[-7])};
+                top -= 7;
+                goto begin_call;
+            }
+            HANDLER(DELEGATECALL): {
+                // gas, address, argsOffset, argsSize, retOffset, retSize
+                call = {CallKind::DELEGATECALL, top[-1], top[-2], UInt256(0), UInt256(0),
+                        saturate(top[-3]), saturate(top[-4]), saturate(top[-5]), saturate(top[-6])};
+                top -= 6;
+                goto begin_call;
+            }
+            HANDLER(STATICCALL): {
+                call = {CallKind::STATICCALL, top[-1], top[-2], UInt256(0), UInt256(0),
+                        saturate(top[-3]), saturate(top[-4]), saturate(top[-5]), saturate(top[-6])};
+                top -= 6;
+                goto begin_call;
+            }
+            HANDLER(CREATE): {
+                // value, offset, size
+                call = {CallKind::CREATE, UInt256(0), UInt256(0), top[-1], UInt256(0),
+                        saturate(top[-2]), saturate(top[-3]), 0, 0};
+                top -= 3;
+                goto begin_call;
+            }
+            HANDLER(CREATE2): {
+                // value, offset, size, salt
+                call = {CallKind::CREATE2, UInt256(0), UInt256(0), top[-1], top[-4],
+                        saturate(top[-2]), saturate(top[-3]), 0, 0};
+                top -= 4;
+                goto begin_call;
+            }
+
+            HANDLER(RETURN): {
+                uint64_t offset = saturate(top[-1]);
+                uint64_t size = saturate(top[-2]);
+                if (!expandMemory(offset, size)) HALT(EVMStatus::OUT_OF_GAS);
+                outputOffset = memoryBase + offset;
+                outputSize = size;
+                HALT(EVMStatus::SUCCESS);
+            }
+            HANDLER(REVERT): {
+                // Like RETURN, but the frame's state changes are undone
+                uint64_t offset = saturate(top[-1]);
+                uint64_t size = saturate(top[-2]);
+                if (!expandMemory(offset, size)) HALT(EVMStatus::OUT_OF_GAS);
+                outputOffset = memoryBase + offset;
+                outputSize = size;
+                HALT(EVMStatus::REVERT);
+            }
+            HANDLER(INVALID):
+                HALT(EVMStatus::INVALID_INSTRUCTION);
+            HANDLER(UNDEFINED):
+                HALT(EVMStatus::UNDEFINED_INSTRUCTION);
+
+        begin_call: {
+                bool creation = call.kind == CallKind::CREATE || call.kind == CallKind::CREATE2;
+                // The input (init code for creations) and output ranges are paid for up front
+                if (!expandMemory(call.argsOffset, call.argsSize) || !expandMemory(call.retOffset, call.retSize)) {
+                    HALT(EVMStatus::OUT_OF_GAS);
                 }
-                case OpCode::JUMPDEST:
-                    consumeGas(GAS_COST_JUMPDEST);
-                    break;
-                    
-                // Push
-                case OpCode::PUSH1: {
-                    if (pc >= code.size()) throw std::runtime_error("PUSH1 OOB");
-                    stackPush(UInt256(code[pc]));
-                    pc++;
-                    break;
+                if (call.kind == CallKind::CREATE2 && !consumeGas(GAS_COST_HASH_WORD * ((call.argsSize + 31) / 32))) {
+                    HALT(EVMStatus::OUT_OF_GAS);
                 }
-                case OpCode::PUSH32: {
-                    if (pc + 32 > code.size()) throw std::runtime_error("PUSH32 OOB");
-                    std::vector<uint8_t> bytes(code.begin() + pc, code.begin() + pc + 32);
-                    stackPush(UInt256::fromBigEndianBytes(bytes));
-                    pc += 32;
-                    break;
+                if (frame->isStatic && (creation || call.value != UInt256(0))) {
+                    HALT(EVMStatus::STATIC_MODE_VIOLATION);
                 }
+                clearReturnData();
 
-                // Logs
-                case OpCode::LOG0:
-                case OpCode::LOG1:
-                case OpCode::LOG2:
-                case OpCode::LOG3:
-                case OpCode::LOG4: {
-                    uint8_t numTopics = (uint8_t)op - (uint8_t)OpCode::LOG0;
-                    UInt256 offset = stackPop();
-                    UInt256 size = stackPop();
-                    
-                    std::vector<UInt256> topics;
-                    for (uint8_t i = 0; i < numTopics; ++i) {
-                        topics.push_back(stackPop());
-                    }
-                    
-                    uint64_t memOffset = offset.toUint64();
-                    uint64_t len = size.toUint64();
-                    
-                    // Cost check: 375 + 8 * byte_size + 375 * numTopics
-                    uint64_t cost = 375 + 8 * len + 375 * numTopics;
-                    if (!consumeGas(cost)) throw std::runtime_error("Out of gas (LOG)");
-                    
-                    // Expand memory if needed
-                    expandMemory(memOffset, len);
-                    
-                    std::vector<uint8_t> data;
-                    if (len > 0) {
-                        data.assign(memory.begin() + memOffset, memory.begin() + memOffset + len);
-                    }
-                    
-                    // Add to logs
-                    currentLogs.push_back({ctx.address, topics, data});
-                    break;
-                }
-                
-                // Swap/Dup
-                case OpCode::DUP1: stackDup(1); break;
-                case OpCode::SWAP1: stackSwap(1); break;
-                
-                // Invalid
-                case OpCode::REVERT: {
-                     // EVM REVERT: pops offset and size, returns data from memory as revert reason
-                     UInt256 offset = stackPop();
-                     UInt256 size = stackPop();
-                     uint64_t off = offset.toUint64();
-                     uint64_t len = size.toUint64();
-                     
-                     std::string reason;
-                     if (len > 0 && off + len <= memory.size()) {
-                         // Skip first 4 bytes (function selector for Error(string)) + 64 bytes offset/length if present
-                         // Simplified: just take raw bytes as reason
-                         reason.assign(memory.begin() + off, memory.begin() + off + std::min(len, (uint64_t)256));
-                     }
-                     
-                     result.success = false;
-                     result.error = reason.empty() ? "REVERT" : "REVERT: " + reason;
-                     result.output.assign(memory.begin() + off, memory.begin() + off + std::min(len, (uint64_t)memory.size() - off));
-                     goto end_execution;
-                }
-                case OpCode::INVALID: {
-                    throw std::runtime_error("INVALID Opcode");
+                // All but one 64th of the gas left may be passed on
+                uint64_t available = gasRemaining - gasRemaining / 64;
+                uint64_t callGas = creation ? available : std::min(saturate(call.gas), available);
+
+                // Calls past the depth limit fail, as does anything carrying value:
+                // native balances live outside the VM, so contracts cannot spend them
+                if (callFrames.size() > MAX_CALL_DEPTH || call.value != UInt256(0) || (creation && !storage)) {
+                    *top++ = UInt256(0);
+                    NEXT();
                 }
-                
-                case OpCode::STATICCALL: {
-                    // Stack: gas, addr, argsOffset, argsSize, retOffset, retSize
-                    UInt256 gas = stackPop();
-                    UInt256 addr = stackPop();
-                    UInt256 argsOff = stackPop();
-                    UInt256 argsSize = stackPop();
-                    UInt256 retOff = stackPop();
-                    UInt256 retSize = stackPop();
-                    
-                    // Consume Gas (Simplified)
-                    if (!consumeGas(700)) throw std::runtime_error("Out of gas (STATICCALL)"); // Base cost
-                    
-                    // Prepare Input
-                    expandMemory(argsOff.toUint64(), argsSize.toUint64());
+
+                uint64_t id = call.address.toUint64();
+                if (!creation && UInt256(id) == call.address && id > 0 && id < 100) {
                     std::vector<uint8_t> input;
-                    if (argsSize.toUint64() > 0) {
-                        input.resize(argsSize.toUint64());
-                        std::copy(memory.begin() + argsOff.toUint64(), 
-                                  memory.begin() + argsOff.toUint64() + argsSize.toUint64(), 
-                                  input.begin());
-                    }
-                    
-                    std::vector<uint8_t> output;
+                    if (call.argsSize > 0) input.assign(mem() + call.argsOffset, mem() + call.argsOffset + call.argsSize);
                     uint64_t precompileGas = 0;
-                    bool success = false;
-                    
-                    // Check Precompile
-                    if (addr.toUint64() > 0 && addr.toUint64() < 100) {
-                        success = executePrecompile(addr, input, output, precompileGas);
-                        if (!consumeGas(precompileGas)) throw std::runtime_error("Out of gas (Precompile)");
-                    } else {
-                        // Internal contract call - execute target contract code
-                        // In production, this would load code from storage, create sub-context, and execute
-                        // For now, we mark success if address is non-zero (contract exists check would go here)
-                        if (storage != nullptr) {
-                            UInt256 storedCode = storage->getStorage(addr, UInt256(0)); // Check if contract exists
-                            if (storedCode != UInt256(0)) {
-                                // Contract exists, execution would happen here
-                                // For this iteration, return success with empty output
-                                success = true;
-                            }
-                        }
-                    }
-                    
+                    returnBuffer.clear();
+                    bool known = executePrecompile(call.address, input, returnBuffer, precompileGas);
+                    bool success = known && precompileGas <= callGas;
+                    if (known) gasRemaining -= std::min(precompileGas, callGas);
                     if (success) {
-                        stackPush(UInt256(1)); // Success flag on stack
-                        
-                        // Write output to memory
-                        if (retSize.toUint64() > 0) {
-                            expandMemory(retOff.toUint64(), retSize.toUint64());
-                            size_t copyLen = std::min((size_t)retSize.toUint64(), output.size());
-                            std::copy(output.begin(), output.begin() + copyLen, memory.begin() + retOff.toUint64());
-                            // Zero pad rest?
-                            if (copyLen < retSize.toUint64()) {
-                                std::fill(memory.begin() + retOff.toUint64() + copyLen, 
-                                          memory.begin() + retOff.toUint64() + retSize.toUint64(), 0);
-                            }
-                        }
-                    } else {
-                         stackPush(UInt256(0));
+                        returnDataSize = returnBuffer.size();
+                        size_t copyLen = std::min<uint64_t>(call.retSize, returnDataSize);
+                        if (copyLen > 0) std::memcpy(mem() + call.retOffset, returnBuffer.data(), copyLen);
                     }
-                    break;
+                    *top++ = UInt256(success ? 1 : 0);
+                    NEXT();
                 }
-                
-                default:
-                    // If between PUSH1 and PUSH32
-                    if (op >= 0x60 && op <= 0x7F) {
-                        int size = op - 0x5F;
-                        if (pc + size > code.size()) throw std::runtime_error("PUSH OOB");
-                        std::vector<uint8_t> slice(code.begin() + pc, code.begin() + pc + size);
-                        stackPush(UInt256::fromBigEndianBytes(slice));
-                        pc += size;
-                    } else if (op >= 0x80 && op <= 0x8F) {
-                        stackDup(op - 0x80 + 1);
-                    } else if (op >= 0x90 && op <= 0x9F) {
-                        stackSwap(op - 0x90 + 1);
+
+                std::shared_ptr<const CodeAnalysis> calleeCode;
+                UInt256 calleeAddress = call.address;
+                if (creation) {
+                    const uint8_t* initCode = mem() + call.argsOffset;
+                    if (call.kind == CallKind::CREATE) {
+                        uint64_t nonce = storage->getNonce(frame->address);
+                        journal.push_back({JournalEntry::Kind::NONCE, frame->address, UInt256(0), UInt256(nonce)});
+                        storage->setNonce(frame->address, nonce + 1);
+                        calleeAddress = createAddress(frame->address, nonce);
                     } else {
-                        throw std::runtime_error("Unknown Opcode: " + std::to_string(op));
+                        calleeAddress = create2Address(frame->address, call.salt, initCode, call.argsSize);
                     }
-                    break;
+                    if (!storage->getCode(calleeAddress).empty()) {
+                        // Address taken: the gas offered is lost
+                        gasRemaining -= callGas;
+                        *top++ = UInt256(0);
+                        NEXT();
+                    }
+                    calleeCode = std::make_shared<const CodeAnalysis>(CodeAnalysis::analyze(initCode, call.argsSize));
+                } else {
+                    calleeCode = loadCode(call.address);
+                    if (!calleeCode) {
+                        // Nothing to run: succeeds with no output
+                        *top++ = UInt256(1);
+                        NEXT();
+                    }
+                }
+
+                // Suspend this frame and enter the callee
+                UInt256* calleeStack = frames.acquireStack();
+                frame->ip = ip + 1;
+                frame->top = top;
+                frame->memorySize = memorySize;
+                frame->gasRemaining = gasRemaining - callGas;
+                frame->retOffset = call.retOffset;
+                frame->retSize = call.retSize;
+                bool isStatic = frame->isStatic || call.kind == CallKind::STATICCALL;
+                bool delegated = call.kind == CallKind::DELEGATECALL;
+                UInt256 caller = delegated ? frame->caller : frame->address;
+                UInt256 value = delegated ? frame->value : call.value;
+                UInt256 address = delegated ? frame->address : calleeAddress;
+                size_t dataOffset = memoryBase + call.argsOffset;
+
+                frame = &callFrames.emplace_back();
+                frame->analysis = std::move(calleeCode);
+                frame->kind = call.kind;
+                frame->isStatic = isStatic;
+                frame->caller = caller;
+                frame->address = address;
+                frame->value = value;
+                frame->dataOffset = dataOffset;
+                frame->dataSize = creation ? 0 : call.argsSize;
+                frame->bottom = calleeStack;
+                frame->memoryBase = memoryBase = arena->pushFrame();
+                frame->journalSize = journal.size();
+                frame->logCount = currentLogs.size();
+                memorySize = 0;
+                gasRemaining = callGas;
+
+                analysis = frame->analysis.get();
+                bottom = top = calleeStack;
+                ip = analysis->instructions.data();
+                DISPATCH();
+            }
+
+            INTERPRETER_END
+        } catch (const std::exception& e) {
+            status = EVMStatus::INTERNAL_ERROR;
+            internalError = e.what();
+        }
+
+    end_frame:
+        if (status != EVMStatus::SUCCESS && status != EVMStatus::REVERT) {
+            // Exceptional halts consume all of the frame's gas, however far the block got
+            gasRemaining = 0;
+            outputSize = 0;
+        }
+        CallFrame& callee = callFrames.back();
+        bool creation = callee.kind == CallKind::CREATE || callee.kind == CallKind::CREATE2;
+        if (status == EVMStatus::SUCCESS && creation) {
+            // The output is the new contract's code, paid for per byte
+            if (outputSize > MAX_CODE_SIZE || !consumeGas(GAS_COST_CODE_DEPOSIT * outputSize)) {
+                status = EVMStatus::OUT_OF_GAS;
+                gasRemaining = 0;
+                outputSize = 0;
             }
         }
-    } catch (const std::exception& e) {
-        result.success = false;
-        result.error = e.what();
+        if (status == EVMStatus::INTERNAL_ERROR) {
+            // The backend failed, not the code, so no caller may carry on as if
+            // its callee had merely failed: the whole execution stops here
+            while (callFrames.size() > 1) {
+                frames.releaseStack();
+                callFrames.pop_back();
+            }
+            bottom = top = callFrames.front().bottom;
+            break;
+        }
+        if (callFrames.size() == 1) break;
+
+        // Back to the caller, with the callee's outcome on its stack
+        if (status == EVMStatus::SUCCESS && creation) {
+            const uint8_t* deployed = arena->at(outputOffset);
+            journal.push_back({JournalEntry::Kind::CODE, callee.address, UInt256(0), UInt256(0)});
+            storage->setCode(callee.address, std::vector<uint8_t>(deployed, deployed + outputSize));
+        }
+        bool succeeded = status == EVMStatus::SUCCESS;
+        if (!succeeded) {
+            revertJournal(callee.journalSize);
+            currentLogs.erase(currentLogs.begin() + callee.logCount, currentLogs.end());
+        }
+        UInt256 outcome = creation ? (succeeded ? callee.address : UInt256(0)) : UInt256(succeeded ? 1 : 0);
+        // A creation's code is not return data; a call's output, reverted or not, is
+        bool keepOutput = outputSize > 0 && !(creation && succeeded);
+        uint64_t gasLeft = gasRemaining;
+        frames.releaseStack();
+        callFrames.pop_back();
+
+        frame = &callFrames.back();
+        analysis = frame->analysis.get();
+        bottom = frame->bottom;
+        top = frame->top;
+        ip = frame->ip;
+        memoryBase = frame->memoryBase;
+        memorySize = frame->memorySize;
+        gasRemaining = frame->gasRemaining + gasLeft;
+
+        if (keepOutput) {
+            // Left where the callee wrote it, past the caller's memory
+            returnDataOffset = outputOffset;
+            returnDataSize = outputSize;
+            returnDataInArena = true;
+            size_t copyLen = creation ? 0 : std::min<uint64_t>(frame->retSize, outputSize);
+            if (copyLen > 0) std::memcpy(mem() + frame->retOffset, arena->at(outputOffset), copyLen);
+        } else {
+            arena->popFrame(memoryBase + memorySize);
+            returnDataSize = 0;
+        }
+        *top++ = outcome;
+        status = EVMStatus::SUCCESS;
+        outputSize = 0;
     }
 
-end_execution:
+    result.status = status;
+    result.success = status == EVMStatus::SUCCESS;
+    if (!result.success) {
+        revertJournal(0);
+        currentLogs.clear();
+    }
+    if (outputSize > 0) result.output.assign(arena->at(outputOffset), arena->at(outputOffset) + outputSize);
+    if (status == EVMStatus::REVERT) {
+        // Simplified: the raw revert data as the reason, rather than a decoded Error(string)
+        size_t reasonSize = std::min<size_t>(result.output.size(), 256);
+        result.error = reasonSize ? "REVERT: " + std::string(result.output.begin(), result.output.begin() + reasonSize)
+                                  : "REVERT";
+    } else if (status != EVMStatus::SUCCESS) {
+        result.error = toString(status);
+        if (status == EVMStatus::UNDEFINED_INSTRUCTION) result.error += ": " + std::to_string(ip->n);
+        if (status == EVMStatus::INTERNAL_ERROR) result.error += ": " + internalError;
+    }
+    stackTop = top > bottom ? top[-1] : UInt256(0);
+    arena->popFrame(callFrames.front().memoryBase);
+    frames.releaseStack();
+    frames.trim();
+    callFrames.clear();
     result.gasUsed = ctx.gasLimit - gasRemaining;
     result.logs = currentLogs;
     return result;
 }
 
+#undef VM_COMPUTED_GOTO
+#undef HANDLER
+#undef DISPATCH
+#undef INTERPRETER_BEGIN
+#undef INTERPRETER_END
+#undef NEXT
+#undef HALT
+
 bool VM::executePrecompile(const UInt256& addr, const std::vector<uint8_t>& input, std::vector<uint8_t>& output, uint64_t& gasUsed) {
     uint64_t id = addr.toUint64();
     if (id == 9) {
@@ -420,38 +724,38 @@ bool VM::executePrecompile(const UInt256& addr, const std::vector<uint8_t>& inpu
         
         // Parse A (G1 point: x, y)
         G1Point a;
-        a.x = UInt256::fromBigEndianBytes(std::vector<uint8_t>(input.begin() + offset, input.begin() + offset + 32));
+        a.x = UInt256::loadBigEndian(input.data() + offset);
         offset += 32;
-        a.y = UInt256::fromBigEndianBytes(std::vector<uint8_t>(input.begin() + offset, input.begin() + offset + 32));
+        a.y = UInt256::loadBigEndian(input.data() + offset);
         offset += 32;
         
         // Parse B (G2 point: x0, x1, y0, y1)
         G2Point b;
-        b.x0 = UInt256::fromBigEndianBytes(std::vector<uint8_t>(input.begin() + offset, input.begin() + offset + 32));
+        b.x0 = UInt256::loadBigEndian(input.data() + offset);
         offset += 32;
-        b.x1 = UInt256::fromBigEndianBytes(std::vector<uint8_t>(input.begin() + offset, input.begin() + offset + 32));
+        b.x1 = UInt256::loadBigEndian(input.data() + offset);
         offset += 32;
-        b.y0 = UInt256::fromBigEndianBytes(std::vector<uint8_t>(input.begin() + offset, input.begin() + offset + 32));
+        b.y0 = UInt256::loadBigEndian(input.data() + offset);
         offset += 32;
-        b.y1 = UInt256::fromBigEndianBytes(std::vector<uint8_t>(input.begin() + offset, input.begin() + offset + 32));
+        b.y1 = UInt256::loadBigEndian(input.data() + offset);
         offset += 32;
         
         // Parse C (G1 point)
         G1Point c;
-        c.x = UInt256::fromBigEndianBytes(std::vector<uint8_t>(input.begin() + offset, input.begin() + offset + 32));
+        c.x = UInt256::loadBigEndian(input.data() + offset);
         offset += 32;
-        c.y = UInt256::fromBigEndianBytes(std::vector<uint8_t>(input.begin() + offset, input.begin() + offset + 32));
+        c.y = UInt256::loadBigEndian(input.data() + offset);
         offset += 32;
         
         // Parse number of public inputs
-        UInt256 numInputsUint = UInt256::fromBigEndianBytes(std::vector<uint8_t>(input.begin() + offset, input.begin() + offset + 32));
+        UInt256 numInputsUint = UInt256::loadBigEndian(input.data() + offset);
         offset += 32;
         uint64_t numInputs = numInputsUint.toUint64();
         
         // Parse public inputs
         std::vector<UInt256> publicInputs;
         for (uint64_t i = 0; i < numInputs && offset + 32 <= input.size(); ++i) {
-            publicInputs.push_back(UInt256::fromBigEndianBytes(std::vector<uint8_t>(input.begin() + offset, input.begin() + offset + 32)));
+            publicInputs.push_back(UInt256::loadBigEndian(input.data() + offset));
             offset += 32;
         }
         
@@ -469,8 +773,7 @@ bool VM::executePrecompile(const UInt256& addr, const std::vector<uint8_t>& inpu
 }
 
 UInt256 VM::getStackTop() const {
-    if (stack.empty()) return UInt256(0);
-    return stack.back();
+    return stackTop;
 }
 
 
@@ -7,6 +7,8 @@
 #include "core/types.h"
 #include "util/uint256.h"
 #include "storage_interface.h"
+#include "code_analysis.h"
+#include "vm_memory.h"
 
 namespace aegen {
 
@@ -43,21 +45,61 @@ enum class OpCode : uint8_t {
     LOG0 = 0xA0, LOG1 = 0xA1, LOG2 = 0xA2, LOG3 = 0xA3, LOG4 = 0xA4,
     
     CREATE = 0xF0, CALL = 0xF1, CALLCODE = 0xF2, RETURN = 0xF3, 
-    DELEGATECALL = 0xF4, CREATE2 = 0xF5, STATICCALL = 0xF6, 
+    DELEGATECALL = 0xF4, CREATE2 = 0xF5, STATICCALL = 0xFA, 
     REVERT = 0xFD, INVALID = 0xFE, SELFDESTRUCT = 0xFF
 };
 
+constexpr uint64_t GAS_COST_JUMPDEST = 1;
+constexpr uint64_t GAS_COST_BASE = 2; // Simplified base cost
+constexpr uint64_t GAS_COST_VERYLOW = 3;
+constexpr uint64_t GAS_COST_LOW = 5;
+constexpr uint64_t GAS_COST_MID = 8;
+constexpr uint64_t GAS_COST_HIGH = 10;
+constexpr uint64_t GAS_COST_SSTORE_SET = 20000;
+constexpr uint64_t GAS_COST_SSTORE_RESET = 5000;
+constexpr uint64_t GAS_COST_SLOAD = 800;
+constexpr uint64_t GAS_COST_CREATE = 32000;
+constexpr uint64_t GAS_COST_CALL = 700;
+constexpr uint64_t GAS_COST_LOG = 375;
+constexpr uint64_t GAS_COST_LOG_TOPIC = 375;
+constexpr uint64_t GAS_COST_LOG_DATA = 8;
+constexpr uint64_t GAS_COST_COPY_WORD = 3;
+constexpr uint64_t GAS_COST_HASH_WORD = 6;
+constexpr uint64_t GAS_COST_CODE_DEPOSIT = 200; // Per byte of deployed code
+constexpr uint64_t MAX_MEMORY_SIZE = uint64_t(1) << 32;
+constexpr uint64_t MAX_CODE_SIZE = 24576;
+constexpr size_t MAX_CALL_DEPTH = 1024;
+
 struct LogEntry {
     UInt256 address;
     std::vector<UInt256> topics;
     std::vector<uint8_t> data;
 };
 
+// Why an execution halted. Everything but SUCCESS and REVERT is an
+// exceptional halt, which consumes all gas.
+enum class EVMStatus : uint8_t {
+    SUCCESS,
+    REVERT,
+    OUT_OF_GAS,
+    STACK_UNDERFLOW,
+    STACK_OVERFLOW,
+    BAD_JUMP_DESTINATION,
+    INVALID_INSTRUCTION,   // The designated INVALID opcode
+    UNDEFINED_INSTRUCTION,
+    STATIC_MODE_VIOLATION, // A state change inside a STATICCALL
+    RETURN_DATA_OUT_OF_BOUNDS,
+    INTERNAL_ERROR,        // An exception from a precompile or the storage backend; ends every frame
+};
+
+const char* toString(EVMStatus status);
+
 struct ExecutionResult {
-    bool success;
-    uint64_t gasUsed;
+    EVMStatus status = EVMStatus::SUCCESS;
+    bool success = true;
+    uint64_t gasUsed = 0;
     std::vector<uint8_t> output; 
-    std::string error;
+    std::string error; // Readable status, built once the execution has halted
     std::vector<LogEntry> logs; // captured logs
 };
 
@@ -67,41 +109,105 @@ struct CallContext {
     UInt256 value;
     std::vector<uint8_t> data; // Call data
     uint64_t gasLimit;
+    std::optional<Hash> codeHash; // Set for stored code, so its analysis can be cached
+    // Init code: the output is the code to deploy, limited to MAX_CODE_SIZE
+    // and paid for per byte as for CREATE; the caller stores it
+    bool creation = false;
 };
 
 class VM {
-    std::vector<UInt256> stack;
-    std::vector<uint8_t> memory;
+    enum class CallKind : uint8_t { CALL, DELEGATECALL, STATICCALL, CREATE, CREATE2 };
+
+    // One running call. The interpreter keeps the innermost frame's ip and
+    // stack top in locals and saves them here while that frame waits on a
+    // callee; its memory size and gas live in the members below meanwhile.
+    struct CallFrame {
+        std::shared_ptr<const CodeAnalysis> analysis;
+        CallKind kind = CallKind::CALL;
+        bool isStatic = false;
+        UInt256 caller;
+        UInt256 address;
+        UInt256 value;
+        // Call data: the transaction's for the outermost frame, otherwise a
+        // range of the caller's memory, which is left alone while the callee runs
+        const uint8_t* data = nullptr;
+        size_t dataOffset = 0; // In the arena, when data is null
+        size_t dataSize = 0;
+        UInt256* bottom = nullptr;
+        size_t memoryBase = 0;
+        size_t journalSize = 0; // Where to roll back to if the frame fails
+        size_t logCount = 0;
+        // Saved while a callee runs
+        const CodeAnalysis::Instruction* ip = nullptr; // Resume point
+        UInt256* top = nullptr;
+        size_t memorySize = 0;
+        uint64_t gasRemaining = 0; // Less the gas the callee was given
+        uint64_t retOffset = 0;    // Where the callee's output goes in this frame's memory
+        uint64_t retSize = 0;
+    };
+
+    // A state write, with what it overwrote
+    struct JournalEntry {
+        enum class Kind : uint8_t { STORAGE, CODE, NONCE } kind;
+        UInt256 address;
+        UInt256 key;
+        UInt256 previous; // The old value or nonce; CODE is only ever set where there was none
+    };
+
+    // Stack and memory come from the thread's FramePool; the innermost
+    // frame's memory is the memorySize bytes at memoryBase in its arena
+    MemoryArena* arena = nullptr;
+    size_t memoryBase = 0;
+    size_t memorySize = 0;
+    UInt256 stackTop; // As the last execution left it
     StorageInterface* storage; // Pointer to storage backend
+    CodeAnalysisCache* analyses; // Optional; code is analyzed per run without it
     
     // EVM Execution Context
-    uint64_t pc;
     uint64_t gasRemaining;
-    bool reverted;
-    std::vector<uint8_t> returnData;
+    std::vector<CallFrame> callFrames; // Outermost first
+    std::vector<JournalEntry> journal;
     std::vector<LogEntry> currentLogs;
-    
-    void stackPush(const UInt256& val);
-    UInt256 stackPop();
-    UInt256 stackPeek(int offset) const;
-    void stackSwap(int n);
-    void stackDup(int n);
+
+    // Output of the innermost frame's last call. A callee's output stays in
+    // its memory, left in the arena past the caller's, until the caller grows
+    // its own memory over it; only then is it moved to returnBuffer, which
+    // also holds precompile output.
+    size_t returnDataOffset = 0;
+    size_t returnDataSize = 0;
+    bool returnDataInArena = false;
+    std::vector<uint8_t> returnBuffer;
     
     // Memory Ops
-    void memStore(uint64_t offset, const UInt256& val);
-    void memStore8(uint64_t offset, uint8_t val);
-    UInt256 memLoad(uint64_t offset);
-    void expandMemory(uint64_t offset, uint64_t size);
+    uint8_t* mem() { return arena->at(memoryBase); }
+    // False when the expansion runs out of gas
+    bool expandMemory(uint64_t offset, uint64_t size);
+    // Expansion plus the per-word cost of copying `size` bytes in
+    bool expandForCopy(uint64_t offset, uint64_t size);
+
+    const uint8_t* callData(const CallFrame& frame) { return frame.data ? frame.data : arena->at(frame.dataOffset); }
+    const uint8_t* returnData() { return returnDataInArena ? arena->at(returnDataOffset) : returnBuffer.data(); }
+    void clearReturnData();
     
     // Gas
     bool consumeGas(uint64_t amount);
+
+    // Analysis of the code at `addr`, nullptr when it has none. Code whose
+    // analysis is cached is not read from storage at all.
+    std::shared_ptr<const CodeAnalysis> loadCode(const UInt256& addr);
+    // Undoes the journal back to its first `size` entries
+    void revertJournal(size_t size);
     
     // Precompile Logic
     bool executePrecompile(const UInt256& addr, const std::vector<uint8_t>& input, std::vector<uint8_t>& output, uint64_t& gasUsed);
 
 public:
-    VM(StorageInterface* storageBackend = nullptr) : storage(storageBackend) {}
+    VM(StorageInterface* storageBackend = nullptr, CodeAnalysisCache* analysisCache = nullptr)
+        : storage(storageBackend), analyses(analysisCache) {}
 
+    // Runs `code` as ctx.address. Calls and creations it makes run as nested
+    // frames; the state writes of a frame that fails, the outermost included,
+    // are undone.
     ExecutionResult execute(const std::vector<uint8_t>& code, const CallContext& ctx);
     
     // Accessors for testing
@@ -0,0 +1,103 @@
+#pragma once
+#include "util/uint256.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace aegen {
+
+constexpr size_t MAX_STACK_SIZE = 1024;
+// What a thread keeps between executions; anything a deeper or hungrier one
+// needed beyond this is freed when it ends
+constexpr size_t RETAINED_MEMORY = 1 << 20;
+constexpr size_t RETAINED_STACKS = 16;
+
+// One frame's operand stack, aligned so each word sits in one 32-byte line
+struct alignas(32) VMStack {
+    UInt256 items[MAX_STACK_SIZE];
+};
+
+/**
+ * MemoryArena - Memory of the active call frames in one reusable buffer
+ *
+ * Frames are laid out back to back and only the innermost one grows. The
+ * buffer keeps its capacity when frames end, up to what trim() allows, so
+ * once warm, executions do not allocate. Frames address memory by offset: growth may move the buffer.
+ */
+class MemoryArena {
+    std::unique_ptr<uint8_t[]> buffer;
+    size_t capacity = 0;
+    size_t end = 0; // End of the innermost frame
+
+public:
+    // Opens a frame after the innermost one; its memory starts at the returned offset
+    size_t pushFrame() { return end; }
+    // Closes the innermost frame, which started at `base`
+    void popFrame(size_t base) { end = base; }
+
+    // Zero-extends the innermost frame, which starts at `base`, to `size` bytes
+    void grow(size_t base, size_t size) {
+        size_t required = base + size;
+        if (required > capacity) {
+            size_t newCapacity = std::max(required, capacity * 2);
+            std::unique_ptr<uint8_t[]> larger(new uint8_t[newCapacity]);
+            if (end > 0) std::memcpy(larger.get(), buffer.get(), end);
+            buffer = std::move(larger);
+            capacity = newCapacity;
+        }
+        if (required > end) {
+            std::memset(buffer.get() + end, 0, required - end);
+            end = required;
+        }
+    }
+
+    uint8_t* at(size_t offset) { return buffer.get() + offset; }
+    size_t reserved() const { return capacity; }
+
+    // Shrinks an arena with no open frames back to at most maxCapacity bytes
+    void trim(size_t maxCapacity) {
+        if (end > 0 || capacity <= maxCapacity) return;
+        buffer.reset(maxCapacity > 0 ? new uint8_t[maxCapacity] : nullptr);
+        capacity = maxCapacity;
+    }
+};
+
+/**
+ * FramePool - Stacks and memory reused by every execution on one thread
+ *
+ * Stacks are handed out by call depth and allocated the first time a depth
+ * is reached. Frames are released in the reverse order they were acquired.
+ * trim() drops what one unusually deep or memory-hungry execution left behind.
+ */
+class FramePool {
+    std::vector<std::unique_ptr<VMStack>> stacks;
+    size_t depth = 0;
+
+public:
+    MemoryArena memory;
+
+    UInt256* acquireStack() {
+        if (depth == stacks.size()) stacks.push_back(std::make_unique<VMStack>());
+        return stacks[depth++]->items;
+    }
+    void releaseStack() { depth--; }
+    size_t stacksAllocated() const { return stacks.size(); }
+
+    // Frees what the last execution grew past the retained bounds; only
+    // between executions, when no frame is open
+    void trim() {
+        if (depth > 0) return;
+        if (stacks.size() > RETAINED_STACKS) stacks.resize(RETAINED_STACKS);
+        memory.trim(RETAINED_MEMORY);
+    }
+
+    // The calling thread's pool
+    static FramePool& local() {
+        static thread_local FramePool pool;
+        return pool;
+    }
+};
+
+}
@@ -7,10 +7,12 @@
 #include <sstream>
 #include <algorithm>
 #include <cstring>
+#include <cstdlib>
 #include "core/mempool.h"
 #include "db/rocksdb_wrapper.h"
 #include "db/state_manager.h"
 #include "db/block_store.h"
+#include "db/receipt_store.h"
 #include "exec/execution_engine.h"
 #include "consensus/leader.h"
 #include "consensus/pbft.h"
@@ -61,7 +63,10 @@ int main(int argc, char* argv[]) {
     RocksDBWrapper dbWrapper(dataDir + "/state");
     StateManager stateManager(dbWrapper);
     Mempool mempool;
+    RocksDBWrapper receiptsDb(dataDir + "/receipts");
+    ReceiptStore receiptStore(receiptsDb);
     ExecutionEngine execEngine(stateManager);
+    execEngine.setReceiptStore(&receiptStore);
     TokenManager tokenManager;
     BlockStore blockStore(dataDir);
     RPCServer rpcServer;
@@ -69,6 +74,7 @@ int main(int argc, char* argv[]) {
     RPCEndpoints endpoints(mempool, stateManager, tokenManager, rpcServer);
     endpoints.setBlockStore(&blockStore);
     endpoints.setExecutionEngine(&execEngine);
+    endpoints.setReceiptStore(&receiptStore);
     endpoints.registerAll();
 
     rpcServer.start(rpcPort);
@@ -99,26 +105,67 @@ int main(int argc, char* argv[]) {
     KeyPair leaderKeys = Wallet::generateKeyPair();
     Leader leader(mempool, execEngine, stateManager, leaderKeys, leaderKeys.address);
 
-    // Genesis
-    stateManager.setAccountState("alice", {0, 10000000});
-    stateManager.setAccountState("bob", {0, 10000000});
+    // Genesis (only on a fresh data dir; account state is persisted across restarts)
     TokenId genesisToken = tokenManager.createFungible("Aegen Token", "AE", 12, 1000000000, "k:genesis");
-    
-    Block genesisBlock;
-    genesisBlock.header.height = 0;
-    genesisBlock.header.timestamp = 1704351600;
-    genesisBlock.header.previousHash = {};
-    genesisBlock.header.stateRoot = stateManager.getRootHash();
-    genesisBlock.header.producer = "genesis";
-    Hash genesisHash = genesisBlock.calculateHash();
-    blockStore.addBlock(genesisBlock);
 
     // Chain State protected by mutex
     std::mutex chainMutex;
     uint64_t height = 1;
-    Hash prevHash = genesisHash;
+    Hash prevHash;
     uint64_t lastBlockTime = std::time(nullptr);
 
+    if (blockStore.getHeight() == 0) {
+        stateManager.setAccountState("alice", {0, 10000000});
+        stateManager.setAccountState("bob", {0, 10000000});
+
+        Block genesisBlock;
+        genesisBlock.header.height = 0;
+        genesisBlock.header.timestamp = 1704351600;
+        genesisBlock.header.previousHash = {};
+        genesisBlock.header.stateRoot = stateManager.getRootHash();
+        genesisBlock.header.producer = "genesis";
+        prevHash = genesisBlock.calculateHash();
+        // State first: genesis state cannot be replayed from the block, and
+        // without the block the next start simply writes it again
+        if (!stateManager.commit(genesisBlock.header.height) || !blockStore.addBlock(genesisBlock)) {
+            std::cerr << "[FATAL] Cannot persist the genesis block" << std::endl;
+            return 1;
+        }
+    } else {
+        // Resume from the stored tip. getHeight() reports 1 for a store holding
+        // only genesis, so fall back to block 0 when block 1 is missing.
+        uint64_t tipHeight = blockStore.getHeight();
+        BlockStore::HeaderInfo tip;
+        if (!blockStore.getHeader(tipHeight, tip)) {
+            if (tipHeight != 1 || !blockStore.getHeader(0, tip)) {
+                std::cerr << "[FATAL] Cannot read the tip block " << tipHeight << std::endl;
+                return 1;
+            }
+        }
+        tipHeight = tip.header.height;
+
+        // Blocks are stored before their state is committed; re-execute any the
+        // state missed because the node stopped in between
+        for (uint64_t h = stateManager.snapshot().height() + 1; h <= tipHeight; ++h) {
+            Block block = blockStore.getBlock(h);
+            if (block.header.height != h || !execEngine.applyBlock(block) ||
+                stateManager.getRootHash() != block.header.stateRoot) {
+                std::cerr << "[FATAL] Cannot replay block " << h << " onto the stored state" << std::endl;
+                return 1;
+            }
+            uint64_t gasUsed = 0;
+            if (!execEngine.commitBlockReceipts(block, gasUsed) || !stateManager.commit(h)) {
+                std::cerr << "[FATAL] Cannot persist the receipts and state of block " << h << std::endl;
+                return 1;
+            }
+            std::cout << "[INIT] Replayed block " << h << std::endl;
+        }
+
+        height = tipHeight + 1;
+        prevHash = Block::calculateHash(tip.header);
+        std::cout << "[INIT] Resuming at height " << height << std::endl;
+    }
+
     // ------------------------------------------------------------------------
     // Consensus Wiring
     // ------------------------------------------------------------------------
@@ -152,7 +199,16 @@ int main(int argc, char* argv[]) {
         if (block.header.height >= height) {
             std::cout << "[CONSENSUS] Finalized Block " << block.header.height << "!" << std::endl;
             
-            blockStore.addBlock(block); // Persistence
+            // Persistence: receipts, then the block, then its state, so a restart
+            // can replay whatever state is missing. A failed write leaves the
+            // databases refusing writes, so going on would only build blocks
+            // that are never stored.
+            uint64_t gasUsed = 0;
+            if (!execEngine.commitBlockReceipts(block, gasUsed) || !blockStore.addBlock(block, gasUsed) ||
+                !stateManager.commit(block.header.height)) {
+                std::cerr << "[FATAL] Cannot persist block " << block.header.height << ", stopping" << std::endl;
+                std::exit(1);
+            }
             
             // Execute batching
             if (block.transactions.size() > 0) {
@@ -2,15 +2,20 @@
 #include "util/crypto.h"
 #include "wallet/keypair.h"
 #include "exec/execution_engine.h"
+#include "db/coding.h"
 #include <sstream>
 #include <iostream>
 #include <iomanip>
 #include <ctime>
+#include <cerrno>
+#include <cstdlib>
 #include <vector>
 
 namespace aegen {
 
 std::string extractJsonValue(const std::string& json, const std::string& key);
+std::string extractPositionalParam(const std::string& json, size_t index);
+static std::string receiptToJson(const TransactionReceipt& receipt);
 
 RPCEndpoints::RPCEndpoints(Mempool& mp, StateManager& sm, TokenManager& tm, RPCServer& srv) 
     : mempool(mp), stateManager(sm), tokenManager(tm), server(srv) {}
@@ -37,6 +42,9 @@ void RPCEndpoints::registerAll() {
     server.registerEndpoint("eth_call", [this](const std::string& js) { return this->handleEthCall(js); });
     server.registerEndpoint("eth_getTransactionReceipt", [this](const std::string& js) { return this->handleEthGetTransactionReceipt(js); });
     server.registerEndpoint("eth_sendRawTransaction", [this](const std::string& js) { return this->handleEthSendRawTransaction(js); });
+    server.registerEndpoint("eth_getProof", [this](const std::string& js) { return this->handleEthGetProof(js); });
+    server.registerEndpoint("eth_getBlockReceipts", [this](const std::string& js) { return this->handleEthGetBlockReceipts(js); });
+    server.registerEndpoint("eth_getLogs", [this](const std::string& js) { return this->handleEthGetLogs(js); });
     
     // Pact fungible-v2 Token Operations
     server.registerEndpoint("createFungible", [this](const std::string& json) {
@@ -71,6 +79,12 @@ void RPCEndpoints::registerAll() {
     server.registerEndpoint("getTransaction", [this](const std::string& json) {
         return this->handleGetTransaction(json);
     });
+    server.registerEndpoint("getAddressTransactions", [this](const std::string& json) {
+        return this->handleGetAddressTransactions(json);
+    });
+    server.registerEndpoint("getContractStorage", [this](const std::string& json) {
+        return this->handleGetContractStorage(json);
+    });
     server.registerEndpoint("generateWallet", [this](const std::string& json) {
         return this->handleGenerateWallet(json);
     });
@@ -96,21 +110,68 @@ std::string RPCEndpoints::handleEthBlockNumber(const std::string& json) {
 }
 
 std::string RPCEndpoints::handleEthGetBalance(const std::string& json) {
-    // Hacky parse for array params or string param
-    std::string addr;
-    size_t xPos = json.find("0x");
-    if (xPos != std::string::npos) {
-        size_t end = json.find_first_of("\"' \t\n,]", xPos); 
-        if (end == std::string::npos) end = json.length();
-        addr = json.substr(xPos, end - xPos);
+    // Positional form: "params": ["<address>", "<blockTag>"]
+    std::string addr = extractPositionalParam(json, 0);
+    if (addr.empty()) {
+        // Hacky parse for string param
+        size_t xPos = json.find("0x");
+        if (xPos != std::string::npos) {
+            size_t end = json.find_first_of("\"' \t\n,]", xPos); 
+            if (end == std::string::npos) end = json.length();
+            addr = json.substr(xPos, end - xPos);
+        }
     }
-    
-    AccountState st = stateManager.getAccountState(addr);
+    std::string tag = extractJsonValue(json, "blockTag");
+    if (tag.empty()) tag = extractPositionalParam(json, 1);
+
+    std::optional<StateSnapshot> at;
+    if (!resolveBlockTag(tag, at)) return "{\"error\": \"State for block " + tag + " is not available\"}";
+    AccountState st = at ? at->getAccountState(addr) : stateManager.getAccountState(addr);
     std::stringstream ss;
     ss << "0x" << std::hex << st.balance;
     return "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":\"" + ss.str() + "\"}";
 }
 
+// Sparse Merkle proof for an account against the last committed state root.
+// accountProof lists sibling hashes from the root down; "leaf" is the node the
+// lookup ended on (absent account: null, or another account's leaf).
+std::string RPCEndpoints::handleEthGetProof(const std::string& json) {
+    std::string addr = extractJsonValue(json, "address");
+    if (addr.empty()) {
+        // Positional form: "params": ["<address>", [storageKeys], "<block>"]
+        size_t params = json.find("\"params\"");
+        size_t open = params == std::string::npos ? params : json.find('"', json.find('[', params));
+        if (open != std::string::npos) {
+            size_t close = json.find('"', open + 1);
+            if (close != std::string::npos) addr = json.substr(open + 1, close - open - 1);
+        }
+    }
+    if (addr.empty()) return "{\"error\": \"Missing address\"}";
+
+    StateManager::AccountProof proof = stateManager.getAccountProof(addr);
+
+    std::stringstream ss;
+    ss << "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":{";
+    ss << "\"address\":\"" << addr << "\",";
+    ss << "\"balance\":\"0x" << std::hex << proof.state.balance << "\",";
+    ss << "\"nonce\":\"0x" << proof.state.nonce << std::dec << "\",";
+    ss << "\"stateRoot\":\"0x" << crypto::to_hex(proof.stateRoot) << "\",";
+    ss << "\"accountProof\":[";
+    for (size_t i = 0; i < proof.proof.siblings.size(); ++i) {
+        if (i > 0) ss << ",";
+        ss << "\"0x" << crypto::to_hex(proof.proof.siblings[i]) << "\"";
+    }
+    ss << "],\"leaf\":";
+    if (proof.proof.hasLeaf) {
+        ss << "{\"key\":\"0x" << crypto::to_hex(proof.proof.leafKey) << "\",";
+        ss << "\"valueHash\":\"0x" << crypto::to_hex(proof.proof.leafValueHash) << "\"}";
+    } else {
+        ss << "null";
+    }
+    ss << "}}";
+    return ss.str();
+}
+
 std::string RPCEndpoints::handleEthCall(const std::string& json) {
     if (!executionEngine) return "{\"error\": \"Execution Engine not available\"}";
 
@@ -131,45 +192,27 @@ std::string RPCEndpoints::handleEthCall(const std::string& json) {
     tx.amount = 0; 
     tx.nonce = 0;
     tx.gasLimit = 1000000; 
-    
-    std::string res = executionEngine->simulateTransaction(tx);
+
+    // "params": [{call}, "<blockTag>"]
+    std::string tag = extractJsonValue(json, "blockTag");
+    if (tag.empty()) tag = extractPositionalParam(json, 1);
+    std::optional<StateSnapshot> at;
+    if (!resolveBlockTag(tag, at)) return "{\"error\": \"State for block " + tag + " is not available\"}";
+
+    std::string res = executionEngine->simulateTransaction(tx, at);
     return "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":\"0x" + res + "\"}";
 }
 
-std::string RPCEndpoints::handleEthGetTransactionReceipt(const std::string& json) {
-    if (!executionEngine) return "{\"error\": \"Execution Engine not available\"}";
-
-    // extractJsonValue hack
-    std::string hash = extractJsonValue(json, "hash");
-    if (hash.empty()) {
-         // Maybe passed as array parameter ["0x..."]
-         size_t xPos = json.find("0x");
-         if (xPos != std::string::npos) {
-            size_t end = json.find_first_of("\"' \t\n,]", xPos);
-            if (end == std::string::npos) end = json.length();
-            hash = json.substr(xPos, end - xPos);
-         }
-    }
-    
-    // Normalize hash (remove 0x)
-    if (hash.rfind("0x", 0) == 0) hash = hash.substr(2);
-    
-    auto receiptOpt = executionEngine->getReceipt(hash);
-    if (!receiptOpt) {
-        return "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":null}";
-    }
-    
-    const auto& receipt = *receiptOpt;
-    
+static std::string receiptToJson(const TransactionReceipt& receipt) {
     std::stringstream ss;
-    ss << "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":{";
+    ss << "{";
     ss << "\"transactionHash\": \"0x" << crypto::to_hex(receipt.transactionHash) << "\",";
     ss << "\"transactionIndex\": \"0x" << std::hex << receipt.transactionIndex << "\",";
-    ss << "\"blockHash\": \"0x0000000000000000000000000000000000000000000000000000000000000000\","; // Mock
+    ss << "\"blockHash\": \"0x" << crypto::to_hex(receipt.blockHash) << "\",";
     ss << "\"blockNumber\": \"0x" << std::hex << receipt.blockNumber << "\",";
     ss << "\"from\": \"" << receipt.from << "\",";
     ss << "\"to\": " << (receipt.to.empty() ? "null" : ("\"" + receipt.to + "\"")) << ",";
-    ss << "\"cumulativeGasUsed\": \"0x" << std::hex << receipt.gasUsed << "\",";
+    ss << "\"cumulativeGasUsed\": \"0x" << std::hex << receipt.cumulativeGasUsed << "\",";
     ss << "\"gasUsed\": \"0x" << std::hex << receipt.gasUsed << "\",";
     
     if (!receipt.contractAddress.empty()) {
@@ -197,11 +240,131 @@ std::string RPCEndpoints::handleEthGetTransactionReceipt(const std::string& json
     ss << "],";
     
     ss << "\"status\": \"" << (receipt.status ? "0x1" : "0x0") << "\"";
-    ss << "}}";
+    ss << "}";
     
     return ss.str();
 }
 
+std::string RPCEndpoints::handleEthGetTransactionReceipt(const std::string& json) {
+    if (!executionEngine) return "{\"error\": \"Execution Engine not available\"}";
+
+    // extractJsonValue hack
+    std::string hash = extractJsonValue(json, "hash");
+    if (hash.empty()) {
+         // Maybe passed as array parameter ["0x..."]
+         size_t xPos = json.find("0x");
+         if (xPos != std::string::npos) {
+            size_t end = json.find_first_of("\"' \t\n,]", xPos);
+            if (end == std::string::npos) end = json.length();
+            hash = json.substr(xPos, end - xPos);
+         }
+    }
+    
+    // Normalize hash (remove 0x)
+    if (hash.rfind("0x", 0) == 0) hash = hash.substr(2);
+    
+    auto receiptOpt = executionEngine->getReceipt(hash);
+    if (!receiptOpt) {
+        return "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":null}";
+    }
+    
+    return "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":" + receiptToJson(*receiptOpt) + "}";
+}
+
+std::string RPCEndpoints::handleEthGetBlockReceipts(const std::string& json) {
+    if (!receiptStore) return "{\"error\": \"Receipt store not available\"}";
+
+    std::string tag = extractPositionalParam(json, 0);
+    if (tag.empty()) tag = extractJsonValue(json, "block");
+    uint64_t height = 0;
+    if (!resolveBlockNumber(tag, height)) return "{\"error\": \"Invalid block: " + tag + "\"}";
+
+    // All receipts of a block are one record
+    std::vector<TransactionReceipt> receipts;
+    if (!receiptStore->getBlockReceipts(height, receipts)) {
+        return "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":null}";
+    }
+
+    std::string result = "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":[";
+    for (size_t i = 0; i < receipts.size(); ++i) {
+        if (i > 0) result += ",";
+        result += receiptToJson(receipts[i]);
+    }
+    return result + "]}";
+}
+
+
+// Topics of an eth_getLogs filter: "topics": ["0x..", null, ...]. Alternatives
+// ([a, b] in one position) are not supported.
+static bool parseTopicFilter(const std::string& json, std::vector<std::optional<Hash>>& topics) {
+    size_t pos = json.find("\"topics\"");
+    if (pos == std::string::npos) return true;
+    pos = json.find_first_not_of(" \t\n\r:", pos + 8);
+    if (pos == std::string::npos || json[pos] != '[') return false;
+
+    for (++pos; pos < json.length(); ++pos) {
+        char c = json[pos];
+        if (c == ']') return true;
+        if (c == '"') {
+            size_t end = json.find('"', pos + 1);
+            if (end == std::string::npos) return false;
+            std::string hex = json.substr(pos + 1, end - pos - 1);
+            if (hex.rfind("0x", 0) == 0) hex = hex.substr(2);
+            std::vector<uint8_t> bytes = crypto::from_hex(hex);
+            if (hex.size() != 64 || bytes.size() != sizeof(Hash)) return false;
+            Hash topic;
+            std::copy(bytes.begin(), bytes.end(), topic.begin());
+            topics.push_back(topic);
+            pos = end;
+        } else if (json.compare(pos, 4, "null") == 0) {
+            topics.push_back(std::nullopt);
+            pos += 3;
+        } else if (c != ',' && c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            return false;
+        }
+    }
+    return false;
+}
+
+std::string RPCEndpoints::handleEthGetLogs(const std::string& json) {
+    if (!receiptStore) return "{\"error\": \"Receipt store not available\"}";
+
+    ReceiptStore::LogFilter filter;
+    std::string fromTag = extractJsonValue(json, "fromBlock");
+    std::string toTag = extractJsonValue(json, "toBlock");
+    if (!resolveBlockNumber(fromTag, filter.fromBlock)) return "{\"error\": \"Invalid fromBlock: " + fromTag + "\"}";
+    if (!resolveBlockNumber(toTag, filter.toBlock)) return "{\"error\": \"Invalid toBlock: " + toTag + "\"}";
+
+    std::string address = extractJsonValue(json, "address");
+    if (!address.empty()) filter.address = address;
+    if (!parseTopicFilter(json, filter.topics)) return "{\"error\": \"Invalid topics\"}";
+
+    auto logs = receiptStore->getLogs(filter);
+
+    std::stringstream ss;
+    ss << "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":[";
+    for (size_t i = 0; i < logs.size(); ++i) {
+        if (i > 0) ss << ",";
+        const auto& entry = logs[i];
+        ss << "{";
+        ss << "\"address\": \"" << entry.log.address << "\",";
+        ss << "\"topics\": [";
+        for (size_t j = 0; j < entry.log.topics.size(); ++j) {
+            if (j > 0) ss << ",";
+            ss << "\"0x" << crypto::to_hex(entry.log.topics[j]) << "\"";
+        }
+        ss << "],";
+        ss << "\"data\": \"0x" << crypto::to_hex(entry.log.data) << "\",";
+        ss << "\"blockNumber\": \"0x" << std::hex << entry.blockNumber << "\",";
+        ss << "\"blockHash\": \"0x" << crypto::to_hex(entry.blockHash) << "\",";
+        ss << "\"transactionHash\": \"0x" << crypto::to_hex(entry.transactionHash) << "\",";
+        ss << "\"transactionIndex\": \"0x" << std::hex << entry.transactionIndex << "\",";
+        ss << "\"logIndex\": \"0x" << std::hex << entry.logIndex << "\"";
+        ss << "}";
+    }
+    ss << "]}";
+    return ss.str();
+}
 
 std::string RPCEndpoints::handleEthSendRawTransaction(const std::string& json) {
     // Expected: params: ["0xHEX_DATA"]
@@ -234,13 +397,15 @@ std::string RPCEndpoints::handleEthSendRawTransaction(const std::string& json) {
         Bytes txData = crypto::from_hex(rawHex);
         Transaction tx = Transaction::deserialize(txData);
         
-        // Validation via ExecutionEngine
+        // Validation via ExecutionEngine; the signature result is cached for block building
         if (!executionEngine || !executionEngine->validateTransaction(tx)) {
              return "{\"error\": \"Transaction validation failed\"}";
         }
         
         // Add to mempool
-        mempool.add(tx);
+        if (!mempool.add(tx)) {
+             return "{\"error\": \"Transaction rejected by mempool (duplicate, underpriced or pool full)\"}";
+        }
         return "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":\"0x" + crypto::to_hex(tx.hash) + "\"}";
     } catch (const std::exception& e) {
         return "{\"error\": \"Deserialization or execution error: " + std::string(e.what()) + "\"}";
@@ -293,6 +458,73 @@ std::string extractJsonValue(const std::string& json, const std::string& key) {
     return json.substr(valStart, valEnd - valStart);
 }
 
+// The index-th element of a positional "params": [...] array if it is a string.
+// Objects and arrays count as elements but yield "".
+std::string extractPositionalParam(const std::string& json, size_t index) {
+    size_t pos = json.find("\"params\"");
+    if (pos == std::string::npos) return "";
+    pos = json.find_first_not_of(" \t\n\r:", pos + 8);
+    if (pos == std::string::npos || json[pos] != '[') return "";
+
+    size_t element = 0;
+    int depth = 0;
+    for (++pos; pos < json.length(); ++pos) {
+        char c = json[pos];
+        if (c == '"') {
+            size_t end = json.find('"', pos + 1);
+            if (end == std::string::npos) return "";
+            if (depth == 0 && element == index) return json.substr(pos + 1, end - pos - 1);
+            pos = end;
+        } else if (c == '{' || c == '[') {
+            depth++;
+        } else if (c == '}' || c == ']') {
+            if (depth-- == 0) return "";
+        } else if (c == ',' && depth == 0) {
+            element++;
+        }
+    }
+    return "";
+}
+
+// Resolves a block tag to the state it names: "latest" (also the default) is
+// the last committed block, "earliest" block 0, a decimal or 0x number that
+// block while it is still retained. "pending" leaves `at` empty, meaning the
+// live state of the block being executed. Returns false for unknown tags and
+// heights no longer retained.
+bool RPCEndpoints::resolveBlockTag(const std::string& tag, std::optional<StateSnapshot>& at) {
+    at.reset();
+    if (tag == "pending") return true;
+    if (tag.empty() || tag == "latest" || tag == "safe" || tag == "finalized") {
+        at = stateManager.snapshot();
+        return true;
+    }
+
+    uint64_t height = 0;
+    if (!resolveBlockNumber(tag, height)) return false;
+    at = stateManager.snapshotAt(height);
+    return at.has_value();
+}
+
+// Height named by a block tag; "latest", "pending" and the default are the
+// stored tip
+bool RPCEndpoints::resolveBlockNumber(const std::string& tag, uint64_t& height) {
+    if (tag.empty() || tag == "latest" || tag == "pending" || tag == "safe" || tag == "finalized") {
+        height = blockStore ? blockStore->getHeight() : 0;
+        return true;
+    }
+    if (tag == "earliest") {
+        height = 0;
+        return true;
+    }
+    if (tag.rfind("0x", 0) == 0) {
+        char* end = nullptr;
+        errno = 0;
+        height = std::strtoull(tag.c_str() + 2, &end, 16);
+        return tag.size() > 2 && *end == '\0' && errno == 0;
+    }
+    return coding::parseUint64(tag, height);
+}
+
 std::string RPCEndpoints::handleSendTransaction(const std::string& json) {
     // Accept both "from/to" and "sender/receiver" param names
     Address sender = extractJsonValue(json, "sender");
@@ -315,24 +547,37 @@ std::string RPCEndpoints::handleSendTransaction(const std::string& json) {
     tx.gasLimit = 21000; 
     tx.gasPrice = 1;
     tx.calculateHash();
+
+    // Verified once on the way in; block building finds the result cached
+    if (executionEngine && !executionEngine->signatureVerifier().verify(tx)) {
+        return "{\"error\": \"Signature verification failed\"}";
+    }
     
-    mempool.add(tx);
+    if (!mempool.add(tx)) {
+        return "{\"error\": \"Transaction rejected by mempool (duplicate, underpriced or pool full)\"}";
+    }
     return "{\"result\": {\"requestKey\": \"" + crypto::to_hex(tx.hash) + "\"}}";
 }
 
 std::string RPCEndpoints::handleGetBalance(const std::string& json) {
     Address address = extractJsonValue(json, "account");
     if (address.empty()) address = extractJsonValue(json, "address");
-    
-    AccountState state = stateManager.getAccountState(address);
+    std::string tag = extractJsonValue(json, "blockTag");
+
+    std::optional<StateSnapshot> at;
+    if (!resolveBlockTag(tag, at)) return "{\"error\": \"State for block " + tag + " is not available\"}";
+    AccountState state = at ? at->getAccountState(address) : stateManager.getAccountState(address);
     return "{\"result\": " + std::to_string(state.balance) + "}";
 }
 
 std::string RPCEndpoints::handleGetNonce(const std::string& json) {
     Address address = extractJsonValue(json, "account");
     if (address.empty()) address = extractJsonValue(json, "address");
-    
-    AccountState state = stateManager.getAccountState(address);
+    std::string tag = extractJsonValue(json, "blockTag");
+
+    std::optional<StateSnapshot> at;
+    if (!resolveBlockTag(tag, at)) return "{\"error\": \"State for block " + tag + " is not available\"}";
+    AccountState state = at ? at->getAccountState(address) : stateManager.getAccountState(address);
     return "{\"result\": " + std::to_string(state.nonce) + "}";
 }
 
@@ -346,6 +591,7 @@ std::string RPCEndpoints::handleGetChainInfo(const std::string& json) {
     ss << "\"mempoolSize\": " << mempool.size() << ",";
     ss << "\"peerCount\": 3,";
     ss << "\"totalTransactions\": " << (blockStore ? blockStore->getTotalTransactions() : 0) << ",";
+    ss << "\"totalGasUsed\": " << (blockStore ? blockStore->getTotalGasUsed() : 0) << ",";
     ss << "\"tokenCount\": " << tokenManager.listTokens().size() << ",";
     ss << "\"l1Network\": \"kadena-mainnet\"";
     ss << "}}";
@@ -452,14 +698,15 @@ std::string RPCEndpoints::handleGetBlocks(const std::string& json) {
     
     uint64_t total = blockStore->getHeight();
     uint64_t start = (page - 1) * limit + 1;
-    auto blocks = blockStore->getBlocks(start, limit);
+    // The list only shows header fields, so transaction bodies are never decoded
+    auto blocks = blockStore->getHeaders(start, limit);
     
     std::stringstream ss;
     ss << "{\"result\": {\"blocks\": [";
     
     for (size_t i = 0; i < blocks.size(); ++i) {
         if (i > 0) ss << ",";
-        const auto& block = blocks[i];
+        const auto& header = blocks[i].header;
         
         // Get timestamp
         time_t now = std::time(nullptr);
@@ -467,14 +714,14 @@ std::string RPCEndpoints::handleGetBlocks(const std::string& json) {
         std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
         
         ss << "{";
-        ss << "\"height\": " << block.header.height << ",";
-        ss << "\"hash\": \"" << crypto::to_hex(block.header.stateRoot) << "\",";
-        ss << "\"parentHash\": \"" << crypto::to_hex(block.header.previousHash) << "\",";
-        ss << "\"stateRoot\": \"" << crypto::to_hex(block.header.stateRoot) << "\",";
-        ss << "\"txCount\": " << block.transactions.size() << ",";
+        ss << "\"height\": " << header.height << ",";
+        ss << "\"hash\": \"" << crypto::to_hex(header.stateRoot) << "\",";
+        ss << "\"parentHash\": \"" << crypto::to_hex(header.previousHash) << "\",";
+        ss << "\"stateRoot\": \"" << crypto::to_hex(header.stateRoot) << "\",";
+        ss << "\"txCount\": " << blocks[i].txCount << ",";
         ss << "\"timestamp\": \"" << timestamp << "\",";
         ss << "\"validator\": \"validator-1\",";
-        ss << "\"gasUsed\": " << (block.transactions.size() * 21000) << ",";
+        ss << "\"gasUsed\": " << (blocks[i].txCount * 21000) << ",";
         ss << "\"gasLimit\": 100000";
         ss << "}";
     }
@@ -592,39 +839,148 @@ std::string RPCEndpoints::handleGetTransaction(const std::string& json) {
     std::string hash = extractJsonValue(json, "hash");
     if (hash.empty()) return "{\"error\": \"Missing hash parameter\"}";
     
-    // Search through blocks for the transaction
-    uint64_t height = blockStore->getHeight();
-    for (uint64_t h = height; h >= 1; --h) {
-        Block block = blockStore->getBlock(h);
-        for (const auto& tx : block.transactions) {
-            if (crypto::to_hex(tx.hash) == hash) {
-                time_t now = std::time(nullptr);
-                char timestamp[64];
-                std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
-                
-                std::stringstream ss;
-                ss << "{\"result\": {";
-                ss << "\"hash\": \"" << crypto::to_hex(tx.hash) << "\",";
-                ss << "\"blockHeight\": " << h << ",";
-                ss << "\"from\": \"" << tx.sender << "\",";
-                ss << "\"to\": \"" << tx.receiver << "\",";
-                ss << "\"amount\": " << tx.amount << ",";
-                ss << "\"nonce\": " << tx.nonce << ",";
-                ss << "\"gasUsed\": 21000,";
-                ss << "\"gasPrice\": 0.00000001,";
-                ss << "\"fee\": 0.00021,";
-                ss << "\"status\": \"Success\",";
-                ss << "\"type\": \"Native Transfer\",";
-                ss << "\"timestamp\": \"" << timestamp << "\"";
-                ss << "}}";
-                return ss.str();
-            }
-        }
+    if (hash.rfind("0x", 0) == 0) hash = hash.substr(2);
+    Bytes hashBytes = crypto::from_hex(hash);
+    if (hashBytes.size() != 32) return "{\"error\": \"Invalid hash parameter\"}";
+    Hash txHash;
+    std::copy(hashBytes.begin(), hashBytes.end(), txHash.begin());
+
+    Transaction tx;
+    BlockStore::TxLocation location;
+    if (blockStore->getTransaction(txHash, tx, location)) {
+        time_t now = std::time(nullptr);
+        char timestamp[64];
+        std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+        
+        std::stringstream ss;
+        ss << "{\"result\": {";
+        ss << "\"hash\": \"" << crypto::to_hex(tx.hash) << "\",";
+        ss << "\"blockHeight\": " << location.height << ",";
+        ss << "\"from\": \"" << tx.sender << "\",";
+        ss << "\"to\": \"" << tx.receiver << "\",";
+        ss << "\"amount\": " << tx.amount << ",";
+        ss << "\"nonce\": " << tx.nonce << ",";
+        ss << "\"gasUsed\": 21000,";
+        ss << "\"gasPrice\": 0.00000001,";
+        ss << "\"fee\": 0.00021,";
+        ss << "\"status\": \"Success\",";
+        ss << "\"type\": \"Native Transfer\",";
+        ss << "\"timestamp\": \"" << timestamp << "\"";
+        ss << "}}";
+        return ss.str();
     }
     
     return "{\"error\": \"Transaction not found\"}";
 }
 
+// An address's transactions, newest first. Pages come from the address index,
+// so a page costs its own size no matter how long the history is. Pass the
+// returned "next" ("height:index") as "cursor" to continue.
+std::string RPCEndpoints::handleGetAddressTransactions(const std::string& json) {
+    if (!blockStore) return "{\"error\": \"Block store not available\"}";
+    Address address = extractJsonValue(json, "address");
+    if (address.empty()) return "{\"error\": \"Missing address parameter\"}";
+
+    std::string limitStr = extractJsonValue(json, "limit");
+    uint64_t limit = 25;
+    if (!limitStr.empty() && !coding::parseUint64(limitStr, limit)) {
+        return "{\"error\": \"Invalid limit\"}";
+    }
+    if (limit == 0 || limit > 100) limit = 100;
+
+    std::optional<BlockStore::TxLocation> cursor;
+    std::string cursorStr = extractJsonValue(json, "cursor");
+    if (!cursorStr.empty()) {
+        size_t colon = cursorStr.find(':');
+        uint64_t height = 0;
+        uint64_t index = 0;
+        if (colon == std::string::npos || !coding::parseUint64(cursorStr.substr(0, colon), height) ||
+            !coding::parseUint64(cursorStr.substr(colon + 1), index) || index > UINT32_MAX) {
+            return "{\"error\": \"Invalid cursor\"}";
+        }
+        cursor = BlockStore::TxLocation{height, (uint32_t)index};
+    }
+
+    std::optional<BlockStore::TxLocation> next;
+    auto locations = blockStore->getAddressTransactions(address, cursor, limit, next);
+
+    std::stringstream ss;
+    ss << "{\"result\": {\"transactions\": [";
+    bool first = true;
+    for (const auto& location : locations) {
+        Transaction tx;
+        if (!blockStore->getTransactionAt(location, tx)) continue;
+        if (!first) ss << ",";
+        first = false;
+        ss << "{";
+        ss << "\"hash\": \"" << crypto::to_hex(tx.hash) << "\",";
+        ss << "\"blockHeight\": " << location.height << ",";
+        ss << "\"index\": " << location.index << ",";
+        ss << "\"from\": \"" << tx.sender << "\",";
+        ss << "\"to\": \"" << tx.receiver << "\",";
+        ss << "\"amount\": " << tx.amount << ",";
+        ss << "\"nonce\": " << tx.nonce;
+        ss << "}";
+    }
+    ss << "], \"next\": ";
+    if (next) {
+        ss << "\"" << next->height << ":" << next->index << "\"";
+    } else {
+        ss << "null";
+    }
+    ss << "}}";
+    return ss.str();
+}
+
+// Storage keys and values are raw bytes, so they travel as "0x" hex
+static std::string hexString(const std::string& raw) {
+    return "0x" + crypto::to_hex(std::vector<uint8_t>(raw.begin(), raw.end()));
+}
+
+static bool parseHexString(std::string hex, std::string& raw) {
+    if (hex.rfind("0x", 0) == 0) hex = hex.substr(2);
+    if (hex.size() % 2 != 0 || hex.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos) return false;
+    std::vector<uint8_t> bytes = crypto::from_hex(hex);
+    raw.assign(bytes.begin(), bytes.end());
+    return true;
+}
+
+// Paged dump of a contract's storage. Keys are the hex slot keys in string order;
+// pass the returned "next" as "start" to continue.
+std::string RPCEndpoints::handleGetContractStorage(const std::string& json) {
+    std::string address = extractJsonValue(json, "address");
+    if (address.empty()) return "{\"error\": \"Missing address parameter\"}";
+    // "start" is the hex "next" cursor of the previous page
+    std::string start;
+    if (!parseHexString(extractJsonValue(json, "start"), start)) {
+        return "{\"error\": \"Invalid start\"}";
+    }
+    std::string limitStr = extractJsonValue(json, "limit");
+    uint64_t limit = 100;
+    if (!limitStr.empty() && !coding::parseUint64(limitStr, limit)) {
+        return "{\"error\": \"Invalid limit\"}";
+    }
+    if (limit == 0 || limit > 1000) limit = 1000;
+
+    // One extra slot tells us whether there is a next page
+    auto slots = stateManager.dumpContractStorage(address, start, limit + 1);
+
+    std::stringstream ss;
+    ss << "{\"result\": {\"storage\": {";
+    for (size_t i = 0; i < slots.size() && i < limit; ++i) {
+        if (i > 0) ss << ",";
+        ss << "\"" << hexString(slots[i].first) << "\": \"" << hexString(slots[i].second) << "\"";
+    }
+    ss << "}, \"next\": ";
+    if (slots.size() > limit) {
+        ss << "\"" << hexString(slots[limit].first) << "\"";
+    } else {
+        ss << "null";
+    }
+    ss << "}}";
+    return ss.str();
+}
+
 std::string RPCEndpoints::handleBridgeDeposit(const std::string& json) {
     std::string l1Hash = extractJsonValue(json, "l1Hash");
     std::string amountStr = extractJsonValue(json, "amount");
@@ -714,6 +1070,7 @@ std::string RPCEndpoints::handleGetMetrics(const std::string& json) {
     ss << "{\"result\": {";
     ss << "\"blocks_produced\": " << (blockStore ? blockStore->getHeight() : 0) << ",";
     ss << "\"transactions_processed\": " << (blockStore ? blockStore->getTotalTransactions() : 0) << ",";
+    ss << "\"gas_used\": " << (blockStore ? blockStore->getTotalGasUsed() : 0) << ",";
     ss << "\"transactions_pending\": " << mempool.size() << ",";
     ss << "\"peers_connected\": 3,";
     ss << "\"tokens_created\": " << tokenManager.listTokens().size() << ",";
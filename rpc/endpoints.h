@@ -2,8 +2,10 @@
 #include "core/mempool.h"
 #include "db/state_manager.h"
 #include "db/block_store.h"
+#include "db/receipt_store.h"
 #include "tokens/token_manager.h"
 #include "network/rpc_server.h"
+#include <optional>
 #include <set>
 
 namespace aegen {
@@ -18,11 +20,13 @@ class RPCEndpoints {
     ExecutionEngine* executionEngine = nullptr; // Optional for now or set via setter/ctor
     RPCServer& server;
     BlockStore* blockStore = nullptr;
+    ReceiptStore* receiptStore = nullptr;
 
 public:
     RPCEndpoints(Mempool& mp, StateManager& sm, TokenManager& tm, RPCServer& srv);
     void setExecutionEngine(ExecutionEngine* engine) { executionEngine = engine; }
     void setBlockStore(BlockStore* store) { blockStore = store; }
+    void setReceiptStore(ReceiptStore* store) { receiptStore = store; }
     void registerAll();
 
     // Transaction Handlers
@@ -38,6 +42,9 @@ public:
     std::string handleEthCall(const std::string& json);
     std::string handleEthGetTransactionReceipt(const std::string& json);
     std::string handleEthSendRawTransaction(const std::string& json);
+    std::string handleEthGetProof(const std::string& json);
+    std::string handleEthGetBlockReceipts(const std::string& json);
+    std::string handleEthGetLogs(const std::string& json);
     
     // Token Handlers
     std::string handleCreateToken(const std::string& json);
@@ -58,12 +65,16 @@ private:
     };
     
     bool verifyRelayerSignature(const std::string& relayerId, const std::string& signature);
+    bool resolveBlockTag(const std::string& tag, std::optional<StateSnapshot>& at);
+    bool resolveBlockNumber(const std::string& tag, uint64_t& height);
     
     // Explorer Handlers
     std::string handleGetBlocks(const std::string& json);
     std::string handleGetBlock(const std::string& json);
     std::string handleGetTransactions(const std::string& json);
     std::string handleGetTransaction(const std::string& json);
+    std::string handleGetAddressTransactions(const std::string& json);
+    std::string handleGetContractStorage(const std::string& json);
     std::string handleGenerateWallet(const std::string& json);
     std::string handleGetMetrics(const std::string& json);
 };
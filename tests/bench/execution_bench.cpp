@@ -0,0 +1,99 @@
+#include "exec/execution_engine.h"
+#include "db/rocksdb_wrapper.h"
+#include "db/state_manager.h"
+#include "wallet/keypair.h"
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace aegen;
+
+// Block execution throughput for signed transfers between distinct accounts,
+// with a share of them all paying one hot receiver. Each configuration runs
+// against a fresh state with the same transactions.
+
+constexpr size_t SENDERS = 2000;
+constexpr size_t BLOCK_TXS = 500;
+
+static const std::string DB_PATH = "bench_execution_db";
+
+std::vector<Transaction> makeTransactions(const std::vector<KeyPair>& senders, size_t hotPercent) {
+    std::vector<Transaction> txs;
+    for (size_t i = 0; i < senders.size(); ++i) {
+        Transaction tx;
+        tx.sender = senders[i].address;
+        tx.receiver = (i % 100 < hotPercent) ? "hot" : "recv" + std::to_string(i);
+        tx.amount = 100;
+        tx.nonce = 0;
+        tx.gasLimit = 21000;
+        tx.gasPrice = 1;
+        tx.sign(senders[i].privateKey);
+        txs.push_back(tx);
+    }
+    return txs;
+}
+
+// threads == 0 validates and applies one transaction at a time instead.
+// `preverified` runs the signature stage first, untimed, as the mempool does.
+double run(const std::vector<KeyPair>& senders, const std::vector<Transaction>& txs, size_t threads, bool preverified) {
+    std::filesystem::remove_all(DB_PATH);
+    RocksDBWrapper db(DB_PATH);
+    StateManager state(db);
+    for (const auto& kp : senders) state.setAccountState(kp.address, {0, 1000000});
+    state.commit(0);
+    ExecutionEngine engine(state, std::max<size_t>(threads, 1));
+    if (preverified) engine.signatureVerifier().verifyBatch(txs);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t offset = 0; offset < txs.size(); offset += BLOCK_TXS) {
+        std::vector<Transaction> block(txs.begin() + offset, txs.begin() + std::min(txs.size(), offset + BLOCK_TXS));
+        BlockContext context;
+        context.number = offset / BLOCK_TXS + 1;
+        context.coinbase = "miner";
+        std::vector<bool> applied;
+        if (threads == 0) {
+            for (const auto& tx : block) {
+                applied.push_back(engine.validateTransaction(tx) && engine.applyTransaction(tx, context));
+            }
+        } else {
+            applied = engine.applyTransactions(block, context);
+        }
+        for (bool ok : applied) {
+            if (!ok) std::cerr << "transaction failed" << std::endl;
+        }
+        state.commit(context.number);
+    }
+    return txs.size() / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    std::vector<KeyPair> senders;
+    for (size_t i = 0; i < SENDERS; ++i) senders.push_back(Wallet::generateKeyPair());
+
+    size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "ExecutionEngine::applyTransactions, " << BLOCK_TXS << "-tx blocks of signed transfers"
+              << " (hardware threads: " << hardware << ")" << std::endl;
+    std::cout << std::setw(10) << "hot recv" << std::setw(10) << "threads" << std::setw(12) << "tx/s"
+              << std::setw(10) << "speedup" << std::setw(22) << "mempool-verified tx/s" << std::endl;
+    std::vector<size_t> threadCounts = {0, 1, 2, 4};
+    if (hardware > 4) threadCounts.push_back(hardware);
+    for (size_t hotPercent : {0, 10, 50}) {
+        auto txs = makeTransactions(senders, hotPercent);
+        double baseline = 0;
+        for (size_t threads : threadCounts) {
+            double rate = run(senders, txs, threads, false);
+            double verifiedRate = run(senders, txs, threads, true);
+            if (threads == 0) baseline = rate;
+            std::cout << std::setw(9) << hotPercent << "%" << std::setw(10) << (threads ? std::to_string(threads) : "seq")
+                      << std::setw(12) << (uint64_t)rate
+                      << std::setw(9) << std::fixed << std::setprecision(2) << rate / baseline << "x"
+                      << std::setw(22) << (uint64_t)verifiedRate << std::endl;
+        }
+    }
+    std::filesystem::remove_all(DB_PATH);
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include "core/mempool.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace aegen;
+
+// Ingestion throughput of the sharded mempool versus the same pool behind one
+// global lock, while a proposer thread keeps draining blocks. Then the cost of
+// selecting one block's worth of txs as the number of pooled senders grows.
+
+constexpr size_t TOTAL_TXS = 200000;
+constexpr size_t SENDERS = 20000;
+
+std::vector<Transaction> makeWorkload() {
+    std::vector<Transaction> txs;
+    txs.reserve(TOTAL_TXS);
+    for (size_t i = 0; i < TOTAL_TXS; ++i) {
+        Transaction tx;
+        tx.sender = "sender-" + std::to_string(i % SENDERS);
+        tx.receiver = "receiver";
+        tx.amount = 1;
+        tx.nonce = i / SENDERS;
+        tx.gasPrice = 1 + (i * 7919) % 1000;
+        tx.calculateHash();
+        txs.push_back(tx);
+    }
+    return txs;
+}
+
+double run(const std::vector<Transaction>& txs, size_t workers, bool globalLock) {
+    Mempool mp(TOTAL_TXS);
+    std::mutex global;
+    std::atomic<bool> done{false};
+
+    std::thread proposer([&]() {
+        while (!done.load()) {
+            auto batch = mp.selectExecutable(100, [](const Address&) { return 0; });
+            if (globalLock) {
+                std::lock_guard<std::mutex> lock(global);
+                for (const auto& tx : batch) mp.remove(tx.hash);
+            } else {
+                for (const auto& tx : batch) mp.remove(tx.hash);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < workers; ++w) {
+        threads.emplace_back([&, w]() {
+            for (size_t i = w; i < txs.size(); i += workers) {
+                if (globalLock) {
+                    std::lock_guard<std::mutex> lock(global);
+                    mp.add(txs[i]);
+                } else {
+                    mp.add(txs[i]);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    done = true;
+    proposer.join();
+    return txs.size() / elapsed;
+}
+
+// Microseconds per selectExecutable(100) from a pool of one tx per sender
+double selectMicros(size_t senders) {
+    constexpr size_t ROUNDS = 200;
+    Mempool mp(senders);
+    for (size_t i = 0; i < senders; ++i) {
+        Transaction tx;
+        tx.sender = "sender-" + std::to_string(i);
+        tx.receiver = "receiver";
+        tx.amount = 1;
+        tx.gasPrice = 1 + (i * 7919) % 1000;
+        tx.calculateHash();
+        mp.add(tx);
+    }
+    size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < ROUNDS; ++r) {
+        sink += mp.selectExecutable(100, [](const Address&) { return 0; }).size();
+    }
+    auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    if (sink == 0) std::cout << std::endl; // Keeps the loop from being optimized away
+    return elapsed / ROUNDS;
+}
+
+int main() {
+    auto txs = makeWorkload();
+    run(txs, 1, false); // Warm-up
+    std::cout << "Mempool ingestion, " << TOTAL_TXS << " txs (hardware threads: "
+              << std::thread::hardware_concurrency() << ")" << std::endl;
+    std::cout << std::setw(8) << "workers" << std::setw(16) << "sharded tx/s" << std::setw(18) << "global-lock tx/s" << std::endl;
+    for (size_t workers : {1, 2, 4, 8, 16}) {
+        double sharded = run(txs, workers, false);
+        double locked = run(txs, workers, true);
+        std::cout << std::setw(8) << workers
+                  << std::setw(16) << (uint64_t)sharded
+                  << std::setw(18) << (uint64_t)locked << std::endl;
+    }
+
+    std::cout << std::endl << "Selecting 100 txs" << std::endl;
+    std::cout << std::setw(10) << "senders" << std::setw(16) << "us/select" << std::endl;
+    for (size_t senders : {1000, 10000, 100000, 1000000}) {
+        std::cout << std::setw(10) << senders << std::setw(16) << std::fixed << std::setprecision(1)
+                  << selectMicros(senders) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include "db/rocksdb_wrapper.h"
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace aegen;
+
+// Put throughput with concurrent writers. Async puts reach the OS page cache;
+// synced puts wait for fdatasync, which group commit shares across everyone
+// queued at the time.
+
+constexpr size_t ASYNC_PUTS = 200000;
+constexpr size_t SYNC_PUTS = 4000;
+constexpr size_t VALUE_BYTES = 100;
+
+static const std::string DB_PATH = "bench_storage_db";
+
+double run(size_t writers, size_t totalPuts, bool sync) {
+    std::filesystem::remove_all(DB_PATH);
+    RocksDBWrapper db(DB_PATH);
+    std::string value(VALUE_BYTES, 'v');
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < writers; ++w) {
+        threads.emplace_back([&, w]() {
+            for (size_t i = w; i < totalPuts; i += writers) {
+                db.writeBatch({{"key-" + std::to_string(i), value}}, {}, WriteOptions{sync});
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    return totalPuts / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    run(1, ASYNC_PUTS / 10, false); // Warm-up
+    std::cout << "RocksDBWrapper puts, " << VALUE_BYTES << "-byte values (hardware threads: "
+              << std::thread::hardware_concurrency() << ")" << std::endl;
+    std::cout << std::setw(8) << "writers" << std::setw(16) << "async puts/s" << std::setw(16) << "sync puts/s" << std::endl;
+    for (size_t writers : {1, 4, 16}) {
+        double async = run(writers, ASYNC_PUTS, false);
+        double synced = run(writers, SYNC_PUTS, true);
+        std::cout << std::setw(8) << writers
+                  << std::setw(16) << (uint64_t)async
+                  << std::setw(16) << (uint64_t)synced << std::endl;
+    }
+    std::filesystem::remove_all(DB_PATH);
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include "exec/vm.h"
+#include "exec/storage_interface.h"
+#include "util/crypto.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace aegen;
+
+// Interpreter throughput on three loops: stack arithmetic, a memory word
+// stored and reloaded per iteration, and the same for a storage slot against
+// an in-memory backend. Then a loop of STATICCALLs into a contract returning a
+// word, and calls that fail the way spam transactions do: out of gas at once
+// or partway through a loop, stack underflow, bad jump.
+
+class MemoryStorage : public StorageInterface {
+public:
+    std::unordered_map<std::string, UInt256> slots;
+    std::unordered_map<std::string, std::vector<uint8_t>> code;
+    std::unordered_map<std::string, Hash> codeHashes; // Kept on write, as StateManager does
+    std::unordered_map<std::string, uint64_t> nonces;
+
+    void setStorage(const UInt256& contractAddr, const UInt256& key, const UInt256& value) override {
+        slots[contractAddr.toHex() + key.toHex()] = value;
+    }
+
+    UInt256 getStorage(const UInt256& contractAddr, const UInt256& key) const override {
+        auto it = slots.find(contractAddr.toHex() + key.toHex());
+        return it == slots.end() ? UInt256(0) : it->second;
+    }
+
+    std::vector<uint8_t> getCode(const UInt256& contractAddr) const override {
+        auto it = code.find(contractKey(contractAddr));
+        return it == code.end() ? std::vector<uint8_t>{} : it->second;
+    }
+
+    void setCode(const UInt256& contractAddr, const std::vector<uint8_t>& bytes) override {
+        code[contractKey(contractAddr)] = bytes;
+        codeHashes[contractKey(contractAddr)] = crypto::sha256_bytes(bytes);
+    }
+
+    std::optional<Hash> getCodeHash(const UInt256& contractAddr) const override {
+        auto it = codeHashes.find(contractKey(contractAddr));
+        if (it == codeHashes.end()) return std::nullopt;
+        return it->second;
+    }
+
+    uint64_t getNonce(const UInt256& contractAddr) const override {
+        auto it = nonces.find(contractKey(contractAddr));
+        return it == nonces.end() ? 0 : it->second;
+    }
+
+    void setNonce(const UInt256& contractAddr, uint64_t nonce) override {
+        nonces[contractKey(contractAddr)] = nonce;
+    }
+};
+
+// acc = ((acc + i) * 3) ^ 0xff for i = n..1
+std::vector<uint8_t> arithmeticLoop(uint16_t n) {
+    return {0x60, 0x00,                   // PUSH1 0       acc
+            0x61, uint8_t(n >> 8), uint8_t(n), // PUSH2 n  i
+            0x5b,                         // JUMPDEST      loop (5)
+            0x80, 0x91, 0x01,             // DUP1 SWAP2 ADD
+            0x60, 0x03, 0x02,             // PUSH1 3 MUL
+            0x60, 0xff, 0x18,             // PUSH1 0xff XOR
+            0x90,                         // SWAP1
+            0x60, 0x01, 0x90, 0x03,       // PUSH1 1 SWAP1 SUB
+            0x80, 0x60, 0x05, 0x57,       // DUP1 PUSH1 5 JUMPI
+            0x00};                        // STOP
+}
+
+// sstore(i, i); sload(i) for i = n..1
+std::vector<uint8_t> storageLoop(uint16_t n) {
+    return {0x61, uint8_t(n >> 8), uint8_t(n), // PUSH2 n  i
+            0x5b,                         // JUMPDEST      loop (3)
+            0x80, 0x80, 0x55,             // DUP1 DUP1 SSTORE
+            0x80, 0x54, 0x50,             // DUP1 SLOAD POP
+            0x60, 0x01, 0x90, 0x03,       // PUSH1 1 SWAP1 SUB
+            0x80, 0x60, 0x03, 0x57,       // DUP1 PUSH1 3 JUMPI
+            0x00};                        // STOP
+}
+
+// mstore(0x40, i); mload(0x40) for i = n..1
+std::vector<uint8_t> memoryLoop(uint16_t n) {
+    return {0x61, uint8_t(n >> 8), uint8_t(n), // PUSH2 n  i
+            0x5b,                         // JUMPDEST      loop (3)
+            0x80, 0x60, 0x40, 0x52,       // DUP1 PUSH1 0x40 MSTORE
+            0x60, 0x40, 0x51, 0x50,       // PUSH1 0x40 MLOAD POP
+            0x60, 0x01, 0x90, 0x03,       // PUSH1 1 SWAP1 SUB
+            0x80, 0x60, 0x03, 0x57,       // DUP1 PUSH1 3 JUMPI
+            0x00};                        // STOP
+}
+
+// staticcall(gas(), 0xc0, 0, 0, 0, 32) for i = n..1; contract 0xc0 returns a word
+std::vector<uint8_t> callLoop(uint16_t n) {
+    return {0x61, uint8_t(n >> 8), uint8_t(n), // PUSH2 n  i
+            0x5b,                         // JUMPDEST      loop (3)
+            0x60, 0x20, 0x60, 0x00,       // PUSH1 32 PUSH1 0   retSize retOffset
+            0x60, 0x00, 0x60, 0x00,       // PUSH1 0 PUSH1 0    argsSize argsOffset
+            0x60, 0xc0, 0x5a, 0xfa, 0x50, // PUSH1 0xc0 GAS STATICCALL POP
+            0x60, 0x01, 0x90, 0x03,       // PUSH1 1 SWAP1 SUB
+            0x80, 0x60, 0x03, 0x57,       // DUP1 PUSH1 3 JUMPI
+            0x00};                        // STOP
+}
+
+// mstore(0, 42); return(0, 32)
+const std::vector<uint8_t> RETURN_WORD = {0x60, 0x2a, 0x60, 0x00, 0x52, 0x60, 0x20, 0x60, 0x00, 0xf3};
+
+// `expectFailure` runs are expected to halt exceptionally every time
+void run(const char* name, const std::vector<uint8_t>& code, size_t rounds,
+         uint64_t gasLimit = 1000000000, bool expectFailure = false) {
+    // Analyzed once, as stored contracts are
+    MemoryStorage storage;
+    storage.setCode(UInt256(0xc0), RETURN_WORD);
+    CodeAnalysisCache analyses;
+    VM vm(&storage, &analyses);
+    CallContext ctx;
+    ctx.codeHash = crypto::sha256_bytes(code);
+    ctx.caller = UInt256(1);
+    ctx.address = UInt256(2);
+    ctx.value = UInt256(0);
+    ctx.gasLimit = gasLimit;
+
+    uint64_t gas = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < rounds; ++i) {
+        ExecutionResult result = vm.execute(code, ctx);
+        if (result.success == expectFailure) {
+            std::cerr << name << (expectFailure ? " succeeded" : " failed: " + result.error) << std::endl;
+            return;
+        }
+        gas += result.gasUsed;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::setw(12) << name << std::setw(14) << (uint64_t)(rounds / seconds)
+              << std::setw(12) << std::fixed << std::setprecision(1) << gas / seconds / 1e6 << std::endl;
+}
+
+int main() {
+    std::cout << "VM::execute" << std::endl;
+    std::cout << std::setw(12) << "workload" << std::setw(14) << "calls/s" << std::setw(12) << "Mgas/s" << std::endl;
+    run("arithmetic", arithmeticLoop(10000), 200);
+    run("memory", memoryLoop(10000), 200);
+    run("storage", storageLoop(1000), 50);
+    run("call", callLoop(1000), 50);
+    run("oog-entry", arithmeticLoop(10000), 200000, 10, true);
+    run("oog-loop", arithmeticLoop(10000), 20000, 21000, true);
+    run("underflow", {0x01, 0x00}, 200000, 21000, true);
+    run("bad-jump", {0x60, 0x01, 0x56, 0x00}, 200000, 21000, true);
+    return 0;
+}
@@ -1,9 +1,17 @@
 #include <iostream>
 #include <cassert>
 #include "exec/execution_engine.h"
+#include "exec/vm.h"
 #include "db/state_manager.h"
 #include "core/account.h"
 #include "db/rocksdb_wrapper.h"
+#include "db/receipt_store.h"
+#include "util/crypto.h"
+#include "wallet/keypair.h"
+#include <csignal>
+#include <filesystem>
+#include <map>
+#include <sys/resource.h>
 
 using namespace aegen;
 
@@ -75,9 +83,293 @@ void test_execution_flow() {
     std::cout << "test_execution_flow: PASSED" << std::endl;
 }
 
+void test_block_receipts() {
+    std::filesystem::remove_all("test_receipts_db");
+    RocksDBWrapper db("test_db");
+    RocksDBWrapper receiptsDb("test_receipts_db");
+    ReceiptStore receipts(receiptsDb);
+    StateManager state(db);
+    ExecutionEngine exec(state);
+    exec.setReceiptStore(&receipts);
+
+    state.setAccountState("carol", {0, 1000000});
+    Block block;
+    block.header.height = 7;
+    block.header.timestamp = 1704351600;
+    block.header.producer = "validator";
+    for (uint64_t nonce = 0; nonce < 3; ++nonce) {
+        Transaction tx;
+        tx.sender = "carol";
+        tx.receiver = "dave";
+        tx.amount = 10;
+        tx.nonce = nonce;
+        tx.gasLimit = 30000;
+        tx.gasPrice = 1;
+        tx.calculateHash();
+        block.addTransaction(tx);
+    }
+
+    assert(exec.applyBlock(block));
+    assert(state.getAccountState("validator").balance == 3 * 21000);
+    auto pending = exec.getReceipt(crypto::to_hex(block.transactions[2].hash));
+    assert(pending && pending->blockNumber == 7 && pending->transactionIndex == 2);
+    assert(pending->cumulativeGasUsed == 3 * 21000);
+
+    uint64_t gasUsed = 0;
+    assert(exec.commitBlockReceipts(block, gasUsed) && gasUsed == 3 * 21000);
+    std::vector<TransactionReceipt> stored;
+    assert(receipts.getBlockReceipts(7, stored) && stored.size() == 3);
+    for (size_t i = 0; i < stored.size(); ++i) {
+        assert(stored[i].transactionHash == block.transactions[i].hash);
+        assert(stored[i].blockHash == block.calculateHash());
+        assert(stored[i].transactionIndex == i && stored[i].cumulativeGasUsed == (i + 1) * 21000);
+    }
+    auto committed = exec.getReceipt(crypto::to_hex(block.transactions[1].hash));
+    assert(committed && committed->blockHash == block.calculateHash() && committed->transactionIndex == 1);
+
+    // A replayed nonce is rejected and leaves the context untouched
+    BlockContext context(block.header);
+    assert(!exec.applyTransaction(block.transactions[0], context));
+    assert(context.transactionIndex == 0 && context.cumulativeGasUsed == 0);
+
+    std::cout << "test_block_receipts: PASSED" << std::endl;
+}
+
+// Parallel execution must match applying the same transactions one by one
+void test_parallel_matches_sequential() {
+    std::filesystem::remove_all("test_parallel_seq_db");
+    std::filesystem::remove_all("test_parallel_par_db");
+    RocksDBWrapper seqDb("test_parallel_seq_db");
+    RocksDBWrapper parDb("test_parallel_par_db");
+    StateManager seqState(seqDb);
+    StateManager parState(parDb);
+    ExecutionEngine sequential(seqState, 1);
+    ExecutionEngine parallel(parState, 4);
+
+    std::vector<Address> accounts;
+    for (int i = 0; i < 20; ++i) accounts.push_back("acct" + std::to_string(i));
+    for (auto* state : {&seqState, &parState}) {
+        for (const auto& addr : accounts) state->setAccountState(addr, {0, 500000});
+        state->setAccountState("poor", {0, 40000});
+    }
+
+    std::vector<Transaction> txs;
+    std::map<Address, uint64_t> nonces;
+    auto transfer = [&](const Address& from, const Address& to, uint64_t amount) {
+        Transaction tx;
+        tx.sender = from;
+        tx.receiver = to;
+        tx.amount = amount;
+        tx.nonce = nonces[from]++;
+        tx.gasLimit = 30000;
+        tx.gasPrice = 1;
+        tx.calculateHash();
+        txs.push_back(tx);
+    };
+    for (int i = 0; i < 20; ++i) transfer(accounts[i], accounts[(i + 7) % 20], 1000 + i); // Mostly independent
+    for (int i = 0; i < 5; ++i) transfer("acct3", "acct4", 10);                          // Nonce chain
+    transfer("acct5", "acct5", 50);                                                      // Self transfer
+    transfer("acct6", "miner", 70);                                                      // Pays the coinbase
+    transfer("miner", "acct7", 30000);                                                   // Spends collected fees
+    transfer("poor", "acct8", 1000);
+    transfer("poor", "acct8", 1000);   // Cannot afford a second one
+    nonces["acct9"] += 3;
+    transfer("acct9", "acct10", 5);    // Nonce gap
+    transfer("acct11", "acct12", 600000); // Too large
+
+    BlockContext seqContext;
+    seqContext.coinbase = "miner";
+    std::vector<bool> expected;
+    for (const auto& tx : txs) {
+        expected.push_back(sequential.validateTransaction(tx) && sequential.applyTransaction(tx, seqContext));
+    }
+
+    BlockContext parContext;
+    parContext.coinbase = "miner";
+    std::vector<bool> applied = parallel.applyTransactions(txs, parContext);
+
+    assert(applied == expected);
+    assert(applied[27] && applied[28] && !applied[29] && !applied[30] && !applied[31]);
+    assert(parContext.transactionIndex == seqContext.transactionIndex);
+    assert(parContext.cumulativeGasUsed == seqContext.cumulativeGasUsed);
+    accounts.push_back("miner");
+    accounts.push_back("poor");
+    for (const auto& addr : accounts) {
+        AccountState a = seqState.getAccountState(addr);
+        AccountState b = parState.getAccountState(addr);
+        assert(a.nonce == b.nonce && a.balance == b.balance);
+    }
+    assert(seqState.getRootHash() == parState.getRootHash());
+    for (size_t i = 0; i < txs.size(); ++i) {
+        auto a = sequential.getReceipt(crypto::to_hex(txs[i].hash));
+        auto b = parallel.getReceipt(crypto::to_hex(txs[i].hash));
+        assert(a.has_value() == b.has_value());
+        if (a) assert(a->transactionIndex == b->transactionIndex && a->cumulativeGasUsed == b->cumulativeGasUsed);
+    }
+
+    std::cout << "test_parallel_matches_sequential: PASSED" << std::endl;
+}
+
+void test_signature_verifier_cache() {
+    ThreadPool pool(3);
+    SignatureVerifier verifier(pool);
+
+    std::vector<Transaction> txs;
+    for (int i = 0; i < 8; ++i) {
+        KeyPair kp = Wallet::generateKeyPair();
+        Transaction tx;
+        tx.sender = kp.address;
+        tx.receiver = "bob";
+        tx.amount = 10 + i;
+        tx.gasLimit = 21000;
+        tx.gasPrice = 1;
+        tx.sign(kp.privateKey);
+        txs.push_back(tx);
+    }
+    // Tampered after signing: a different hash, and the signature no longer matches
+    Transaction forged = txs[0];
+    forged.amount = 1000000;
+    forged.calculateHash();
+    Transaction badKey = txs[1];
+    badKey.sender = "k:" + std::string(64, 'z');
+    badKey.calculateHash();
+
+    assert(verifier.verify(txs[0]) && verifier.isVerified(txs[0]));
+    txs.push_back(forged);
+    txs.push_back(badKey);
+    std::vector<bool> valid = verifier.verifyBatch(txs);
+    for (size_t i = 0; i < 8; ++i) assert(valid[i] && verifier.isVerified(txs[i]));
+    assert(!valid[8] && !valid[9]);
+    assert(!verifier.isVerified(forged) && verifier.cacheSize() == 8);
+
+    // A cached hash only vouches for the sender it was verified with
+    Transaction otherSender = txs[2];
+    otherSender.sender = txs[3].sender;
+    assert(!verifier.isVerified(otherSender));
+
+    std::cout << "test_signature_verifier_cache: PASSED" << std::endl;
+}
+
+// A block whose receipts cannot be stored is reported, not silently dropped
+void test_failed_receipt_write() {
+    std::filesystem::remove_all("test_receipts_db");
+    RocksDBWrapper db("test_db");
+    RocksDBWrapper receiptsDb("test_receipts_db");
+    ReceiptStore receipts(receiptsDb);
+    StateManager state(db);
+    ExecutionEngine exec(state);
+    exec.setReceiptStore(&receipts);
+
+    state.setAccountState("grace", {0, 1000000});
+    Block block;
+    block.header.height = 3;
+    Transaction tx;
+    tx.sender = "grace";
+    tx.receiver = "heidi";
+    tx.amount = 10;
+    tx.gasLimit = 30000;
+    tx.gasPrice = 1;
+    tx.calculateHash();
+    block.addTransaction(tx);
+    assert(exec.applyBlock(block));
+
+    // Cap file sizes so the receipt log append fails with EFBIG
+    std::signal(SIGXFSZ, SIG_IGN);
+    rlimit saved;
+    getrlimit(RLIMIT_FSIZE, &saved);
+    rlimit capped = saved;
+    capped.rlim_cur = 1;
+    setrlimit(RLIMIT_FSIZE, &capped);
+    uint64_t gasUsed = 0;
+    bool ok = exec.commitBlockReceipts(block, gasUsed);
+    setrlimit(RLIMIT_FSIZE, &saved);
+
+    assert(!ok);
+    std::vector<TransactionReceipt> stored;
+    assert(!receipts.getBlockReceipts(3, stored));
+    // Still pending, so nothing is lost before the node stops
+    assert(exec.getReceipt(crypto::to_hex(tx.hash)));
+    // The receipt database refuses later blocks too
+    assert(!exec.commitBlockReceipts(block, gasUsed));
+
+    std::cout << "test_failed_receipt_write: PASSED" << std::endl;
+}
+
+// Contracts deployed by transactions, one calling the other through state
+void test_contract_calls() {
+    RocksDBWrapper db("test_db");
+    StateManager state(db);
+    ExecutionEngine exec(state);
+    state.setAccountState("erin", {0, 10000000});
+    BlockContext context;
+    context.number = 1;
+
+    auto send = [&](const std::string& to, const std::vector<uint8_t>& data, uint64_t nonce) {
+        Transaction tx;
+        tx.sender = "erin";
+        tx.receiver = to;
+        tx.nonce = nonce;
+        tx.gasLimit = 500000;
+        tx.gasPrice = 1;
+        tx.data = data;
+        tx.calculateHash();
+        assert(exec.applyTransaction(tx, context));
+        return *exec.getReceipt(crypto::to_hex(tx.hash));
+    };
+    // Init code: `constructor`, then copy the runtime code placed after it into memory and return it
+    auto initCode = [](std::vector<uint8_t> constructor, const std::vector<uint8_t>& runtime) {
+        uint8_t size = (uint8_t)runtime.size();
+        uint8_t start = (uint8_t)(constructor.size() + 12);
+        constructor.insert(constructor.end(), {0x60, size, 0x60, start, 0x60, 0x00, 0x39, 0x60, size, 0x60, 0x00, 0xf3});
+        constructor.insert(constructor.end(), runtime.begin(), runtime.end());
+        return constructor;
+    };
+
+    // A stores 7 in its constructor and returns sload(0)
+    std::vector<uint8_t> getter = {0x60, 0x00, 0x54, 0x60, 0x00, 0x52, 0x60, 0x20, 0x60, 0x00, 0xf3};
+    TransactionReceipt deployA = send("", initCode({0x60, 0x07, 0x60, 0x00, 0x55}, getter), 0);
+    assert(deployA.status && deployA.contractAddress.size() == 42);
+    assert(deployA.gasUsed > 21000 + GAS_COST_CODE_DEPOSIT * getter.size());
+    assert(state.getContractCode(deployA.contractAddress) == std::string(getter.begin(), getter.end()));
+
+    // B returns what a STATICCALL to A returns
+    std::vector<uint8_t> proxy = {0x60, 0x20, 0x60, 0x00, 0x60, 0x00, 0x60, 0x00, 0x73};
+    std::vector<uint8_t> a = crypto::from_hex(deployA.contractAddress.substr(2));
+    proxy.insert(proxy.end(), a.begin(), a.end());
+    proxy.insert(proxy.end(), {0x5a, 0xfa, 0x50, 0x60, 0x20, 0x60, 0x00, 0xf3});
+    TransactionReceipt deployB = send("", initCode({}, proxy), 1);
+    assert(deployB.status);
+
+    Transaction call;
+    call.sender = "erin";
+    call.receiver = deployB.contractAddress;
+    call.gasLimit = 100000;
+    assert(exec.simulateTransaction(call) == std::string(62, '0') + "07");
+    TransactionReceipt callB = send(deployB.contractAddress, {0x01}, 2);
+    assert(callB.status && callB.gasUsed > 21000 + GAS_COST_CALL);
+
+    // Deployments follow CREATE's rules: return(0, MAX_CODE_SIZE + 1) is too large to deploy
+    TransactionReceipt tooLarge = send("", {0x61, 0x60, 0x01, 0x60, 0x00, 0xf3}, 3);
+    assert(!tooLarge.status && tooLarge.gasUsed == 500000 && tooLarge.contractAddress.empty());
+
+    // ...and an address that already holds code cannot be deployed to
+    std::string taken = "0x" + crypto::to_hex(crypto::sha256("erin" + std::to_string(4))).substr(24);
+    state.setContractCode(taken, std::string(getter.begin(), getter.end()));
+    TransactionReceipt collision = send("", initCode({}, proxy), 4);
+    assert(!collision.status && collision.gasUsed == 500000);
+    assert(state.getContractCode(taken) == std::string(getter.begin(), getter.end()));
+
+    std::cout << "test_contract_calls: PASSED" << std::endl;
+}
+
 int main() {
     try {
         test_execution_flow();
+        test_block_receipts();
+        test_parallel_matches_sequential();
+        test_signature_verifier_cache();
+        test_contract_calls();
+        test_failed_receipt_write();
     } catch (const std::exception& e) {
         std::cerr << "Failed: " << e.what() << std::endl;
         return 1;
@@ -0,0 +1,147 @@
+#include "core/mempool.h"
+#include <cassert>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace aegen;
+
+Transaction makeTx(const Address& sender, uint64_t nonce, uint64_t gasPrice) {
+    Transaction tx;
+    tx.sender = sender;
+    tx.receiver = "bob";
+    tx.amount = 1;
+    tx.nonce = nonce;
+    tx.gasPrice = gasPrice;
+    tx.calculateHash();
+    return tx;
+}
+
+void test_select_respects_nonce_lanes() {
+    Mempool mp;
+    mp.add(makeTx("alice", 1, 50));
+    mp.add(makeTx("alice", 0, 5));
+    mp.add(makeTx("carol", 0, 20));
+    mp.add(makeTx("dave", 3, 100)); // Gapped: state expects 0
+
+    std::map<Address, uint64_t> nonces;
+    auto selected = mp.selectExecutable(10, [&](const Address& a) { return nonces[a]; });
+
+    assert(selected.size() == 3);
+    assert(selected[0].sender == "carol");
+    assert(selected[1].sender == "alice" && selected[1].nonce == 0);
+    assert(selected[2].sender == "alice" && selected[2].nonce == 1);
+
+    // Gapped tx is not dropped, it waits for the missing nonces
+    assert(mp.size() == 4);
+
+    std::cout << "test_select_respects_nonce_lanes: PASSED" << std::endl;
+}
+
+void test_dedup_and_replacement() {
+    Mempool mp;
+    Transaction tx = makeTx("alice", 0, 100);
+    assert(mp.add(tx));
+    assert(!mp.add(tx)); // Duplicate hash
+
+    assert(!mp.add(makeTx("alice", 0, 105))); // Below the 10% bump
+    Transaction better = makeTx("alice", 0, 110);
+    assert(mp.add(better));
+    assert(mp.size() == 1);
+    assert(!mp.contains(tx.hash));
+    assert(mp.contains(better.hash));
+
+    std::cout << "test_dedup_and_replacement: PASSED" << std::endl;
+}
+
+void test_capacity_eviction() {
+    // Capacity is pool-wide: one sender may use all of it
+    Mempool single(3 * Mempool::SHARD_COUNT);
+    for (uint64_t n = 0; n < 3 * Mempool::SHARD_COUNT; ++n) assert(single.add(makeTx("alice", n, 5)));
+    assert(single.size() == 3 * Mempool::SHARD_COUNT);
+
+    Mempool mp(4);
+    assert(mp.add(makeTx("alice", 0, 1)));
+    assert(mp.add(makeTx("alice", 1, 30)));
+    assert(mp.add(makeTx("carol", 0, 5)));
+    assert(mp.add(makeTx("dave", 0, 7)));
+
+    // Full: a tx no better than the cheapest in any shard is refused
+    assert(!mp.add(makeTx("erin", 0, 1)));
+
+    // Outbidding evicts alice's nonce 0 together with its now-unexecutable nonce 1
+    assert(mp.add(makeTx("erin", 0, 20)));
+    assert(mp.size() == 3);
+    auto selected = mp.selectExecutable(10, [](const Address&) { return 0; });
+    assert(selected.size() == 3 && selected[0].sender == "erin");
+
+    std::cout << "test_capacity_eviction: PASSED" << std::endl;
+}
+
+void test_select_looks_up_nonces_unlocked() {
+    Mempool mp;
+    for (int i = 0; i < 40; ++i) mp.add(makeTx("sender-" + std::to_string(i), 0, 1 + i));
+
+    // The lookup stands in for a state read; inserts must not wait on it
+    size_t lookups = 0;
+    auto selected = mp.selectExecutable(5, [&](const Address& sender) {
+        lookups++;
+        assert(mp.add(makeTx(sender + "-late", 0, 1000)));
+        return 0;
+    });
+    assert(selected.size() == 5 && selected[0].sender == "sender-39");
+    assert(lookups == 5); // Only the best lanes are resolved
+    assert(mp.size() == 45);
+
+    std::cout << "test_select_looks_up_nonces_unlocked: PASSED" << std::endl;
+}
+
+void test_concurrent_ingestion() {
+    Mempool mp;
+    const int workers = 8;
+    const int perWorker = 500;
+
+    std::vector<std::thread> threads;
+    for (int w = 0; w < workers; ++w) {
+        threads.emplace_back([&mp, w]() {
+            for (int i = 0; i < perWorker; ++i) {
+                mp.add(makeTx("sender-" + std::to_string(w) + "-" + std::to_string(i % 50), i / 50, 1 + i % 7));
+            }
+        });
+    }
+    // Proposer drains concurrently with ingestion
+    size_t drained = 0;
+    for (int round = 0; round < 20; ++round) {
+        for (const auto& tx : mp.selectExecutable(50, [](const Address&) { return 0; })) {
+            if (mp.remove(tx.hash)) drained++;
+        }
+    }
+    for (auto& t : threads) t.join();
+
+    assert(mp.size() + drained == (size_t)(workers * perWorker));
+
+    std::cout << "test_concurrent_ingestion: PASSED" << std::endl;
+}
+
+void test_prune_sender() {
+    Mempool mp;
+    for (uint64_t n = 0; n < 5; ++n) mp.add(makeTx("alice", n, 1));
+    mp.pruneSender("alice", 3);
+    assert(mp.size() == 2);
+    assert(mp.pop().nonce == 3);
+
+    std::cout << "test_prune_sender: PASSED" << std::endl;
+}
+
+int main() {
+    test_select_respects_nonce_lanes();
+    test_dedup_and_replacement();
+    test_capacity_eviction();
+    test_select_looks_up_nonces_unlocked();
+    test_prune_sender();
+    test_concurrent_ingestion();
+    std::cout << "\nAll mempool tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,253 @@
+#include <iostream>
+#include <cassert>
+#include <filesystem>
+#include "db/state_manager.h"
+#include "db/rocksdb_wrapper.h"
+#include "util/crypto.h"
+
+using namespace aegen;
+
+static const std::string DB_PATH = "test_state_db";
+
+void test_commit_persists_across_restart() {
+    std::filesystem::remove_all(DB_PATH);
+    {
+        RocksDBWrapper db(DB_PATH);
+        StateManager state(db);
+        state.setAccountState("alice", {3, 1000});
+        // Balance containing a newline byte must survive the reload
+        state.setAccountState("bob", {0, 0x0A0A});
+        state.commit(1);
+    }
+    {
+        RocksDBWrapper db(DB_PATH);
+        StateManager state(db);
+        assert(state.getAccountState("alice").nonce == 3);
+        assert(state.getAccountState("alice").balance == 1000);
+        assert(state.getAccountState("bob").balance == 0x0A0A);
+    }
+    std::cout << "test_commit_persists_across_restart: PASSED" << std::endl;
+}
+
+void test_rollback_discards_uncommitted() {
+    std::filesystem::remove_all(DB_PATH);
+    RocksDBWrapper db(DB_PATH);
+    StateManager state(db);
+    state.setAccountState("alice", {0, 500});
+    state.commit(1);
+
+    state.setAccountState("alice", {1, 100});
+    assert(state.getAccountState("alice").balance == 100);
+    state.rollback();
+    assert(state.getAccountState("alice").balance == 500);
+
+    std::cout << "test_rollback_discards_uncommitted: PASSED" << std::endl;
+}
+
+void test_bounded_cache_reads_through() {
+    std::filesystem::remove_all(DB_PATH);
+    RocksDBWrapper db(DB_PATH);
+    StateManager state(db, 4);
+    for (uint64_t i = 0; i < 32; ++i) {
+        state.setAccountState("acct-" + std::to_string(i), {i, i * 10});
+    }
+    state.commit(1);
+    for (uint64_t i = 0; i < 32; ++i) {
+        assert(state.getAccountState("acct-" + std::to_string(i)).balance == i * 10);
+    }
+    std::cout << "test_bounded_cache_reads_through: PASSED" << std::endl;
+}
+
+void test_root_independent_of_insertion_order() {
+    std::filesystem::remove_all(DB_PATH);
+    Hash forward;
+    {
+        RocksDBWrapper db(DB_PATH);
+        StateManager state(db);
+        for (uint64_t i = 0; i < 50; ++i) {
+            state.setAccountState("acct-" + std::to_string(i), {i, i * 7});
+        }
+        forward = state.getRootHash();
+    }
+    std::filesystem::remove_all(DB_PATH);
+    {
+        RocksDBWrapper db(DB_PATH);
+        StateManager state(db);
+        for (uint64_t i = 50; i-- > 0;) {
+            state.setAccountState("acct-" + std::to_string(i), {i, i * 7});
+            if (i % 10 == 0) state.commit(50 - i); // Spread across several commits
+        }
+        assert(state.getRootHash() == forward);
+    }
+    std::cout << "test_root_independent_of_insertion_order: PASSED" << std::endl;
+}
+
+void test_root_incremental_and_persistent() {
+    std::filesystem::remove_all(DB_PATH);
+    Hash before;
+    Hash after;
+    {
+        RocksDBWrapper db(DB_PATH);
+        StateManager state(db);
+        assert(state.getRootHash() == Hash{});
+        state.setAccountState("alice", {0, 100});
+        state.setAccountState("bob", {0, 200});
+        state.commit(1);
+        before = state.getRootHash();
+
+        state.setAccountState("alice", {1, 50});
+        after = state.getRootHash();
+        assert(after != before);
+
+        // Rollback restores the committed root
+        state.rollback();
+        assert(state.getRootHash() == before);
+
+        state.setAccountState("alice", {1, 50});
+        state.commit(2);
+        assert(state.getRootHash() == after);
+    }
+    {
+        RocksDBWrapper db(DB_PATH);
+        StateManager state(db);
+        assert(state.getRootHash() == after);
+    }
+    std::cout << "test_root_incremental_and_persistent: PASSED" << std::endl;
+}
+
+void test_account_proofs() {
+    std::filesystem::remove_all(DB_PATH);
+    RocksDBWrapper db(DB_PATH);
+    StateManager state(db);
+    for (uint64_t i = 0; i < 64; ++i) {
+        state.setAccountState("acct-" + std::to_string(i), {i, 1000 + i});
+    }
+    state.commit(1);
+    Hash root = state.getRootHash();
+
+    auto proof = state.getAccountProof("acct-17");
+    assert(proof.exists && proof.state.balance == 1017);
+    assert(proof.stateRoot == root);
+    assert(!proof.proof.siblings.empty());
+    assert(StateManager::verifyAccountProof(proof));
+
+    // A forged balance no longer hashes to the root
+    auto forged = proof;
+    forged.state.balance = 1000000;
+    assert(!StateManager::verifyAccountProof(forged));
+
+    // Absence is provable too
+    auto missing = state.getAccountProof("nobody");
+    assert(!missing.exists);
+    assert(StateManager::verifyAccountProof(missing));
+
+    // Uncommitted changes do not leak into proofs
+    state.setAccountState("acct-17", {18, 1});
+    auto pending = state.getAccountProof("acct-17");
+    assert(pending.state.balance == 1017 && pending.stateRoot == root);
+    assert(StateManager::verifyAccountProof(pending));
+
+    std::cout << "test_account_proofs: PASSED" << std::endl;
+}
+
+void test_contract_storage_dump() {
+    std::filesystem::remove_all(DB_PATH);
+    RocksDBWrapper db(DB_PATH);
+    StateManager state(db);
+    state.setContractStorage("0xc1", "0x1", "0xa");
+    state.setContractStorage("0xc1", "0x2", "0xb");
+    state.setContractStorage("0xc1", "0x3", "0xc");
+    state.setContractStorage("0xc10", "0x1", "0xd"); // Shares the address as a string prefix
+    assert(state.dumpContractStorage("0xc1").empty()); // Committed slots only
+    state.commit(1);
+
+    auto all = state.dumpContractStorage("0xc1");
+    assert(all.size() == 3);
+    assert(all[0].first == "0x1" && all[0].second == "0xa");
+
+    auto page = state.dumpContractStorage("0xc1", "0x2", 1);
+    assert(page.size() == 1 && page[0].first == "0x2");
+
+    std::cout << "test_contract_storage_dump: PASSED" << std::endl;
+}
+
+void test_snapshots_pinned_to_committed_height() {
+    std::filesystem::remove_all(DB_PATH);
+    RocksDBWrapper db(DB_PATH);
+    StateManager state(db);
+    state.setAccountState("alice", {0, 100});
+    state.setContractStorage("0xc1", "0x1", "0xa");
+    state.commit(1);
+    Hash root1 = state.getRootHash();
+    StateSnapshot atOne = state.snapshot();
+
+    // A block half-applied: visible to execution, not to the snapshot
+    state.setAccountState("alice", {1, 40});
+    state.setAccountState("bob", {0, 60});
+    state.setContractStorage("0xc1", "0x1", "0xb");
+    state.setContractCode("0xc1", "code");
+    assert(state.getAccountState("alice").balance == 40);
+    assert(state.getContractStorage("0xc1", "0x1") == "0xb");
+    StateSnapshot latest = state.snapshot();
+    assert(latest.height() == 1 && latest.stateRoot() == root1);
+    assert(latest.getAccountState("alice").balance == 100);
+    assert(latest.getAccountState("bob").balance == 0);
+    assert(latest.getContractStorage("0xc1", "0x1") == "0xa");
+    assert(latest.getContractCode("0xc1").empty());
+    assert(!latest.getContractCodeHash("0xc1"));
+    assert(state.getContractCodeHash("0xc1") == crypto::sha256_bytes((const uint8_t*)"code", 4));
+
+    // Older snapshots keep their view across later commits
+    state.commit(2);
+    state.setAccountState("alice", {2, 10});
+    state.commit(3);
+    assert(atOne.getAccountState("alice").balance == 100);
+    assert(atOne.getAccountState("bob").balance == 0);
+    assert(atOne.getContractStorage("0xc1", "0x1") == "0xa");
+    assert(state.snapshot().height() == 3);
+    assert(state.snapshot().getAccountState("alice").balance == 10);
+    auto atTwo = state.snapshotAt(2);
+    assert(atTwo && atTwo->getAccountState("alice").balance == 40);
+    assert(atTwo->getContractCode("0xc1") == "code");
+    assert(atTwo->getContractCodeHash("0xc1") == state.getContractCodeHash("0xc1"));
+    assert(!state.snapshotAt(7));
+
+    // Rolled back writes never reach a snapshot
+    state.setContractStorage("0xc1", "0x2", "0xf");
+    state.rollback();
+    assert(state.getContractStorage("0xc1", "0x2").empty());
+
+    std::cout << "test_snapshots_pinned_to_committed_height: PASSED" << std::endl;
+}
+
+void test_snapshot_height_persists() {
+    std::filesystem::remove_all(DB_PATH);
+    {
+        RocksDBWrapper db(DB_PATH);
+        StateManager state(db);
+        state.setAccountState("alice", {0, 5});
+        state.commit(9);
+    }
+    RocksDBWrapper db(DB_PATH);
+    StateManager state(db);
+    assert(state.snapshot().height() == 9);
+    assert(state.snapshot().stateRoot() == state.getRootHash());
+    assert(state.snapshotAt(9)->getAccountState("alice").balance == 5);
+
+    std::cout << "test_snapshot_height_persists: PASSED" << std::endl;
+}
+
+int main() {
+    test_commit_persists_across_restart();
+    test_rollback_discards_uncommitted();
+    test_bounded_cache_reads_through();
+    test_root_independent_of_insertion_order();
+    test_root_incremental_and_persistent();
+    test_account_proofs();
+    test_contract_storage_dump();
+    test_snapshots_pinned_to_committed_height();
+    test_snapshot_height_persists();
+    std::filesystem::remove_all(DB_PATH);
+    std::cout << "\nAll state tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,640 @@
+#include <iostream>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <csignal>
+#include <sys/resource.h>
+#include "db/rocksdb_wrapper.h"
+#include "db/block_store.h"
+#include "db/receipt_store.h"
+
+using namespace aegen;
+
+static const std::string DB_PATH = "test_storage_db";
+
+// Tiny memtable and trigger so a few hundred writes exercise flush and compaction
+static RocksDBOptions smallOptions() {
+    RocksDBOptions options;
+    options.memtableBytes = 8 * 1024;
+    options.blockBytes = 512;
+    options.targetFileBytes = 16 * 1024;
+    options.level0CompactionTrigger = 2;
+    return options;
+}
+
+static std::string key(int i) {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "k%05d", i);
+    return buf;
+}
+
+void test_basic_operations() {
+    std::filesystem::remove_all(DB_PATH);
+    RocksDBWrapper db(DB_PATH);
+    db.put("a", "1");
+    db.writeBatch({{"b", "2"}, {"c", "3"}}, {"a"});
+    assert(db.get("a").empty() && !db.exists("a"));
+    assert(db.get("b") == "2" && db.exists("c"));
+
+    // Values are raw bytes
+    std::string binary("\n\0|x\n", 5);
+    db.put("bin", binary);
+    assert(db.get("bin") == binary);
+
+    std::cout << "test_basic_operations: PASSED" << std::endl;
+}
+
+void test_flush_compaction_and_reopen() {
+    std::filesystem::remove_all(DB_PATH);
+    const int n = 2000;
+    {
+        RocksDBWrapper db(DB_PATH, smallOptions());
+        for (int i = 0; i < n; ++i) {
+            db.put(key(i), "value-" + std::to_string(i));
+        }
+        // Overwrite and delete across tables that are already on disk
+        for (int i = 0; i < n; i += 3) db.put(key(i), "new-" + std::to_string(i));
+        for (int i = 1; i < n; i += 10) db.del(key(i));
+
+        assert(db.get(key(3)) == "new-3");
+        assert(!db.exists(key(11)));
+        assert(db.get(key(2)) == "value-2");
+        db.forceCompact();
+        assert(db.get(key(3)) == "new-3");
+        assert(!db.exists(key(11)));
+    }
+    size_t tables = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(DB_PATH)) {
+        if (entry.path().extension() == ".sst") tables++;
+    }
+    assert(tables > 1); // Split by targetFileBytes
+
+    RocksDBWrapper db(DB_PATH, smallOptions());
+    for (int i = 0; i < n; ++i) {
+        std::string expected = i % 10 == 1 ? "" : (i % 3 == 0 ? "new-" : "value-") + std::to_string(i);
+        assert(db.get(key(i)) == expected);
+    }
+    assert(db.size() == (size_t)(n - n / 10));
+
+    std::cout << "test_flush_compaction_and_reopen: PASSED" << std::endl;
+}
+
+void test_prefix_scan_merges_sources() {
+    std::filesystem::remove_all(DB_PATH);
+    RocksDBWrapper db(DB_PATH, smallOptions());
+    for (int i = 0; i < 500; ++i) {
+        db.put("acct:" + key(i), std::to_string(i));
+        db.put("code:" + key(i), std::string(20, 'c'));
+    }
+    db.del("acct:" + key(7));
+    db.put("acct:" + key(8), "eight");
+
+    auto rows = db.prefixScan("acct:");
+    assert(rows.size() == 499);
+    for (size_t i = 1; i < rows.size(); ++i) assert(rows[i - 1].first < rows[i].first);
+    assert(rows[7].first == "acct:" + key(8) && rows[7].second == "eight");
+
+    std::cout << "test_prefix_scan_merges_sources: PASSED" << std::endl;
+}
+
+void test_iterator_seek_and_bounds() {
+    std::filesystem::remove_all(DB_PATH);
+    RocksDBWrapper db(DB_PATH, smallOptions());
+    for (int i = 0; i < 600; i += 2) db.put(key(i), std::to_string(i));
+    db.forceCompact(); // Even keys in level 1
+    for (int i = 1; i < 600; i += 2) db.put(key(i), std::to_string(i));
+    db.del(key(101));  // Tombstone in the memtable over nothing
+    db.del(key(100));  // Tombstone in the memtable over level 1
+
+    ReadOptions range;
+    range.lowerBound = key(90);
+    range.upperBound = key(110);
+    auto it = db.newIterator(range);
+
+    // Writes after creation are not visible
+    db.put(key(95), "late");
+
+    it->seek(key(99));
+    assert(it->valid() && it->key() == key(99));
+    it->next();
+    assert(it->key() == key(102)); // 100 and 101 are deleted
+    it->prev();
+    it->prev();
+    assert(it->key() == key(98));
+
+    it->seekToLast();
+    assert(it->valid() && it->key() == key(109));
+    it->next();
+    assert(!it->valid());
+
+    it->seek(key(0)); // Clamped to the lower bound
+    assert(it->key() == key(90));
+    assert(it->value() == "90");
+
+    int count = 0;
+    for (it->seekToFirst(); it->valid(); it->next()) {
+        assert(it->key() != key(95) || it->value() == "95");
+        count++;
+    }
+    assert(count == 18);
+
+    std::cout << "test_iterator_seek_and_bounds: PASSED" << std::endl;
+}
+
+void test_wal_replay_after_crash() {
+    std::filesystem::remove_all(DB_PATH);
+    {
+        RocksDBWrapper db(DB_PATH);
+        db.put("kept", "yes");
+        // Simulate a crash: copy the directory before the destructor flushes
+        std::filesystem::copy(DB_PATH, DB_PATH + "_crash");
+    }
+    std::filesystem::remove_all(DB_PATH);
+    std::filesystem::rename(DB_PATH + "_crash", DB_PATH);
+
+    RocksDBWrapper db(DB_PATH);
+    assert(db.get("kept") == "yes");
+
+    std::cout << "test_wal_replay_after_crash: PASSED" << std::endl;
+}
+
+void test_torn_wal_tail_is_dropped() {
+    std::filesystem::remove_all(DB_PATH);
+    {
+        RocksDBWrapper db(DB_PATH);
+        db.put("a", "1");
+        db.put("b", std::string("\n2\n", 3));
+        db.writeBatch({{"c", "3"}, {"d", "4"}}, {"a"});
+        std::filesystem::copy(DB_PATH, DB_PATH + "_crash");
+    }
+    std::filesystem::remove_all(DB_PATH);
+    std::filesystem::rename(DB_PATH + "_crash", DB_PATH);
+
+    // Tear the last batch: its record loses its final bytes
+    for (const auto& entry : std::filesystem::directory_iterator(DB_PATH)) {
+        if (entry.path().extension() == ".log" && std::filesystem::file_size(entry.path()) > 0) {
+            std::filesystem::resize_file(entry.path(), std::filesystem::file_size(entry.path()) - 3);
+        }
+    }
+    {
+        RocksDBWrapper db(DB_PATH);
+        // Batches before the tear survive whole; the torn one is dropped whole
+        assert(db.get("a") == "1");
+        assert(db.get("b") == std::string("\n2\n", 3));
+        assert(!db.exists("c") && !db.exists("d"));
+        assert(db.put("e", "5"));
+    }
+    // Writes after recovery are not hidden behind the dropped tail
+    RocksDBWrapper db(DB_PATH);
+    assert(db.get("e") == "5" && db.get("a") == "1" && !db.exists("c"));
+
+    std::cout << "test_torn_wal_tail_is_dropped: PASSED" << std::endl;
+}
+
+void test_corrupt_block_is_an_error() {
+    std::filesystem::remove_all(DB_PATH);
+    RocksDBOptions options;
+    options.blockBytes = 512;
+    {
+        RocksDBWrapper db(DB_PATH, options);
+        for (int i = 0; i < 200; ++i) db.put(key(i), "old");
+        db.forceCompact(); // "old" in level 1
+        for (int i = 0; i < 200; ++i) db.put(key(i), "new");
+    } // "new" flushed to level 0, the newest table
+
+    std::filesystem::path newest;
+    size_t tables = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(DB_PATH)) {
+        if (entry.path().extension() != ".sst") continue;
+        tables++;
+        if (newest.empty() || entry.path().filename() > newest.filename()) newest = entry.path();
+    }
+    {
+        // Flip a byte in its first data block
+        std::fstream file(newest, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(8);
+        file.put('X');
+    }
+
+    RocksDBWrapper db(DB_PATH, options);
+    bool threw = false;
+    try {
+        db.get(key(0)); // Must not fall back to "old" in level 1
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw && db.isCorrupted());
+    assert(db.get(key(199)) == "new");
+
+    threw = false;
+    try {
+        db.prefixScan("");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // Compaction gives up and keeps its inputs instead of writing the keys out of existence
+    db.forceCompact();
+    size_t after = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(DB_PATH)) {
+        if (entry.path().extension() == ".sst") after++;
+    }
+    assert(after == tables && std::filesystem::exists(newest));
+    assert(db.get(key(150)) == "new");
+    assert(!db.put(key(0), "repair")); // Writes are refused once corrupted
+
+    std::cout << "test_corrupt_block_is_an_error: PASSED" << std::endl;
+}
+
+void test_failed_wal_write_is_not_applied() {
+    std::filesystem::remove_all(DB_PATH);
+    RocksDBWrapper db(DB_PATH);
+    assert(db.put("before", "1"));
+
+    // Cap file sizes so the next log append fails with EFBIG
+    std::signal(SIGXFSZ, SIG_IGN);
+    rlimit saved;
+    getrlimit(RLIMIT_FSIZE, &saved);
+    rlimit capped = saved;
+    capped.rlim_cur = 4096;
+    setrlimit(RLIMIT_FSIZE, &capped);
+    bool ok = db.writeBatch({{"big", std::string(8192, 'x')}}, {}, WriteOptions{true});
+    setrlimit(RLIMIT_FSIZE, &saved);
+
+    assert(!ok);
+    assert(!db.exists("big"));
+    // The log may now end in a torn record, so later writes are refused as well
+    assert(!db.put("after", "2"));
+    assert(!db.exists("after") && db.get("before") == "1");
+
+    std::cout << "test_failed_wal_write_is_not_applied: PASSED" << std::endl;
+}
+
+void test_block_store_survives_corrupt_records() {
+    std::filesystem::remove_all(DB_PATH);
+    {
+        RocksDBWrapper db(DB_PATH + "/blocks");
+        db.put("block:0", "0|00|00|1|0|");
+        db.put("block:1", "1|00|00|not-a-number|0|");
+        db.put("block:2", "2|00|00|3|0|");
+        db.put("meta:height", "garbage");
+    }
+    BlockStore store(DB_PATH);
+    assert(store.getHeight() == 2);
+    assert(store.getBlock(2).header.timestamp == 3);
+
+    std::cout << "test_block_store_survives_corrupt_records: PASSED" << std::endl;
+}
+
+void test_block_store_lazy_loading() {
+    std::filesystem::remove_all(DB_PATH);
+    {
+        BlockStore store(DB_PATH, 4);
+        for (uint64_t h = 0; h <= 50; ++h) {
+            Block block;
+            block.header.height = h;
+            block.header.timestamp = 1000 + h;
+            store.addBlock(block);
+        }
+        // Evicted from the cache, read back through the database
+        assert(store.getBlock(3).header.timestamp == 1003);
+    }
+    BlockStore store(DB_PATH, 4);
+    assert(store.getHeight() == 50);
+    assert(store.getBlock(0).header.timestamp == 1000);
+    assert(store.getBlock(37).header.timestamp == 1037);
+    assert(store.getBlock(51).header.timestamp == 0);
+
+    auto page = store.getBlocks(2, 5); // Newest first, skipping two
+    assert(page.size() == 5);
+    assert(page[0].header.height == 48 && page[4].header.height == 44);
+    assert(store.getBlocks(49, 10).size() == 2);
+    assert(store.getBlocks(51, 10).empty());
+
+    std::cout << "test_block_store_lazy_loading: PASSED" << std::endl;
+}
+
+void test_block_store_round_trips_blocks() {
+    std::filesystem::remove_all(DB_PATH);
+    Block block;
+    block.header.height = 7;
+    block.header.timestamp = 1700000000;
+    block.header.previousHash.fill(0x11);
+    block.header.stateRoot.fill(0x22);
+    block.header.txRoot.fill(0x33);
+    block.header.producer = "k:producer";
+    block.header.signature = Bytes(64, 0x44);
+    for (int i = 0; i < 3; ++i) {
+        Transaction tx;
+        tx.sender = "alice";
+        tx.receiver = i == 2 ? "" : "bob";
+        tx.amount = 100 + i;
+        tx.nonce = i;
+        tx.gasLimit = 50000;
+        tx.gasPrice = 3;
+        tx.data = Bytes{0x60, 0x00, (uint8_t)i, '\n', '|'};
+        tx.signature = Bytes(64, (uint8_t)i);
+        tx.hash.fill((uint8_t)(0xa0 + i)); // Not derived from the fields; must survive as stored
+        block.addTransaction(tx);
+    }
+    {
+        BlockStore store(DB_PATH, 0); // No cache: every read decodes from disk
+        store.addBlock(block);
+    }
+    BlockStore store(DB_PATH, 0);
+    Block loaded = store.getBlock(7);
+    assert(loaded.serialize() == block.serialize());
+    assert(loaded.calculateHash() == block.calculateHash());
+    for (size_t i = 0; i < block.transactions.size(); ++i) {
+        assert(loaded.transactions[i].hash == block.transactions[i].hash);
+    }
+
+    BlockStore::HeaderInfo info;
+    assert(store.getHeader(7, info));
+    assert(info.txCount == 3 && info.header.producer == "k:producer");
+    assert(info.header.signature == block.header.signature);
+
+    // Wire form round trip recomputes transaction hashes
+    Block wire = Block::deserialize(block.serialize());
+    assert(wire.serialize() == block.serialize());
+    bool threw = false;
+    try {
+        auto truncated = block.serialize();
+        truncated.resize(truncated.size() - 5);
+        Block::deserialize(truncated);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "test_block_store_round_trips_blocks: PASSED" << std::endl;
+}
+
+void test_transaction_index() {
+    std::filesystem::remove_all(DB_PATH);
+    Hash hash1{};
+    hash1.fill(0xab);
+    {
+        // Written before the index existed: no tx entries, no marker
+        RocksDBWrapper db(DB_PATH + "/blocks");
+        db.put("block:1", "1|00|00|5|1|alice,bob,10,0," + std::string(62, 'a') + "ab;");
+        db.put("meta:height", "1");
+    }
+    {
+        BlockStore store(DB_PATH);
+        BlockStore::TxLocation location;
+        Transaction tx;
+        Hash legacy{};
+        legacy.fill(0xaa);
+        legacy[31] = 0xab; // "aa..ab" from the record above
+        assert(store.getTransaction(legacy, tx, location));
+        assert(location.height == 1 && location.index == 0 && tx.amount == 10);
+
+        Block block;
+        block.header.height = 2;
+        for (uint64_t i = 0; i < 3; ++i) {
+            Transaction t;
+            t.sender = "carol";
+            t.nonce = i;
+            t.calculateHash();
+            block.addTransaction(t);
+        }
+        hash1 = block.transactions[1].hash;
+        store.addBlock(block);
+    }
+    BlockStore store(DB_PATH, 0);
+    BlockStore::TxLocation location;
+    Transaction tx;
+    assert(store.getTransaction(hash1, tx, location));
+    assert(location.height == 2 && location.index == 1 && tx.nonce == 1);
+    Hash missing{};
+    assert(!store.getTransaction(missing, tx, location));
+
+    std::cout << "test_transaction_index: PASSED" << std::endl;
+}
+
+void test_address_index_pagination() {
+    std::filesystem::remove_all(DB_PATH);
+    BlockStore store(DB_PATH, 2);
+    for (uint64_t h = 1; h <= 10; ++h) {
+        Block block;
+        block.header.height = h;
+        Transaction toBob;
+        toBob.sender = "alice";
+        toBob.receiver = "bob";
+        toBob.nonce = h;
+        toBob.calculateHash();
+        block.addTransaction(toBob);
+        if (h % 2 == 0) {
+            Transaction other;
+            other.sender = "alicex"; // Shares "alice" as a string prefix
+            other.receiver = "alice";
+            other.nonce = h;
+            other.calculateHash();
+            block.addTransaction(other);
+        }
+        store.addBlock(block);
+    }
+
+    std::optional<BlockStore::TxLocation> next;
+    auto page = store.getAddressTransactions("alice", std::nullopt, 4, next);
+    assert(page.size() == 4 && next);
+    assert(page[0].height == 10 && page[0].index == 1);
+    assert(page[1].height == 10 && page[1].index == 0);
+    assert(page[2].height == 9 && page[3].height == 8);
+
+    size_t total = page.size();
+    while (next) {
+        page = store.getAddressTransactions("alice", next, 4, next);
+        total += page.size();
+    }
+    assert(total == 15);
+
+    auto bob = store.getAddressTransactions("bob", BlockStore::TxLocation{3, 0}, 10, next);
+    assert(bob.size() == 3 && !next);
+    Transaction tx;
+    assert(store.getTransactionAt(bob[0], tx) && tx.nonce == 3);
+    assert(store.getAddressTransactions("alicex", std::nullopt, 10, next).size() == 5);
+
+    std::cout << "test_address_index_pagination: PASSED" << std::endl;
+}
+
+void test_block_store_running_totals() {
+    std::filesystem::remove_all(DB_PATH);
+    {
+        // Written before the counters existed
+        RocksDBWrapper db(DB_PATH + "/blocks");
+        db.put("block:1", "1|00|00|5|2|a,b,1,0,01;a,b,1,1,02;");
+        db.put("meta:height", "1");
+    }
+    auto blockWith = [](uint64_t height, size_t txs) {
+        Block block;
+        block.header.height = height;
+        for (size_t i = 0; i < txs; ++i) {
+            Transaction tx;
+            tx.nonce = height * 100 + i;
+            tx.calculateHash();
+            block.addTransaction(tx);
+        }
+        return block;
+    };
+    {
+        BlockStore store(DB_PATH);
+        assert(store.getTotalTransactions() == 2 && store.getTotalGasUsed() == 0);
+        store.addBlock(blockWith(2, 3), 63000);
+        store.addBlock(blockWith(3, 1), 21000);
+        store.addBlock(blockWith(3, 1), 21000); // Re-added height does not double count
+        assert(store.getTotalTransactions() == 6 && store.getTotalGasUsed() == 84000);
+    }
+    BlockStore store(DB_PATH);
+    assert(store.getTotalTransactions() == 6 && store.getTotalGasUsed() == 84000);
+    BlockStore::Totals totals;
+    assert(store.getTotals(2, totals) && totals.transactions == 5 && totals.gasUsed == 63000);
+    assert(store.getTotals(1, totals) && totals.transactions == 2);
+
+    std::cout << "test_block_store_running_totals: PASSED" << std::endl;
+}
+
+void test_receipt_store_logs() {
+    std::filesystem::remove_all(DB_PATH);
+    auto topic = [](uint8_t b) {
+        Hash h{};
+        h.fill(b);
+        return h;
+    };
+    auto receipt = [&](uint64_t nonce, const Address& emitter, uint8_t t) {
+        TransactionReceipt r;
+        r.transactionHash = topic((uint8_t)nonce);
+        r.from = "alice";
+        r.to = emitter;
+        r.gasUsed = 21000 + nonce;
+        r.cumulativeGasUsed = nonce * 1000;
+        r.status = true;
+        if (!emitter.empty()) r.logs.push_back({emitter, {topic(t), topic(0xee)}, {1, 2, 3}});
+        return r;
+    };
+    {
+        RocksDBWrapper db(DB_PATH);
+        ReceiptStore store(db);
+        for (uint64_t h = 1; h <= 50; ++h) {
+            // Only blocks 10 and 40 emit logs from "token"
+            Address emitter = (h == 10 || h == 40) ? "token" : (h % 2 ? "other" : "");
+            store.putBlockReceipts(h, {receipt(h, emitter, (uint8_t)h), receipt(h + 100, "", 0)});
+        }
+    }
+    RocksDBWrapper db(DB_PATH);
+    ReceiptStore store(db);
+
+    std::vector<TransactionReceipt> receipts;
+    assert(store.getBlockReceipts(10, receipts) && receipts.size() == 2);
+    assert(receipts[0].logs.size() == 1 && receipts[0].logs[0].data == std::vector<uint8_t>({1, 2, 3}));
+    assert(receipts[1].gasUsed == 21110 && receipts[1].logs.empty());
+    assert(receipts[1].cumulativeGasUsed == 110000);
+    assert(!store.getBlockReceipts(51, receipts));
+
+    auto found = store.getReceipt(topic(140));
+    assert(found && found->gasUsed == 21140 && found->from == "alice");
+    assert(!store.getReceipt(topic(200)));
+
+    LogsBloom bloom;
+    assert(store.getBloom(10, bloom));
+    assert(ReceiptStore::bloomMayContain(bloom, (const uint8_t*)"token", 5));
+    Hash t10 = topic(10);
+    assert(ReceiptStore::bloomMayContain(bloom, t10.data(), t10.size()));
+
+    ReceiptStore::LogFilter filter;
+    filter.fromBlock = 1;
+    filter.toBlock = 50;
+    filter.address = "token";
+    auto logs = store.getLogs(filter);
+    assert(logs.size() == 2 && logs[0].blockNumber == 10 && logs[1].blockNumber == 40);
+    assert(logs[0].transactionHash == topic(10) && logs[0].transactionIndex == 0 && logs[0].logIndex == 0);
+
+    // Position 0 wildcard, position 1 shared by every log
+    filter.address.reset();
+    filter.topics = {std::nullopt, topic(0xee)};
+    assert(store.getLogs(filter).size() == 27);
+    filter.topics = {topic(40)};
+    logs = store.getLogs(filter);
+    assert(logs.size() == 1 && logs[0].blockNumber == 40);
+    filter.topics = {topic(40), std::nullopt, topic(0xee)};
+    assert(store.getLogs(filter).empty());
+
+    filter.topics.clear();
+    filter.fromBlock = 11;
+    filter.toBlock = 39;
+    assert(store.getLogs(filter).size() == 15);
+    filter.fromBlock = 40;
+    assert(store.getLogs(filter).empty());
+
+    std::cout << "test_receipt_store_logs: PASSED" << std::endl;
+}
+
+void test_concurrent_group_commit() {
+    std::filesystem::remove_all(DB_PATH);
+    const int writers = 8;
+    const int perWriter = 300;
+    {
+        RocksDBWrapper db(DB_PATH, smallOptions());
+        std::vector<std::thread> threads;
+        for (int w = 0; w < writers; ++w) {
+            threads.emplace_back([&db, w]() {
+                for (int i = 0; i < perWriter; ++i) {
+                    // Mix synced and async batches in the same groups
+                    db.writeBatch({{"w" + std::to_string(w) + ":" + key(i), std::to_string(i)}}, {},
+                                  WriteOptions{i % 50 == 0});
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        assert(db.get("w3:" + key(299)) == "299");
+    }
+    RocksDBWrapper db(DB_PATH);
+    assert(db.size() == (size_t)(writers * perWriter));
+
+    std::cout << "test_concurrent_group_commit: PASSED" << std::endl;
+}
+
+void test_legacy_import() {
+    std::filesystem::remove_all(DB_PATH);
+    std::filesystem::create_directories(DB_PATH);
+    {
+        std::ofstream data(DB_PATH + "/data.db", std::ios::binary);
+        data << "3|foo|3|bar\n" << "4|gone|1|x\n";
+        std::ofstream wal(DB_PATH + "/wal.log", std::ios::binary);
+        wal << "PUT|3|baz|2|qu\n" << "DEL|4|gone|0|\n";
+    }
+    RocksDBWrapper db(DB_PATH);
+    assert(db.get("foo") == "bar");
+    assert(db.get("baz") == "qu");
+    assert(!db.exists("gone"));
+    assert(!std::filesystem::exists(DB_PATH + "/data.db"));
+
+    std::cout << "test_legacy_import: PASSED" << std::endl;
+}
+
+int main() {
+    test_basic_operations();
+    test_flush_compaction_and_reopen();
+    test_prefix_scan_merges_sources();
+    test_iterator_seek_and_bounds();
+    test_wal_replay_after_crash();
+    test_torn_wal_tail_is_dropped();
+    test_corrupt_block_is_an_error();
+    test_failed_wal_write_is_not_applied();
+    test_block_store_survives_corrupt_records();
+    test_block_store_lazy_loading();
+    test_block_store_round_trips_blocks();
+    test_transaction_index();
+    test_address_index_pagination();
+    test_block_store_running_totals();
+    test_receipt_store_logs();
+    test_concurrent_group_commit();
+    test_legacy_import();
+    std::filesystem::remove_all(DB_PATH);
+    std::cout << "\nAll storage tests passed!" << std::endl;
+    return 0;
+}
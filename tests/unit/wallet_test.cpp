@@ -1,4 +1,5 @@
 #include "wallet/keypair.h"
+#include "core/transaction.h"
 #include "wallet/signer.h"
 #include "util/crypto.h"
 #include <cassert>
@@ -57,6 +58,40 @@ void test_signing() {
     std::cout << "test_signing: PASSED" << std::endl;
 }
 
+void test_transaction_signing() {
+    KeyPair kp = Wallet::generateKeyPair();
+    Transaction tx;
+    tx.sender = kp.address;
+    tx.receiver = "k:receiver";
+    tx.amount = 250;
+    tx.nonce = 3;
+    tx.data.assign(10 * 1024, 0x5a);
+    tx.sign(kp.privateKey);
+
+    // Streamed hash matches the buffered encoding
+    assert(tx.hash == crypto::sha256_bytes(tx.serialize()));
+    // The signature covers the unsigned serialization, so external signers of it still verify
+    Transaction unsignedTx = tx;
+    unsignedTx.signature.clear();
+    assert(tx.signingMessage() == unsignedTx.serialize());
+    assert(Signer::verify(unsignedTx.serialize(), tx.signature, kp.publicKey));
+    unsignedTx.signature = Signer::sign(unsignedTx.serialize(), kp.privateKey);
+    assert(unsignedTx.isSignedBy(kp.publicKey));
+    assert(tx.isSignedBy(kp.publicKey));
+
+    Transaction decoded = Transaction::deserialize(tx.serialize());
+    assert(decoded.isSignedBy(kp.publicKey));
+
+    // Changed after hashing: the stale hash does not vouch for the new fields
+    Transaction tampered = tx;
+    tampered.amount = 251;
+    assert(!tampered.isSignedBy(kp.publicKey));
+    tampered.calculateHash();
+    assert(!tampered.isSignedBy(kp.publicKey));
+
+    std::cout << "test_transaction_signing: PASSED" << std::endl;
+}
+
 void test_deterministic_keys() {
     // Same private key should always derive same public key and address
     std::vector<uint8_t> pk1 = {1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31,32};
@@ -78,6 +113,7 @@ int main() {
         test_key_generation();
         test_address_validation();
         test_signing();
+        test_transaction_signing();
         test_deterministic_keys();
         std::cout << "\nAll Kadena wallet tests passed!" << std::endl;
     } catch (const std::exception& e) {
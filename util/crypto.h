@@ -1,4 +1,5 @@
 #pragma once
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <array>
@@ -78,9 +79,14 @@ public:
         state[0] = 0x6a09e667; state[1] = 0xbb67ae85; state[2] = 0x3c6ef372; state[3] = 0xa54ff53a;
         state[4] = 0x510e527f; state[5] = 0x9b05688c; state[6] = 0x1f83d9ab; state[7] = 0x5be0cd19;
     }
+    // Whole chunks are copied into the block buffer, not byte by byte
     void update(const uint8_t* input, size_t len) {
-        for (size_t i = 0; i < len; ++i) {
-            data[datalen++] = input[i];
+        while (len > 0) {
+            size_t n = std::min<size_t>(64 - datalen, len);
+            std::memcpy(data + datalen, input, n);
+            datalen += (uint32_t)n;
+            input += n;
+            len -= n;
             if (datalen == 64) { transform(); bitlen += 512; datalen = 0; }
         }
     }
@@ -176,19 +182,20 @@ inline void crypto_sign_seed_keypair(PublicKeyArray& pk, SecretKeyArray& sk, con
 // Ed25519 Compatible Signing (Deterministic)
 // ============================================================================
 
-inline int crypto_sign_detached(SignatureArray& sig, const uint8_t* msg, size_t msglen, const SecretKeyArray& sk) {
-    // Extract seed and public key from secret key
-    std::vector<uint8_t> combined;
-    combined.insert(combined.end(), sk.begin(), sk.begin() + 32);
-    combined.insert(combined.end(), msg, msg + msglen);
-    
-    auto r = sha256_bytes(combined);
-    
-    std::vector<uint8_t> combined2;
-    combined2.insert(combined2.end(), r.begin(), r.end());
-    combined2.insert(combined2.end(), msg, msg + msglen);
+// The _streamed variants take the message as `writeMessage(SHA256&)`, which
+// feeds it to a hasher already holding the seed or r, so it is never buffered
+template <typename WriteMessage>
+inline int crypto_sign_detached_streamed(SignatureArray& sig, WriteMessage&& writeMessage, const SecretKeyArray& sk) {
+    // r = H(seed || msg), s = H(r || msg)
+    SHA256 hasher;
+    hasher.update(sk.data(), 32);
+    writeMessage(hasher);
+    auto r = hasher.finalize();
     
-    auto s = sha256_bytes(combined2);
+    hasher.reset();
+    hasher.update(r.data(), r.size());
+    writeMessage(hasher);
+    auto s = hasher.finalize();
     
     std::copy(r.begin(), r.end(), sig.begin());
     std::copy(s.begin(), s.end(), sig.begin() + 32);
@@ -196,28 +203,31 @@ inline int crypto_sign_detached(SignatureArray& sig, const uint8_t* msg, size_t
     return 0; // Success
 }
 
-inline int crypto_sign_verify_detached(const SignatureArray& sig, const uint8_t* msg, size_t msglen, const PublicKeyArray& pk) {
-    // Extract r and s from signature
-    HashArray r, expectedS;
-    std::copy(sig.begin(), sig.begin() + 32, r.begin());
-    std::copy(sig.begin() + 32, sig.end(), expectedS.begin());
-    
+inline int crypto_sign_detached(SignatureArray& sig, const uint8_t* msg, size_t msglen, const SecretKeyArray& sk) {
+    return crypto_sign_detached_streamed(sig, [&](SHA256& hasher) { hasher.update(msg, msglen); }, sk);
+}
+
+template <typename WriteMessage>
+inline int crypto_sign_verify_detached_streamed(const SignatureArray& sig, WriteMessage&& writeMessage, const PublicKeyArray& pk) {
     // Recompute s from r and message
-    std::vector<uint8_t> combined;
-    combined.insert(combined.end(), r.begin(), r.end());
-    combined.insert(combined.end(), msg, msg + msglen);
-    
-    auto computedS = sha256_bytes(combined);
+    SHA256 hasher;
+    hasher.update(sig.data(), 32);
+    writeMessage(hasher);
+    auto computedS = hasher.finalize();
     
     // Constant-time comparison
     int diff = 0;
     for (size_t i = 0; i < 32; ++i) {
-        diff |= (expectedS[i] ^ computedS[i]);
+        diff |= (sig[32 + i] ^ computedS[i]);
     }
     
     return diff == 0 ? 0 : -1;
 }
 
+inline int crypto_sign_verify_detached(const SignatureArray& sig, const uint8_t* msg, size_t msglen, const PublicKeyArray& pk) {
+    return crypto_sign_verify_detached_streamed(sig, [&](SHA256& hasher) { hasher.update(msg, msglen); }, pk);
+}
+
 // ============================================================================
 // Utility Functions
 // ============================================================================
@@ -272,7 +282,8 @@ inline std::vector<uint8_t> derive_public_key(const std::vector<uint8_t>& privat
     return std::vector<uint8_t>(hash.begin(), hash.end());
 }
 
-inline std::vector<uint8_t> sign_message(const std::vector<uint8_t>& message, const std::vector<uint8_t>& privateKey) {
+template <typename WriteMessage>
+inline std::vector<uint8_t> sign_streamed(WriteMessage&& writeMessage, const std::vector<uint8_t>& privateKey) {
     SecretKeyArray sk{};
     std::copy(privateKey.begin(), privateKey.begin() + std::min((size_t)32, privateKey.size()), sk.begin());
     
@@ -281,12 +292,21 @@ inline std::vector<uint8_t> sign_message(const std::vector<uint8_t>& message, co
     std::copy(pk.begin(), pk.end(), sk.begin() + 32);
     
     SignatureArray sig;
-    crypto_sign_detached(sig, message.data(), message.size(), sk);
+    crypto_sign_detached_streamed(sig, writeMessage, sk);
     
     return std::vector<uint8_t>(sig.begin(), sig.end());
 }
 
-inline bool verify_signature(const std::vector<uint8_t>& message, const std::vector<uint8_t>& signature, const std::vector<uint8_t>& publicKey) {
+inline std::vector<uint8_t> sign_message(const uint8_t* message, size_t length, const std::vector<uint8_t>& privateKey) {
+    return sign_streamed([&](SHA256& hasher) { hasher.update(message, length); }, privateKey);
+}
+
+inline std::vector<uint8_t> sign_message(const std::vector<uint8_t>& message, const std::vector<uint8_t>& privateKey) {
+    return sign_message(message.data(), message.size(), privateKey);
+}
+
+template <typename WriteMessage>
+inline bool verify_streamed(WriteMessage&& writeMessage, const std::vector<uint8_t>& signature, const std::vector<uint8_t>& publicKey) {
     if (signature.size() != 64 || publicKey.size() != 32) {
         return false;
     }
@@ -296,7 +316,15 @@ inline bool verify_signature(const std::vector<uint8_t>& message, const std::vec
     std::copy(signature.begin(), signature.end(), sig.begin());
     std::copy(publicKey.begin(), publicKey.end(), pk.begin());
     
-    return crypto_sign_verify_detached(sig, message.data(), message.size(), pk) == 0;
+    return crypto_sign_verify_detached_streamed(sig, writeMessage, pk) == 0;
+}
+
+inline bool verify_signature(const uint8_t* message, size_t length, const std::vector<uint8_t>& signature, const std::vector<uint8_t>& publicKey) {
+    return verify_streamed([&](SHA256& hasher) { hasher.update(message, length); }, signature, publicKey);
+}
+
+inline bool verify_signature(const std::vector<uint8_t>& message, const std::vector<uint8_t>& signature, const std::vector<uint8_t>& publicKey) {
+    return verify_signature(message.data(), message.size(), signature, publicKey);
 }
 
 // ============================================================================
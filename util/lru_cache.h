@@ -0,0 +1,67 @@
+#pragma once
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <functional>
+
+namespace aegen {
+
+/**
+ * LRUCache - Bounded least-recently-used map
+ *
+ * Not thread-safe; owners guard it with their own lock.
+ * A lookup counts as a use, so get() moves the entry to the front.
+ */
+template <typename K, typename V, typename HashFn = std::hash<K>>
+class LRUCache {
+    using Entry = std::pair<K, V>;
+
+    size_t capacity;
+    std::list<Entry> entries; // Most recently used first
+    std::unordered_map<K, typename std::list<Entry>::iterator, HashFn> index;
+
+public:
+    explicit LRUCache(size_t capacity) : capacity(capacity) {}
+
+    // Returns nullptr on miss. The pointer is valid until the next put/erase.
+    V* get(const K& key) {
+        auto it = index.find(key);
+        if (it == index.end()) return nullptr;
+        entries.splice(entries.begin(), entries, it->second);
+        return &it->second->second;
+    }
+
+    void put(const K& key, V value) {
+        auto it = index.find(key);
+        if (it != index.end()) {
+            it->second->second = std::move(value);
+            entries.splice(entries.begin(), entries, it->second);
+            return;
+        }
+        if (capacity == 0) return;
+        if (entries.size() >= capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+        entries.emplace_front(key, std::move(value));
+        index[key] = entries.begin();
+    }
+
+    bool erase(const K& key) {
+        auto it = index.find(key);
+        if (it == index.end()) return false;
+        entries.erase(it->second);
+        index.erase(it);
+        return true;
+    }
+
+    void clear() {
+        entries.clear();
+        index.clear();
+    }
+
+    size_t size() const { return entries.size(); }
+    size_t maxSize() const { return capacity; }
+};
+
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace aegen {
+
+/**
+ * ThreadPool - Fixed set of workers for data-parallel loops
+ *
+ * parallelFor() hands out indices from a shared counter; the calling thread
+ * works too and returns once every index is done. Loops from several callers
+ * run one after another. The loop body must not throw.
+ */
+class ThreadPool {
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::mutex loopMutex; // One loop at a time
+
+    // Current loop, guarded by mutex
+    const std::function<void(size_t)>* job = nullptr;
+    size_t jobSize = 0;
+    uint64_t generation = 0;
+    size_t active = 0; // Workers inside the current loop
+    bool stopping = false;
+    std::atomic<size_t> next{0};
+
+    void drain(const std::function<void(size_t)>& fn, size_t n) {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < n;) fn(i);
+    }
+
+    void workerLoop() {
+        uint64_t seen = 0;
+        for (;;) {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || (job && generation != seen); });
+            if (stopping) return;
+            seen = generation;
+            const auto* fn = job;
+            size_t n = jobSize;
+            active++;
+            lock.unlock();
+
+            drain(*fn, n);
+
+            lock.lock();
+            if (--active == 0) idle.notify_all();
+        }
+    }
+
+public:
+    // `threads` workers besides the caller; 0 runs every loop inline
+    explicit ThreadPool(size_t threads) {
+        workers.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) workers.emplace_back([this] { workerLoop(); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Threads that run a loop, the caller included
+    size_t size() const { return workers.size() + 1; }
+
+    void parallelFor(size_t n, const std::function<void(size_t)>& fn) {
+        if (workers.empty() || n < 2) {
+            for (size_t i = 0; i < n; ++i) fn(i);
+            return;
+        }
+
+        std::lock_guard<std::mutex> loop(loopMutex);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &fn;
+            jobSize = n;
+            next.store(0, std::memory_order_relaxed);
+            generation++;
+        }
+        wake.notify_all();
+
+        drain(fn, n);
+
+        // Workers that have not picked the loop up by now find nothing left
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [&] { return active == 0; });
+        job = nullptr;
+    }
+};
+
+}
@@ -28,6 +28,22 @@ public:
     // Export to big-endian bytes
     std::vector<uint8_t> toBigEndianBytes() const;
 
+    // 32 big-endian bytes at `in`/`out`, swapped word by word without a buffer
+    static UInt256 loadBigEndian(const uint8_t* in) {
+        UInt256 res;
+        for (int w = 0; w < 4; ++w) {
+            uint64_t word = 0;
+            for (int i = 0; i < 8; ++i) word = (word << 8) | in[8 * (3 - w) + i];
+            res.data[w] = word;
+        }
+        return res;
+    }
+    void storeBigEndian(uint8_t* out) const {
+        for (int w = 0; w < 4; ++w) {
+            for (int i = 0; i < 8; ++i) out[8 * (3 - w) + i] = (uint8_t)(data[w] >> (56 - 8 * i));
+        }
+    }
+
     // Hex parsing
     static UInt256 fromHex(const std::string& hex);
     std::string toHex() const;
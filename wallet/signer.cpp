@@ -11,4 +11,12 @@ bool Signer::verify(const Bytes& message, const Signature& sig, const PublicKey&
     return crypto::verify_signature(message, sig, pk);
 }
 
+Signature Signer::sign(const MessageWriter& message, const PrivateKey& pk) {
+    return crypto::sign_streamed(message, pk);
+}
+
+bool Signer::verify(const MessageWriter& message, const Signature& sig, const PublicKey& pk) {
+    return crypto::verify_streamed(message, sig, pk);
+}
+
 }
@@ -1,8 +1,11 @@
 #pragma once
 #include "core/types.h"
+#include <functional>
 
 namespace aegen {
 
+namespace crypto { class SHA256; }
+
 // Forward declaration
 struct Transaction;
 
@@ -10,6 +13,12 @@ class Signer {
 public:
     static Signature sign(const Bytes& message, const PrivateKey& pk);
     static bool verify(const Bytes& message, const Signature& sig, const PublicKey& pk);
+
+    // The message is written straight into the signature's hasher instead of
+    // a buffer; signatures match those over the same bytes passed whole
+    using MessageWriter = std::function<void(crypto::SHA256&)>;
+    static Signature sign(const MessageWriter& message, const PrivateKey& pk);
+    static bool verify(const MessageWriter& message, const Signature& sig, const PublicKey& pk);
 };
 
 }